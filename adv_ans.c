@@ -0,0 +1,315 @@
+#include <string.h>
+#include "adv_internal.h"
+
+// tANS(표 기반 비대칭 숫자 체계) 엔트로피 부호기. 하프만과 같은 빈도표를 2^tableLog 합으로
+// 정규화해 쓰며, 심볼마다 정수 비트가 아니라 확률에 맞는 분수 비트를 쓰므로 한두 바이트 값이
+// 대부분인 블록에서 하프만보다 작다. 심볼은 뒤에서부터 부호화하고 해제는 앞에서부터 하며,
+// 두 상태를 번갈아 써서 해제 때 테이블 조회 두 개가 동시에 진행된다.
+
+// 정규화된 빈도 norm[]으로 상태마다 심볼을 흩어 놓는다 (서로 다른 심볼이 고르게 섞이도록)
+void spreadAnsSymbols(const uint16_t norm[], int tableLog, unsigned char tableSymbol[]) {
+    unsigned tableSize = 1u << tableLog;
+    unsigned mask = tableSize - 1;
+    unsigned step = (tableSize >> 1) + (tableSize >> 3) + 3; // 홀수라 모든 위치를 한 번씩 돈다
+    unsigned position = 0;
+    for (int s = 0; s < 256; s++) {
+        for (unsigned i = 0; i < norm[s]; i++) {
+            tableSymbol[position] = (unsigned char)s;
+            position = (position + step) & mask;
+        }
+    }
+}
+
+// x의 log2를 16비트 소수부 고정소수점으로 구한다 (x >= 1)
+uint32_t log2Fixed(uint32_t x) {
+    int whole = 0;
+    while ((x >> whole) > 1) whole++;
+    // 나머지 (x / 2^whole, 1 이상 2 미만)를 제곱해 가며 소수부 비트를 하나씩 얻는다
+    uint64_t m = ((uint64_t)x << 16) >> whole; // 16비트 소수부
+    uint32_t frac = 0;
+    for (int bit = 15; bit >= 0; bit--) {
+        m = (m * m) >> 16;
+        if (m >= (2u << 16)) {
+            m >>= 1;
+            frac |= 1u << bit;
+        }
+    }
+    return ((uint32_t)whole << 16) | frac;
+}
+
+// 빈도를 합이 2^tableLog인 정규화 빈도로 바꾼다. 나온 심볼은 모두 1 이상이다.
+// 반올림 뒤 남거나 모자란 몫은 비트 손실이 가장 작은 심볼부터 하나씩 조정한다.
+void normalizeAnsCounts(const unsigned freq[], size_t total, int tableLog, uint16_t norm[]) {
+    unsigned tableSize = 1u << tableLog;
+    unsigned sum = 0;
+    for (int s = 0; s < 256; s++) {
+        norm[s] = 0;
+        if (freq[s] == 0) continue;
+        uint64_t scaled = ((uint64_t)freq[s] * tableSize + total / 2) / total;
+        norm[s] = (uint16_t)(scaled == 0 ? 1 : scaled);
+        sum += norm[s];
+    }
+    // 늘릴 때는 freq/norm이 가장 큰 심볼, 줄일 때는 freq/(norm-1)이 가장 작은 심볼을 고른다
+    while (sum < tableSize) {
+        int best = -1;
+        for (int s = 0; s < 256; s++) {
+            if (norm[s] == 0) continue;
+            if (best < 0 || (uint64_t)freq[s] * norm[best] > (uint64_t)freq[best] * norm[s]) best = s;
+        }
+        norm[best]++;
+        sum++;
+    }
+    while (sum > tableSize) {
+        int best = -1;
+        for (int s = 0; s < 256; s++) {
+            if (norm[s] <= 1) continue;
+            if (best < 0 || (uint64_t)freq[s] * (norm[best] - 1) < (uint64_t)freq[best] * (norm[s] - 1)) best = s;
+        }
+        norm[best]--;
+        sum--;
+    }
+}
+
+// 정규화 빈도표: [tableLog][심볼 수 - 1] 다음에 심볼마다 [심볼][norm - 1].
+// norm - 1은 128 미만이면 1바이트, 아니면 상위 비트를 세운 2바이트 (빅 엔디언)로 쓴다.
+size_t writeAnsTable(const uint16_t norm[], int tableLog, unsigned char* out) {
+    size_t idx = 2;
+    int count = 0;
+    for (int s = 0; s < 256; s++) {
+        if (norm[s] == 0) continue;
+        unsigned v = norm[s] - 1u;
+        out[idx++] = (unsigned char)s;
+        if (v < 0x80) {
+            out[idx++] = (unsigned char)v;
+        } else {
+            out[idx++] = (unsigned char)(0x80 | (v >> 8));
+            out[idx++] = (unsigned char)v;
+        }
+        count++;
+    }
+    out[0] = (unsigned char)tableLog;
+    out[1] = (unsigned char)(count - 1);
+    return idx;
+}
+
+size_t readAnsTable(const unsigned char* in, size_t avail, uint16_t norm[], int* tableLog) {
+    if (avail < 2) return 0;
+    *tableLog = in[0];
+    if (*tableLog < ADV_ANS_MIN_TABLE_LOG || *tableLog > ADV_ANS_MAX_TABLE_LOG) return 0;
+    int count = in[1] + 1;
+    memset(norm, 0, 256 * sizeof(uint16_t));
+    size_t idx = 2;
+    unsigned sum = 0;
+    int previous = -1;
+    for (int i = 0; i < count; i++) {
+        if (avail - idx < 2) return 0;
+        int s = in[idx++];
+        if (s <= previous) return 0; // 심볼은 오름차순으로 한 번씩만 나온다
+        previous = s;
+        unsigned v = in[idx++];
+        if (v & 0x80) {
+            if (idx >= avail) return 0;
+            v = ((v & 0x7F) << 8) | in[idx++];
+        }
+        norm[s] = (uint16_t)(v + 1);
+        sum += v + 1;
+    }
+    if (sum != (1u << *tableLog)) return 0;
+    return idx;
+}
+
+// 블록 전체를 tANS 블록으로 부호화했을 때의 프레임 크기를 빈도로 추정하고 norm을 채운다.
+// 실제 부호는 추정보다 약간 길 수 있어 1/64만큼 여유를 더한다.
+size_t estimateAnsBlock(const unsigned freq[], size_t size, uint16_t norm[]) {
+    int tableLog = ADV_ANS_TABLE_LOG;
+    normalizeAnsCounts(freq, size, tableLog, norm);
+    uint64_t cost = 0; // 1/65536비트 단위
+    size_t tableSize = 2;
+    for (int s = 0; s < 256; s++) {
+        if (norm[s] == 0) continue;
+        cost += (uint64_t)freq[s] * (((uint32_t)tableLog << 16) - log2Fixed(norm[s]));
+        tableSize += norm[s] > 0x80 ? 3 : 2;
+    }
+    uint64_t bits = (cost >> 16) + 1;
+    bits += bits / 64 + 2 * ADV_ANS_TABLE_LOG + 8;
+    return ADV_BLOCK_HEADER_SIZE + tableSize + (size_t)((bits + 7) / 8) + 8;
+}
+
+// 부호화 변환표: 심볼 s를 상태 x에서 부호화하면 하위 (x + deltaNbBits) >> 16 비트를 내보내고
+// 남은 상위 비트와 deltaFindState로 다음 상태를 stateTable에서 찾는다.
+struct AnsEncodeSymbol {
+    int32_t deltaFindState;
+    uint32_t deltaNbBits;
+};
+
+// LSB 우선 비트 기록기: 먼저 쓴 비트가 낮은 위치에 오고, 해제는 끝에서부터 거꾸로 읽는다
+struct AnsBitWriter {
+    unsigned char* out;
+    size_t pos;
+    uint64_t buf;
+    int count;
+};
+
+void ansPutBits(struct AnsBitWriter* w, uint32_t value, int length) {
+    w->buf |= (uint64_t)(value & ((1u << length) - 1)) << w->count;
+    w->count += length;
+}
+
+void ansFlushBits(struct AnsBitWriter* w) {
+    while (w->count >= 8) {
+        w->out[w->pos++] = (unsigned char)w->buf;
+        w->buf >>= 8;
+        w->count -= 8;
+    }
+}
+
+size_t compressAnsBlock(const unsigned char* data, size_t size, const uint16_t norm[], unsigned char* out) {
+    int tableLog = ADV_ANS_TABLE_LOG;
+    unsigned tableSize = 1u << tableLog;
+    unsigned char tableSymbol[1u << ADV_ANS_MAX_TABLE_LOG];
+    uint16_t stateTable[1u << ADV_ANS_MAX_TABLE_LOG];
+    struct AnsEncodeSymbol transform[256];
+    spreadAnsSymbols(norm, tableLog, tableSymbol);
+
+    // 심볼별 누적 위치에 그 심볼이 놓인 상태들을 차례로 모은다
+    unsigned cumul[257];
+    cumul[0] = 0;
+    for (int s = 0; s < 256; s++) cumul[s + 1] = cumul[s] + norm[s];
+    unsigned next[256];
+    memcpy(next, cumul, sizeof(next));
+    for (unsigned u = 0; u < tableSize; u++) {
+        stateTable[next[tableSymbol[u]]++] = (uint16_t)(tableSize + u);
+    }
+    for (int s = 0; s < 256; s++) {
+        if (norm[s] == 0) continue;
+        // norm이 클수록 내보내는 비트가 적다: 최대 maxBitsOut비트, 상태가 작으면 한 비트 덜
+        int maxBitsOut = norm[s] == 1 ? tableLog : tableLog - highestBit(norm[s] - 1u);
+        uint32_t minStatePlus = (uint32_t)norm[s] << maxBitsOut;
+        transform[s].deltaNbBits = ((uint32_t)maxBitsOut << 16) - minStatePlus;
+        transform[s].deltaFindState = (int32_t)cumul[s] - (int32_t)norm[s];
+    }
+
+    out[0] = ADV_BLOCK_ANS;
+    putLE32(&out[1], (uint32_t)size);
+    size_t idx = ADV_BLOCK_HEADER_SIZE;
+    idx += writeAnsTable(norm, tableLog, &out[idx]);
+    size_t streamStart = idx;
+
+    // 뒤에서부터 부호화한다. 심볼 i는 상태 i % 2를 쓴다.
+    struct AnsBitWriter writer = { out, idx, 0, 0 };
+    uint32_t state[2] = { tableSize, tableSize };
+    for (size_t i = size; i-- > 0;) {
+        uint32_t* x = &state[i & 1];
+        const struct AnsEncodeSymbol* t = &transform[data[i]];
+        int nbBits = (int)((*x + t->deltaNbBits) >> 16);
+        ansPutBits(&writer, *x, nbBits);
+        *x = stateTable[(int32_t)(*x >> nbBits) + t->deltaFindState];
+        if (writer.count >= 32) ansFlushBits(&writer);
+    }
+    // 최종 상태를 상태 0, 1 순서로 쓰면 해제할 때는 1, 0 순서로 읽힌다. 끝 표시로 1비트를 붙인다.
+    ansPutBits(&writer, state[0] - tableSize, tableLog);
+    ansPutBits(&writer, state[1] - tableSize, tableLog);
+    ansPutBits(&writer, 1, 1);
+    ansFlushBits(&writer);
+    if (writer.count > 0) out[writer.pos++] = (unsigned char)writer.buf;
+
+    // 해제기가 늘 8바이트씩 읽을 수 있도록 짧은 스트림은 앞을 0으로 채운다
+    size_t streamSize = writer.pos - streamStart;
+    if (streamSize < 8) {
+        memmove(&out[streamStart + 8 - streamSize], &out[streamStart], streamSize);
+        memset(&out[streamStart], 0, 8 - streamSize);
+        writer.pos = streamStart + 8;
+    }
+    putLE32(&out[5], (uint32_t)(writer.pos - ADV_BLOCK_HEADER_SIZE));
+    return writer.pos;
+}
+
+// 해제 테이블: 상태마다 심볼, 읽을 비트 수, 그 비트를 더할 다음 상태의 기준값
+struct AnsDecodeEntry {
+    uint16_t newState;
+    unsigned char symbol;
+    unsigned char nbBits;
+};
+
+// 끝에서 앞으로 읽는 비트 판독기. ptr부터 8바이트를 리틀 엔디언으로 읽은 container의
+// 상위 consumed 비트는 이미 읽었다.
+struct AnsBitReader {
+    const unsigned char* start;
+    const unsigned char* ptr;
+    uint64_t container;
+    unsigned consumed;
+};
+
+void ansReload(struct AnsBitReader* r) {
+    size_t back = r->consumed >> 3;
+    size_t avail = (size_t)(r->ptr - r->start);
+    if (back > avail) back = avail;
+    r->ptr -= back;
+    r->consumed -= (unsigned)back * 8;
+    r->container = getLE64(r->ptr);
+}
+
+// consumed < 64이고 consumed + length <= 64일 때만 부른다. length가 0이면 0을 돌려준다.
+uint32_t ansReadBits(struct AnsBitReader* r, int length) {
+    uint32_t value = (uint32_t)(((r->container << r->consumed) >> 1) >> (63 - length));
+    r->consumed += length;
+    return value;
+}
+
+int decompressAnsBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize) {
+    uint16_t norm[256];
+    int tableLog;
+    size_t idx = readAnsTable(payload, payloadSize, norm, &tableLog);
+    if (idx == 0 || payloadSize - idx < 8) return ADV_ERR_FORMAT;
+    const unsigned char* stream = &payload[idx];
+    size_t streamSize = payloadSize - idx;
+    if (stream[streamSize - 1] == 0) return ADV_ERR_FORMAT; // 끝 표시 비트가 없음
+
+    unsigned tableSize = 1u << tableLog;
+    unsigned char tableSymbol[1u << ADV_ANS_MAX_TABLE_LOG];
+    struct AnsDecodeEntry table[1u << ADV_ANS_MAX_TABLE_LOG];
+    spreadAnsSymbols(norm, tableLog, tableSymbol);
+    uint32_t next[256];
+    for (int s = 0; s < 256; s++) next[s] = norm[s];
+    for (unsigned u = 0; u < tableSize; u++) {
+        unsigned char s = tableSymbol[u];
+        uint32_t x = next[s]++;
+        int nbBits = tableLog - highestBit(x);
+        table[u].symbol = s;
+        table[u].nbBits = (unsigned char)nbBits;
+        table[u].newState = (uint16_t)((x << nbBits) - tableSize);
+    }
+
+    struct AnsBitReader reader;
+    reader.start = stream;
+    reader.ptr = stream + streamSize - 8;
+    reader.container = getLE64(reader.ptr);
+    reader.consumed = 8 - (unsigned)highestBit(stream[streamSize - 1]); // 끝 표시와 그 위의 0 비트
+    uint32_t state[2];
+    state[1] = ansReadBits(&reader, tableLog);
+    state[0] = ansReadBits(&reader, tableLog);
+
+    // 다시 읽은 뒤 consumed는 7 이하라 심볼 네 개(최대 4 * 12비트)를 확인 없이 읽는다
+    size_t i = 0;
+    while (rawSize - i >= 4 && reader.ptr - reader.start >= 8) {
+        ansReload(&reader);
+        for (int n = 0; n < 2; n++) {
+            const struct AnsDecodeEntry* e0 = &table[state[0]];
+            const struct AnsDecodeEntry* e1 = &table[state[1]];
+            out[i] = e0->symbol;
+            out[i + 1] = e1->symbol;
+            state[0] = e0->newState + ansReadBits(&reader, e0->nbBits);
+            state[1] = e1->newState + ansReadBits(&reader, e1->nbBits);
+            i += 2;
+        }
+    }
+    // 스트림 앞부분: 한 심볼씩 읽을 비트가 남았는지 확인한다
+    for (; i < rawSize; i++) {
+        ansReload(&reader);
+        const struct AnsDecodeEntry* e = &table[state[i & 1]];
+        if (reader.consumed + e->nbBits > 64) return ADV_ERR_FORMAT;
+        out[i] = e->symbol;
+        state[i & 1] = e->newState + (e->nbBits ? ansReadBits(&reader, e->nbBits) : 0);
+    }
+    return ADV_OK;
+}
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+// 여러 파일을 담는 아카이브
+// [파일 헤더(아카이브 플래그)][항목 0의 프레임]...[항목 n-1의 프레임][끝 프레임][중앙 디렉터리][트레일러]
+// 작은 파일이 많아도 출력은 하나이고, 항목마다 붙는 것은 프레임 헤더와 디렉터리 항목뿐이다.
+
+// 아카이브 쓰기 상태: 인코더와 워커 풀은 모든 항목이 함께 쓴다
+struct AdvArchiveWriter {
+    FILE* dest;
+    struct FrameEncoder enc;
+    struct ProgressMeter meter;
+    int result; // 처음 난 오류 (이후 호출은 그대로 돌려준다)
+    unsigned char* directory;
+    size_t directorySize;
+    size_t directoryCapacity;
+    uint32_t entryCount;
+};
+
+void freeArchiveWriter(struct AdvArchiveWriter* writer) {
+    frameEncoderFree(&writer->enc);
+    free(writer->directory);
+    free(writer);
+}
+
+int advArchiveCreate(FILE* dest, const struct AdvOptions* options, struct AdvArchiveWriter** writer) {
+    *writer = NULL;
+    struct AdvArchiveWriter* w = (struct AdvArchiveWriter*)calloc(1, sizeof(struct AdvArchiveWriter));
+    if (!w) return ADV_ERR_NOMEM;
+    w->dest = dest;
+    progressStart(&w->meter, options, 0);
+    int result = frameEncoderInit(&w->enc, options);
+
+    unsigned char header[ADV_FILE_HEADER_SIZE];
+    writeFileHeader(header);
+    header[ADV_MAGIC_SIZE + 1] = ADV_FLAG_ARCHIVE;
+    if (result == ADV_OK && fwrite(header, 1, sizeof(header), dest) != sizeof(header)) result = ADV_ERR_WRITE;
+    if (result != ADV_OK) {
+        freeArchiveWriter(w);
+        return result;
+    }
+    w->enc.written = ADV_FILE_HEADER_SIZE;
+    progressAdvance(&w->meter, 0, ADV_FILE_HEADER_SIZE, 0);
+    *writer = w;
+    return ADV_OK;
+}
+
+// source를 끝까지 읽어 항목 하나로 더하고 디렉터리 항목을 쌓아 둔다
+int advArchiveAdd(struct AdvArchiveWriter* writer, const char* name, FILE* source, long* processed) {
+    if (writer->result != ADV_OK) return writer->result;
+    size_t nameLength = strlen(name);
+    if (nameLength == 0 || nameLength > ADV_DIR_NAME_MAX) return ADV_ERR_UNSUPPORTED;
+
+    size_t needed = writer->directorySize + ADV_DIR_ENTRY_FIXED + nameLength;
+    if (needed > writer->directoryCapacity) {
+        size_t capacity = needed * 2;
+        unsigned char* grown = (unsigned char*)realloc(writer->directory, capacity);
+        if (!grown) return writer->result = ADV_ERR_NOMEM;
+        writer->directory = grown;
+        writer->directoryCapacity = capacity;
+    }
+
+    uint64_t offset = writer->enc.written;
+    size_t firstBlock = writer->enc.blockCount;
+    uint32_t checksum = 0;
+    int result = encodeFrames(&writer->enc, source, writer->dest, processed, &writer->meter, &checksum);
+    if (result != ADV_OK) return writer->result = result;
+
+    uint64_t size = 0;
+    for (size_t i = firstBlock; i < writer->enc.blockCount; i++) size += writer->enc.rawSize[i];
+
+    unsigned char* entry = &writer->directory[writer->directorySize];
+    entry[0] = (unsigned char)(nameLength & 0xFF);
+    entry[1] = (unsigned char)(nameLength >> 8);
+    memcpy(&entry[2], name, nameLength);
+    entry += 2 + nameLength;
+    putLE64(entry, size);
+    putLE64(&entry[8], offset);
+    putLE64(&entry[16], writer->enc.written - offset);
+    putLE32(&entry[24], (uint32_t)(writer->enc.blockCount - firstBlock));
+    putLE32(&entry[28], checksum);
+    writer->directorySize = needed;
+    writer->entryCount++;
+    return ADV_OK;
+}
+
+// 끝 프레임과 중앙 디렉터리, 트레일러를 기록하고 writer를 해제한다
+int advArchiveClose(struct AdvArchiveWriter* writer) {
+    int result = writer->result;
+    progressStage(&writer->meter, ADV_STAGE_WRITE);
+    unsigned char end = ADV_BLOCK_END;
+    if (result == ADV_OK && fwrite(&end, 1, 1, writer->dest) != 1) result = ADV_ERR_WRITE;
+
+    unsigned char trailer[ADV_DIR_TRAILER_SIZE];
+    putLE64(trailer, writer->enc.written + 1);
+    putLE32(&trailer[8], writer->entryCount);
+    memcpy(&trailer[12], ADV_DIR_MAGIC, 4);
+    if (result == ADV_OK && writer->directorySize > 0 &&
+        fwrite(writer->directory, 1, writer->directorySize, writer->dest) != writer->directorySize) {
+        result = ADV_ERR_WRITE;
+    }
+    if (result == ADV_OK && fwrite(trailer, 1, sizeof(trailer), writer->dest) != sizeof(trailer)) result = ADV_ERR_WRITE;
+    if (result == ADV_OK) progressAdvance(&writer->meter, 0, 1 + writer->directorySize + sizeof(trailer), 0);
+
+    progressFinish(&writer->meter);
+    freeArchiveWriter(writer);
+    return result;
+}
+
+void advArchiveFree(struct AdvArchive* archive) {
+    for (size_t i = 0; i < archive->count; i++) free(archive->entries[i].name);
+    free(archive->entries);
+    archive->entries = NULL;
+    archive->count = 0;
+}
+
+// 디렉터리 바이트를 항목 배열로 푼다. 항목의 프레임은 헤더 뒤부터 끝 프레임 앞까지
+// 겹치지 않고 차례로 놓여 있어야 한다.
+int parseDirectory(const unsigned char* dir, size_t dirSize, uint64_t dirOffset, struct AdvArchive* archive) {
+    size_t pos = 0;
+    uint64_t minOffset = ADV_FILE_HEADER_SIZE;
+    for (size_t i = 0; i < archive->count; i++) {
+        struct AdvArchiveEntry* entry = &archive->entries[i];
+        if (dirSize - pos < 2) return ADV_ERR_FORMAT;
+        size_t nameLength = (size_t)dir[pos] | (size_t)dir[pos + 1] << 8;
+        pos += 2;
+        if (nameLength == 0 || nameLength > ADV_DIR_NAME_MAX || dirSize - pos < nameLength + ADV_DIR_ENTRY_FIXED - 2) {
+            return ADV_ERR_FORMAT;
+        }
+        if (memchr(&dir[pos], '\0', nameLength) != NULL) return ADV_ERR_FORMAT;
+        entry->name = (char*)malloc(nameLength + 1);
+        if (!entry->name) return ADV_ERR_NOMEM;
+        memcpy(entry->name, &dir[pos], nameLength);
+        entry->name[nameLength] = '\0';
+        pos += nameLength;
+
+        entry->size = getLE64(&dir[pos]);
+        entry->offset = getLE64(&dir[pos + 8]);
+        entry->packedSize = getLE64(&dir[pos + 16]);
+        entry->blockCount = getLE32(&dir[pos + 24]);
+        entry->checksum = getLE32(&dir[pos + 28]);
+        pos += ADV_DIR_ENTRY_FIXED - 2;
+
+        if (entry->offset < minOffset || entry->offset > dirOffset - 1 || entry->packedSize > dirOffset - 1 - entry->offset ||
+            entry->size > (uint64_t)entry->blockCount * ADV_BLOCK_SIZE ||
+            entry->packedSize < (uint64_t)entry->blockCount * ADV_BLOCK_HEADER_SIZE) {
+            return ADV_ERR_FORMAT;
+        }
+        minOffset = entry->offset + entry->packedSize;
+    }
+    return pos == dirSize ? ADV_OK : ADV_ERR_FORMAT;
+}
+
+// 파일 헤더와 끝의 트레일러, 중앙 디렉터리만 읽는다 (블록은 풀지 않음)
+int advArchiveOpen(FILE* source, struct AdvArchive* archive) {
+    memset(archive, 0, sizeof(*archive));
+    unsigned char header[ADV_FILE_HEADER_SIZE];
+    unsigned char trailer[ADV_DIR_TRAILER_SIZE];
+    if (fseek(source, 0, SEEK_SET) != 0) return ADV_ERR_READ;
+    if (fread(header, 1, sizeof(header), source) != sizeof(header)) return ferror(source) ? ADV_ERR_READ : ADV_ERR_FORMAT;
+    if (memcmp(header, ADV_MAGIC, ADV_MAGIC_SIZE) != 0 || !isFramedVersion(header[ADV_MAGIC_SIZE]) ||
+        !(header[ADV_MAGIC_SIZE + 1] & ADV_FLAG_ARCHIVE)) {
+        return ADV_ERR_FORMAT;
+    }
+
+    if (fseek(source, 0, SEEK_END) != 0) return ADV_ERR_READ;
+    long fileSize = ftell(source);
+    if (fileSize < ADV_FILE_HEADER_SIZE + 1 + ADV_DIR_TRAILER_SIZE ||
+        fseek(source, -ADV_DIR_TRAILER_SIZE, SEEK_END) != 0 ||
+        fread(trailer, 1, sizeof(trailer), source) != sizeof(trailer) ||
+        memcmp(&trailer[12], ADV_DIR_MAGIC, 4) != 0) {
+        return ADV_ERR_FORMAT;
+    }
+    uint64_t dirOffset = getLE64(trailer);
+    size_t count = getLE32(&trailer[8]);
+    uint64_t dirEnd = (uint64_t)fileSize - ADV_DIR_TRAILER_SIZE;
+    if (dirOffset < ADV_FILE_HEADER_SIZE + 1 || dirOffset > dirEnd ||
+        (uint64_t)count * ADV_DIR_ENTRY_FIXED > dirEnd - dirOffset) {
+        return ADV_ERR_FORMAT;
+    }
+
+    size_t dirSize = (size_t)(dirEnd - dirOffset);
+    unsigned char* dir = (unsigned char*)malloc(dirSize + 1);
+    archive->entries = (struct AdvArchiveEntry*)calloc(count + 1, sizeof(struct AdvArchiveEntry));
+    archive->count = count;
+    archive->version = header[ADV_MAGIC_SIZE];
+    int result;
+    if (!dir || !archive->entries) {
+        result = ADV_ERR_NOMEM;
+    } else if (fseek(source, (long)dirOffset, SEEK_SET) != 0 || fread(dir, 1, dirSize, source) != dirSize) {
+        result = ADV_ERR_READ;
+    } else {
+        result = parseDirectory(dir, dirSize, dirOffset, archive);
+    }
+    free(dir);
+    if (result != ADV_OK) {
+        if (archive->entries == NULL) archive->count = 0;
+        advArchiveFree(archive);
+    }
+    return result;
+}
+
+long advArchiveFind(const struct AdvArchive* archive, const char* name) {
+    for (size_t i = 0; i < archive->count; i++) {
+        if (strcmp(archive->entries[i].name, name) == 0) return (long)i;
+    }
+    return -1;
+}
+
+// 항목 하나의 프레임만 읽어 풀고, 원본 크기와 CRC32C를 디렉터리 값과 대조한다
+int advArchiveExtract(FILE* source, const struct AdvArchive* archive, size_t index, FILE* dest, long* processed, const struct AdvOptions* options) {
+    if (index >= archive->count) return ADV_ERR_UNSUPPORTED;
+    const struct AdvArchiveEntry* entry = &archive->entries[index];
+    struct ProgressMeter meter;
+    progressStart(&meter, options, (long long)entry->packedSize);
+
+    int result = fseek(source, (long)entry->offset, SEEK_SET) == 0 ? ADV_OK : ADV_ERR_READ;
+    uint32_t checksum = 0;
+    if (result == ADV_OK) {
+        result = decodeSequential(archive->version, source, dest, entry->blockCount, entry->packedSize, processed, &meter, &checksum);
+    }
+    if (result == ADV_OK && ((unsigned long long)meter.state.outputBytes != entry->size ||
+                             (unsigned long long)meter.state.inputBytes != entry->packedSize)) {
+        result = ADV_ERR_FORMAT;
+    }
+    if (result == ADV_OK && checksum != entry->checksum) result = ADV_ERR_CHECKSUM;
+    progressFinish(&meter);
+    return result;
+}
@@ -0,0 +1,664 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#endif
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+// 코덱 벤치마크: 고정된 시드로 만든 합성 코퍼스(또는 지정한 파일)를 단계별로 측정한다.
+// 단계 측정은 한 스레드에서 블록 단위로, 전체 압축/해제는 라이브러리 API 그대로 측정한다.
+// 각 값은 반복 중 가장 빠른 결과이며 MB/s는 원본 10^6 바이트 기준이다.
+
+#define BENCH_SEED 0x9E3779B97F4A7C15ULL
+#define BENCH_DEFAULT_SIZES "4K,64K,1M,16M"
+#define BENCH_DEFAULT_REPS 3
+#define BENCH_MIN_BYTES (32u * 1024 * 1024) // 작은 입력은 단계마다 이만큼 처리될 때까지 반복
+#define BENCH_COMPRESSED_SOURCE (8u * 1024 * 1024) // 압축 데이터 코퍼스를 만들 원본 텍스트 크기
+#define BENCH_MAX_INPUTS 64
+
+enum {
+    BENCH_FORMAT_TEXT,
+    BENCH_FORMAT_CSV,
+    BENCH_FORMAT_JSON
+};
+
+// 합성 코퍼스 종류
+enum {
+    CORPUS_TEXT,
+    CORPUS_BINARY,
+    CORPUS_COMPRESSED,
+    CORPUS_SINGLE,
+    CORPUS_RANDOM,
+    CORPUS_KIND_COUNT
+};
+
+const char *corpusNames[CORPUS_KIND_COUNT] = { "text", "binary", "compressed", "single", "random" };
+
+struct BenchCorpus {
+    char name[64];
+    unsigned char *data;
+    size_t size;
+};
+
+// 단계별 소요 시간(초)과 결과. 단계 시간은 입력 전체를 한 번 처리한 시간으로 환산한 값이다.
+struct BenchResult {
+    double histSec;
+    double treeSec;
+    double encodeSec;
+    double decodeSec;
+    double ansSec;
+    double unansSec;
+    double ctxSec;
+    double unctxSec;
+    double lzSec;
+    double unlzSec;
+    double bwtSec;
+    double unbwtSec;
+    double compressSec;
+    double decompressSec;
+    size_t compressedSize;
+    long peakKb;
+    int verified;
+};
+
+struct BenchOptions {
+    size_t sizes[BENCH_MAX_INPUTS];
+    int sizeCount;
+    int kinds[CORPUS_KIND_COUNT];
+    const char *files[BENCH_MAX_INPUTS];
+    int fileCount;
+    int reps;
+    int format;
+    const char *label;
+    struct AdvOptions codec;
+};
+
+// 재현 가능한 의사 난수 (xorshift64*)
+uint64_t benchRandom(uint64_t *state) {
+    uint64_t x = *state;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    *state = x;
+    return x * 0x2545F4914F6CDD1DULL;
+}
+
+// 낱말 빈도가 한쪽으로 치우친 문장. 한글(UTF-8)과 영문을 섞는다.
+void generateText(unsigned char *out, size_t size, uint64_t seed) {
+    static const char *words[] = {
+        "the", "of", "and", "to", "a", "in", "is", "that", "for", "it",
+        "압축", "파일", "데이터", "블록", "하프만", "코드", "길이", "빈도",
+        "with", "as", "was", "on", "be", "by", "this", "are", "from", "or",
+        "compression", "entropy", "symbol", "table", "stream", "buffer",
+        "처리", "속도", "메모리", "결과", "입력", "출력", "그리고", "하지만",
+        "decoder", "encoder", "frequency", "histogram", "benchmark", "pipeline"
+    };
+    const size_t wordCount = sizeof(words) / sizeof(words[0]);
+    uint64_t state = seed;
+    size_t pos = 0;
+    unsigned inSentence = 0;
+    while (pos < size) {
+        uint64_t r = benchRandom(&state);
+        // 두 난수의 곱으로 앞쪽 낱말이 더 자주 나오게 한다
+        size_t index = (size_t)((r % wordCount) * ((r >> 32) % wordCount) / wordCount);
+        const char *word = words[index];
+        for (size_t i = 0; word[i] && pos < size; i++) out[pos++] = (unsigned char)word[i];
+        if (pos >= size) break;
+        if (++inSentence >= 8 + (r >> 60)) {
+            out[pos++] = '.';
+            if (pos < size) out[pos++] = (r & 3) == 0 ? '\n' : ' ';
+            inSentence = 0;
+        } else {
+            out[pos++] = ' ';
+        }
+    }
+}
+
+// 실행 파일이나 데이터베이스 페이지처럼 구조가 있는 16바이트 레코드 배열
+void generateBinary(unsigned char *out, size_t size, uint64_t seed) {
+    static const unsigned char opcodes[] = { 0x48, 0x89, 0x8B, 0xE8, 0xC3, 0x0F, 0x85, 0x00 };
+    uint64_t state = seed;
+    uint32_t id = 0;
+    size_t pos = 0;
+    while (pos < size) {
+        unsigned char record[16];
+        uint64_t r = benchRandom(&state);
+        putLE32(&record[0], id++);
+        putLE32(&record[4], (uint32_t)(r % 1000));
+        putLE32(&record[8], (uint32_t)(r >> 40) & 0x00FFFF00u);
+        for (int i = 12; i < 16; i++) record[i] = opcodes[(r >> (i * 3)) & 7];
+        size_t n = size - pos < sizeof(record) ? size - pos : sizeof(record);
+        memcpy(&out[pos], record, n);
+        pos += n;
+    }
+}
+
+void generateRandom(unsigned char *out, size_t size, uint64_t seed) {
+    uint64_t state = seed;
+    size_t pos = 0;
+    while (pos < size) {
+        uint64_t r = benchRandom(&state);
+        size_t n = size - pos < 8 ? size - pos : 8;
+        memcpy(&out[pos], &r, n);
+        pos += n;
+    }
+}
+
+// 이미 압축된 데이터: 합성 텍스트를 이 코덱으로 압축한 결과를 필요한 크기만큼 반복한다
+int generateCompressed(unsigned char *out, size_t size, uint64_t seed) {
+    size_t sourceSize = BENCH_COMPRESSED_SOURCE;
+    unsigned char *source = (unsigned char *)malloc(sourceSize);
+    if (!source) return ADV_ERR_NOMEM;
+    generateText(source, sourceSize, seed);
+    unsigned char *packed = NULL;
+    size_t packedSize = 0;
+    int result = advancedCompression(source, sourceSize, &packed, &packedSize, NULL);
+    free(source);
+    if (result != ADV_OK) return result;
+    for (size_t pos = 0; pos < size; pos += packedSize) {
+        size_t n = size - pos < packedSize ? size - pos : packedSize;
+        memcpy(&out[pos], packed, n);
+    }
+    free(packed);
+    return ADV_OK;
+}
+
+int generateCorpus(int kind, size_t size, struct BenchCorpus *corpus) {
+    corpus->data = (unsigned char *)malloc(size ? size : 1);
+    if (!corpus->data) return ADV_ERR_NOMEM;
+    corpus->size = size;
+    snprintf(corpus->name, sizeof(corpus->name), "%s", corpusNames[kind]);
+    uint64_t seed = BENCH_SEED + (uint64_t)kind;
+    switch (kind) {
+    case CORPUS_TEXT: generateText(corpus->data, size, seed); break;
+    case CORPUS_BINARY: generateBinary(corpus->data, size, seed); break;
+    case CORPUS_COMPRESSED: return generateCompressed(corpus->data, size, seed);
+    case CORPUS_SINGLE: memset(corpus->data, 'A', size); break;
+    default: generateRandom(corpus->data, size, seed); break;
+    }
+    return ADV_OK;
+}
+
+int loadCorpus(const char *path, struct BenchCorpus *corpus) {
+    FILE *file = fopen(path, "rb");
+    if (!file) return ADV_ERR_READ;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        fclose(file);
+        return ADV_ERR_READ;
+    }
+    corpus->data = (unsigned char *)malloc(size ? (size_t)size : 1);
+    if (!corpus->data) {
+        fclose(file);
+        return ADV_ERR_NOMEM;
+    }
+    corpus->size = (size_t)size;
+    if (fread(corpus->data, 1, corpus->size, file) != corpus->size) {
+        fclose(file);
+        free(corpus->data);
+        return ADV_ERR_READ;
+    }
+    fclose(file);
+    const char *base = path;
+    for (const char *p = path; *p; p++) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    snprintf(corpus->name, sizeof(corpus->name), "file:%s", base);
+    return ADV_OK;
+}
+
+// 측정 구간의 최대 상주 메모리를 재기 위해 기준점을 잡는다. 기준 RSS(KB)를 돌려준다.
+// 리눅스는 clear_refs로 최대치를 초기화하며, 그 밖의 환경은 프로세스 전체 최대치를 쓴다.
+long resetPeakMemory(void) {
+#if defined(__linux__)
+    FILE *refs = fopen("/proc/self/clear_refs", "w");
+    if (refs) {
+        fputs("5", refs);
+        fclose(refs);
+    }
+    long rssKb = -1;
+    char line[256];
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status) return -1;
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, "VmRSS:", 6) == 0) rssKb = strtol(line + 6, NULL, 10);
+    }
+    fclose(status);
+    return rssKb;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return (long)(counters.WorkingSetSize / 1024);
+#else
+    return -1;
+#endif
+}
+
+long readPeakMemory(void) {
+#if defined(__linux__)
+    long peakKb = -1;
+    char line[256];
+    FILE *status = fopen("/proc/self/status", "r");
+    if (!status) return -1;
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, "VmHWM:", 6) == 0) peakKb = strtol(line + 6, NULL, 10);
+    }
+    fclose(status);
+    return peakKb;
+#elif defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) return -1;
+    return (long)(counters.PeakWorkingSetSize / 1024);
+#else
+    return -1;
+#endif
+}
+
+double minTime(double best, double sample) {
+    return best < 0 || sample < best ? sample : best;
+}
+
+// 블록 하나씩 빈도 계산, 코드 길이/정규 코드 생성, 인코딩, 디코딩 단계를 따로 잰다.
+// 같은 빈도표로 tANS 부호화와 해제도 잰다. 압축 강도가 1 이상이면 LZ 블록 압축(일치 탐색과 부호화)과 해제도 따로 잰다.
+int benchStages(const struct BenchCorpus *corpus, const struct BenchOptions *opts, struct BenchResult *result) {
+    unsigned char *encoded = (unsigned char *)malloc(ADV_BLOCK_BOUND(ADV_BLOCK_SIZE));
+    unsigned char *decoded = (unsigned char *)malloc(ADV_BLOCK_SIZE);
+    if (!encoded || !decoded) {
+        free(encoded);
+        free(decoded);
+        return ADV_ERR_NOMEM;
+    }
+
+    size_t passes = corpus->size ? BENCH_MIN_BYTES / corpus->size : 1;
+    if (passes == 0) passes = 1;
+    result->histSec = result->treeSec = result->encodeSec = result->decodeSec = -1;
+    result->ansSec = result->unansSec = result->ctxSec = result->unctxSec = result->lzSec = result->unlzSec = result->bwtSec = result->unbwtSec = -1;
+    result->verified = 1;
+
+    for (int rep = 0; rep < opts->reps; rep++) {
+        double hist = 0, tree = 0, encode = 0, decode = 0, ans = 0, unans = 0, ctx = 0, unctx = 0, lz = 0, unlz = 0, bwt = 0, unbwt = 0;
+        int ctxBlocks = 0;
+        for (size_t pass = 0; pass < passes; pass++) {
+            for (size_t offset = 0; offset < corpus->size; offset += ADV_BLOCK_SIZE) {
+                const unsigned char *block = &corpus->data[offset];
+                size_t blockSize = corpus->size - offset < ADV_BLOCK_SIZE ? corpus->size - offset : ADV_BLOCK_SIZE;
+                unsigned freq[256];
+                unsigned char lengths[256];
+                uint64_t codes[256];
+
+                double t0 = getMonotonicTime();
+                calculateFrequency(block, blockSize, freq);
+                double t1 = getMonotonicTime();
+                buildCodeLengths(freq, 256, lengths, opts->codec.maxCodeLength);
+                assignCanonicalCodes(lengths, 256, codes);
+                double t2 = getMonotonicTime();
+                // 블록 압축과 같이 ADV_HUFF_STREAMS_MIN 이상이면 다중 스트림으로 잰다
+                int multiStream = blockSize >= ADV_HUFF_STREAMS_MIN;
+                size_t encodedSize = multiStream ? huffmanEncodeStreams(block, blockSize, encoded, codes, lengths)
+                                                 : huffmanEncode(block, blockSize, encoded, codes, lengths);
+                double t3 = getMonotonicTime();
+                size_t decodedSize = blockSize;
+                if (multiStream) {
+                    if (huffmanDecodeStreams(encoded, encodedSize, codes, lengths, decoded, blockSize) != ADV_OK) decodedSize = 0;
+                } else {
+                    decodedSize = huffmanDecode(encoded, encodedSize, codes, lengths, decoded, blockSize);
+                }
+                double t4 = getMonotonicTime();
+
+                hist += t1 - t0;
+                tree += t2 - t1;
+                encode += t3 - t2;
+                decode += t4 - t3;
+                if (pass == 0 && (decodedSize != blockSize || memcmp(decoded, block, blockSize) != 0)) {
+                    result->verified = 0;
+                }
+
+                uint16_t norm[256];
+                double a0 = getMonotonicTime();
+                estimateAnsBlock(freq, blockSize, norm);
+                size_t ansSize = compressAnsBlock(block, blockSize, norm, encoded);
+                double a1 = getMonotonicTime();
+                int ansStatus = decompressAnsBlock(&encoded[ADV_BLOCK_HEADER_SIZE], ansSize - ADV_BLOCK_HEADER_SIZE, decoded, blockSize);
+                double a2 = getMonotonicTime();
+                ans += a1 - a0;
+                unans += a2 - a1;
+                if (pass == 0 && (ansStatus != ADV_OK || memcmp(decoded, block, blockSize) != 0)) {
+                    result->verified = 0;
+                }
+
+                // 문맥 하프만은 묶음 추정까지 포함해 잰다. 후보가 못 되는 블록은 추정 시간만 세며, 한 블록도 없으면 0으로 보고한다.
+                struct ContextModel context;
+                double c0 = getMonotonicTime();
+                size_t ctxEstimate = estimateContextBlock(block, blockSize, opts->codec.maxCodeLength, &context);
+                size_t ctxSize = ctxEstimate != SIZE_MAX ? compressContextBlock(block, blockSize, &context, encoded) : 0;
+                double c1 = getMonotonicTime();
+                int ctxStatus = ctxSize > 0 ? decompressContextBlock(&encoded[ADV_BLOCK_HEADER_SIZE], ctxSize - ADV_BLOCK_HEADER_SIZE, decoded, blockSize) : ADV_OK;
+                double c2 = getMonotonicTime();
+                ctx += c1 - c0;
+                unctx += c2 - c1;
+                ctxBlocks += ctxSize > 0;
+                if (pass == 0 && ctxSize > 0 && (ctxStatus != ADV_OK || memcmp(decoded, block, blockSize) != 0)) {
+                    result->verified = 0;
+                }
+                if (opts->codec.blockSort) {
+                    double b0 = getMonotonicTime();
+                    size_t bwtSize = compressBwtBlock(block, blockSize, encoded, &opts->codec, ADV_BLOCK_BOUND(blockSize));
+                    double b1 = getMonotonicTime();
+                    int bwtStatus = bwtSize > 0 ? decompressBwtBlock(&encoded[ADV_BLOCK_HEADER_SIZE], bwtSize - ADV_BLOCK_HEADER_SIZE, decoded, blockSize) : ADV_OK;
+                    double b2 = getMonotonicTime();
+                    bwt += b1 - b0;
+                    unbwt += b2 - b1;
+                    if (pass == 0 && bwtSize > 0 && (bwtStatus != ADV_OK || memcmp(decoded, block, blockSize) != 0)) {
+                        result->verified = 0;
+                    }
+                }
+                if (opts->codec.level == 0) continue;
+
+                double t5 = getMonotonicTime();
+                size_t lzSize = compressLzBlock(block, blockSize, encoded, &opts->codec, ADV_BLOCK_BOUND(blockSize));
+                double t6 = getMonotonicTime();
+                int status = lzSize > 0 ? decompressLzBlock(ADV_FORMAT_VERSION, &encoded[ADV_BLOCK_HEADER_SIZE], lzSize - ADV_BLOCK_HEADER_SIZE, decoded, blockSize) : ADV_OK;
+                double t7 = getMonotonicTime();
+                lz += t6 - t5;
+                unlz += t7 - t6;
+                if (pass == 0 && lzSize > 0 && (status != ADV_OK || memcmp(decoded, block, blockSize) != 0)) {
+                    result->verified = 0;
+                }
+            }
+        }
+        result->histSec = minTime(result->histSec, hist / passes);
+        result->treeSec = minTime(result->treeSec, tree / passes);
+        result->encodeSec = minTime(result->encodeSec, encode / passes);
+        result->decodeSec = minTime(result->decodeSec, decode / passes);
+        result->ansSec = minTime(result->ansSec, ans / passes);
+        result->unansSec = minTime(result->unansSec, unans / passes);
+        if (ctxBlocks > 0) {
+            result->ctxSec = minTime(result->ctxSec, ctx / passes);
+            result->unctxSec = minTime(result->unctxSec, unctx / passes);
+        }
+        result->lzSec = minTime(result->lzSec, lz / passes);
+        result->unlzSec = minTime(result->unlzSec, unlz / passes);
+        if (opts->codec.blockSort) {
+            result->bwtSec = minTime(result->bwtSec, bwt / passes);
+            result->unbwtSec = minTime(result->unbwtSec, unbwt / passes);
+        }
+    }
+
+    free(encoded);
+    free(decoded);
+    return ADV_OK;
+}
+
+// 라이브러리 API 그대로(병렬, 프레임/인덱스 포함) 압축과 해제를 잰다
+int benchRoundTrip(const struct BenchCorpus *corpus, const struct BenchOptions *opts, struct BenchResult *result) {
+    long baseKb = resetPeakMemory();
+    result->compressSec = result->decompressSec = -1;
+    for (int rep = 0; rep < opts->reps; rep++) {
+        unsigned char *packed = NULL, *restored = NULL;
+        size_t packedSize = 0, restoredSize = 0;
+
+        double t0 = getMonotonicTime();
+        int status = advancedCompression(corpus->data, corpus->size, &packed, &packedSize, &opts->codec);
+        double t1 = getMonotonicTime();
+        if (status != ADV_OK) return status;
+        status = advancedDecompression(packed, packedSize, &restored, &restoredSize);
+        double t2 = getMonotonicTime();
+        if (status != ADV_OK) {
+            free(packed);
+            return status;
+        }
+
+        result->compressSec = minTime(result->compressSec, t1 - t0);
+        result->decompressSec = minTime(result->decompressSec, t2 - t1);
+        result->compressedSize = packedSize;
+        if (restoredSize != corpus->size || (corpus->size && memcmp(restored, corpus->data, corpus->size) != 0)) {
+            result->verified = 0;
+        }
+        free(packed);
+        free(restored);
+    }
+    long peakKb = readPeakMemory();
+    result->peakKb = baseKb >= 0 && peakKb >= baseKb ? peakKb - baseKb : -1;
+    return ADV_OK;
+}
+
+double mbPerSec(size_t bytes, double seconds) {
+    return seconds > 0 ? (double)bytes / seconds / 1e6 : 0.0;
+}
+
+void printHeader(const struct BenchOptions *opts) {
+    if (opts->format == BENCH_FORMAT_CSV) {
+        printf("label,corpus,size,compressed_size,ratio,hist_mbps,tree_mbps,encode_mbps,decode_mbps,ans_mbps,unans_mbps,ctx_mbps,unctx_mbps,lz_mbps,unlz_mbps,bwt_mbps,unbwt_mbps,"
+               "compress_mbps,decompress_mbps,peak_kb,threads,max_code_len,level,block_sort,verified\n");
+    } else if (opts->format == BENCH_FORMAT_JSON) {
+        printf("{\"label\":\"%s\",\"threads\":%d,\"block_size\":%d,\"reps\":%d,\"max_code_len\":%d,\"level\":%d,\"block_sort\":%d,\"results\":[",
+               opts->label, getCpuCount(), ADV_BLOCK_SIZE, opts->reps, opts->codec.maxCodeLength, opts->codec.level, opts->codec.blockSort);
+    } else {
+        printf("%-20s %12s %7s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %9s %10s\n", "corpus", "size", "ratio",
+               "hist", "tree", "encode", "decode", "ans", "unans", "ctx", "unctx", "lz", "unlz", "bwt", "unbwt", "compress", "decomp", "peak_kb");
+    }
+}
+
+void printResult(const struct BenchOptions *opts, const struct BenchCorpus *corpus, const struct BenchResult *r, int first) {
+    double ratio = corpus->size ? (double)r->compressedSize / corpus->size : 0.0;
+    if (opts->format == BENCH_FORMAT_CSV) {
+        printf("%s,%s,%zu,%zu,%.4f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%.1f,%ld,%d,%d,%d,%d,%d\n",
+               opts->label, corpus->name, corpus->size, r->compressedSize, ratio,
+               mbPerSec(corpus->size, r->histSec), mbPerSec(corpus->size, r->treeSec),
+               mbPerSec(corpus->size, r->encodeSec), mbPerSec(corpus->size, r->decodeSec),
+               mbPerSec(corpus->size, r->ansSec), mbPerSec(corpus->size, r->unansSec),
+               mbPerSec(corpus->size, r->ctxSec), mbPerSec(corpus->size, r->unctxSec),
+               mbPerSec(corpus->size, r->lzSec), mbPerSec(corpus->size, r->unlzSec),
+               mbPerSec(corpus->size, r->bwtSec), mbPerSec(corpus->size, r->unbwtSec),
+               mbPerSec(corpus->size, r->compressSec), mbPerSec(corpus->size, r->decompressSec),
+               r->peakKb, getCpuCount(), opts->codec.maxCodeLength, opts->codec.level, opts->codec.blockSort, r->verified);
+    } else if (opts->format == BENCH_FORMAT_JSON) {
+        printf("%s\n  {\"corpus\":\"%s\",\"size\":%zu,\"compressed_size\":%zu,\"ratio\":%.4f,"
+               "\"hist_mbps\":%.1f,\"tree_mbps\":%.1f,\"encode_mbps\":%.1f,\"decode_mbps\":%.1f,"
+               "\"ans_mbps\":%.1f,\"unans_mbps\":%.1f,\"ctx_mbps\":%.1f,\"unctx_mbps\":%.1f,\"lz_mbps\":%.1f,\"unlz_mbps\":%.1f,\"bwt_mbps\":%.1f,\"unbwt_mbps\":%.1f,\"compress_mbps\":%.1f,\"decompress_mbps\":%.1f,\"peak_kb\":%ld,\"verified\":%s}",
+               first ? "" : ",", corpus->name, corpus->size, r->compressedSize, ratio,
+               mbPerSec(corpus->size, r->histSec), mbPerSec(corpus->size, r->treeSec),
+               mbPerSec(corpus->size, r->encodeSec), mbPerSec(corpus->size, r->decodeSec),
+               mbPerSec(corpus->size, r->ansSec), mbPerSec(corpus->size, r->unansSec),
+               mbPerSec(corpus->size, r->ctxSec), mbPerSec(corpus->size, r->unctxSec),
+               mbPerSec(corpus->size, r->lzSec), mbPerSec(corpus->size, r->unlzSec),
+               mbPerSec(corpus->size, r->bwtSec), mbPerSec(corpus->size, r->unbwtSec),
+               mbPerSec(corpus->size, r->compressSec), mbPerSec(corpus->size, r->decompressSec),
+               r->peakKb, r->verified ? "true" : "false");
+    } else {
+        printf("%-20s %12zu %6.1f%% %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %9.1f %10ld%s\n",
+               corpus->name, corpus->size, ratio * 100.0,
+               mbPerSec(corpus->size, r->histSec), mbPerSec(corpus->size, r->treeSec),
+               mbPerSec(corpus->size, r->encodeSec), mbPerSec(corpus->size, r->decodeSec),
+               mbPerSec(corpus->size, r->ansSec), mbPerSec(corpus->size, r->unansSec),
+               mbPerSec(corpus->size, r->ctxSec), mbPerSec(corpus->size, r->unctxSec),
+               mbPerSec(corpus->size, r->lzSec), mbPerSec(corpus->size, r->unlzSec),
+               mbPerSec(corpus->size, r->bwtSec), mbPerSec(corpus->size, r->unbwtSec),
+               mbPerSec(corpus->size, r->compressSec), mbPerSec(corpus->size, r->decompressSec),
+               r->peakKb, r->verified ? "" : "  검증 실패");
+    }
+    fflush(stdout);
+}
+
+void printFooter(const struct BenchOptions *opts) {
+    if (opts->format == BENCH_FORMAT_JSON) printf("\n]}\n");
+}
+
+// 코퍼스 하나를 측정하고 출력한다. 복원 결과가 원본과 다르면 1을 돌려준다.
+int runCorpus(const struct BenchOptions *opts, const struct BenchCorpus *corpus, int first) {
+    struct BenchResult result;
+    memset(&result, 0, sizeof(result));
+    int status = benchStages(corpus, opts, &result);
+    if (status == ADV_OK) status = benchRoundTrip(corpus, opts, &result);
+    if (status != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", corpus->name, advErrorMessage(status));
+        return 1;
+    }
+    printResult(opts, corpus, &result, first);
+    return result.verified ? 0 : 1;
+}
+
+// "4K,1M,1G" 형태의 크기 목록을 읽는다
+int parseSizes(const char *list, struct BenchOptions *opts) {
+    opts->sizeCount = 0;
+    const char *p = list;
+    while (*p) {
+        char *end;
+        unsigned long long value = strtoull(p, &end, 10);
+        if (end == p || opts->sizeCount >= BENCH_MAX_INPUTS) return 0;
+        switch (*end) {
+        case 'k': case 'K': value <<= 10; end++; break;
+        case 'm': case 'M': value <<= 20; end++; break;
+        case 'g': case 'G': value <<= 30; end++; break;
+        default: break;
+        }
+        opts->sizes[opts->sizeCount++] = (size_t)value;
+        if (*end == ',') end++;
+        else if (*end != '\0') return 0;
+        p = end;
+    }
+    return opts->sizeCount > 0;
+}
+
+int parseKinds(const char *list, struct BenchOptions *opts) {
+    memset(opts->kinds, 0, sizeof(opts->kinds));
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s", list);
+    for (char *name = strtok(buffer, ","); name; name = strtok(NULL, ",")) {
+        int found = 0;
+        for (int k = 0; k < CORPUS_KIND_COUNT; k++) {
+            if (strcmp(name, corpusNames[k]) == 0) {
+                opts->kinds[k] = 1;
+                found = 1;
+            }
+        }
+        if (!found) return 0;
+    }
+    return 1;
+}
+
+void printUsage(const char *prog) {
+    fprintf(stderr,
+            "사용법: %s [-s 크기목록] [-k 종류목록] [-i 파일]... [-r 반복] [-e 강도] [-B 0|1] [-L 비트] [-f text|csv|json] [-l 라벨]\n"
+            "  -s  합성 코퍼스 크기 (기본값 %s, K/M/G 단위)\n"
+            "  -k  합성 코퍼스 종류 (text,binary,compressed,single,random 중 선택, 기본값 전부)\n"
+            "  -i  파일을 코퍼스로 추가 (여러 번 지정 가능)\n"
+            "  -r  반복 횟수, 가장 빠른 결과를 쓴다 (기본값 %d)\n"
+            "  -e  압축 강도 (%d~%d, 기본값 %d)\n"
+            "  -B  1이면 블록 정렬(BWT) 모드로 압축하고 그 단계를 따로 잰다 (기본값 0)\n"
+            "  -L  하프만 코드 길이 상한 (%d~%d, 기본값 %d)\n"
+            "  -f  출력 형식 (기본값 text)\n"
+            "  -l  결과에 붙일 라벨 (빌드 간 비교용)\n",
+            prog, BENCH_DEFAULT_SIZES, BENCH_DEFAULT_REPS, ADV_LEVEL_MIN, ADV_LEVEL_MAX, ADV_LEVEL_DEFAULT, ADV_CODE_LIMIT_MIN, ADV_CODE_LIMIT_MAX, ADV_CODE_LIMIT_DEFAULT);
+}
+
+int main(int argc, char *argv[]) {
+    struct BenchOptions opts;
+    memset(&opts, 0, sizeof(opts));
+    opts.reps = BENCH_DEFAULT_REPS;
+    opts.format = BENCH_FORMAT_TEXT;
+    opts.label = "";
+    advDefaultOptions(&opts.codec);
+#ifdef __GLIBC__
+    // 해제한 큰 버퍼가 힙에 남아 다음 측정의 최대 메모리에 잡히지 않도록
+    // mmap 기준을 고정해 큰 할당은 매번 운영체제에서 받고 돌려주게 한다
+    mallopt(M_MMAP_THRESHOLD, 128 * 1024);
+#endif
+    parseSizes(BENCH_DEFAULT_SIZES, &opts);
+    for (int k = 0; k < CORPUS_KIND_COUNT; k++) opts.kinds[k] = 1;
+    int syntheticOnly = 1; // -i만 주면 합성 코퍼스는 -s/-k를 함께 줄 때만 측정한다
+    int syntheticRequested = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(arg, "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        }
+        if (arg[0] != '-' || arg[1] == '\0' || arg[2] != '\0' || value == NULL) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        int ok = 1;
+        switch (arg[1]) {
+        case 's': ok = parseSizes(value, &opts); syntheticRequested = 1; break;
+        case 'k': ok = parseKinds(value, &opts); syntheticRequested = 1; break;
+        case 'i':
+            if (opts.fileCount >= BENCH_MAX_INPUTS) ok = 0;
+            else opts.files[opts.fileCount++] = value;
+            syntheticOnly = 0;
+            break;
+        case 'r': opts.reps = atoi(value); ok = opts.reps > 0; break;
+        case 'l': opts.label = value; break;
+        case 'e':
+            opts.codec.level = atoi(value);
+            ok = value[0] >= '0' && value[0] <= '9' && opts.codec.level >= ADV_LEVEL_MIN && opts.codec.level <= ADV_LEVEL_MAX;
+            break;
+        case 'B':
+            opts.codec.blockSort = atoi(value);
+            ok = strcmp(value, "0") == 0 || strcmp(value, "1") == 0;
+            break;
+        case 'L':
+            opts.codec.maxCodeLength = atoi(value);
+            ok = opts.codec.maxCodeLength >= ADV_CODE_LIMIT_MIN && opts.codec.maxCodeLength <= ADV_CODE_LIMIT_MAX;
+            break;
+        case 'f':
+            if (strcmp(value, "csv") == 0) opts.format = BENCH_FORMAT_CSV;
+            else if (strcmp(value, "json") == 0) opts.format = BENCH_FORMAT_JSON;
+            else if (strcmp(value, "text") == 0) opts.format = BENCH_FORMAT_TEXT;
+            else ok = 0;
+            break;
+        default: ok = 0; break;
+        }
+        if (!ok) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+
+    printHeader(&opts);
+    int failed = 0;
+    int first = 1;
+    for (int f = 0; f < opts.fileCount; f++) {
+        struct BenchCorpus corpus;
+        int status = loadCorpus(opts.files[f], &corpus);
+        if (status != ADV_OK) {
+            fprintf(stderr, "%s: %s\n", opts.files[f], advErrorMessage(status));
+            failed = 1;
+            continue;
+        }
+        failed |= runCorpus(&opts, &corpus, first);
+        first = 0;
+        free(corpus.data);
+    }
+    if (syntheticOnly || syntheticRequested) {
+        for (int k = 0; k < CORPUS_KIND_COUNT; k++) {
+            if (!opts.kinds[k]) continue;
+            for (int s = 0; s < opts.sizeCount; s++) {
+                struct BenchCorpus corpus;
+                int status = generateCorpus(k, opts.sizes[s], &corpus);
+                if (status != ADV_OK) {
+                    fprintf(stderr, "%s: %s\n", corpusNames[k], advErrorMessage(status));
+                    free(corpus.data);
+                    failed = 1;
+                    continue;
+                }
+                failed |= runCorpus(&opts, &corpus, first);
+                first = 0;
+                free(corpus.data);
+            }
+        }
+    }
+    printFooter(&opts);
+    return failed ? 1 : 0;
+}
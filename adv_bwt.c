@@ -0,0 +1,525 @@
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+// 블록 정렬 블록 (BWT + MTF + 0 연속 부호 + 하프만)
+// 블록의 접미사 배열을 SA-IS로 선형 시간에 만들어 BWT를 구하면 같은 문맥 뒤의 바이트가 한데 모인다.
+// MTF로 바꾸면 대부분 0과 작은 값이 되고, 0의 연속은 RUNA/RUNB 두 심볼의 전단사 2진수로 줄인 뒤
+// 남은 257개 심볼을 기존 하프만 함수로 부호화한다. 느리지만 텍스트에서 가장 작은 블록을 만든다.
+
+// 접미사 배열 원소의 형(S/L)은 비트 하나씩 저장한다. 위치 n(가상의 끝 문자)은 S형이다.
+#define SAIS_CHAR(text, wide, i) ((wide) ? ((const int32_t*)(text))[i] : (int32_t)((const unsigned char*)(text))[i])
+#define SAIS_IS_S(types, i) (((types)[(i) >> 3] >> ((i) & 7)) & 1)
+#define SAIS_IS_LMS(types, i) ((i) > 0 && SAIS_IS_S(types, i) && !SAIS_IS_S(types, (i) - 1))
+
+// 문자마다 버킷의 시작 위치 (end가 0이 아니면 끝 위치)
+void saisBuckets(const void* text, int wide, int32_t n, int32_t alphabet, int32_t* bucket, int end) {
+    memset(bucket, 0, (size_t)alphabet * sizeof(int32_t));
+    if (wide) {
+        const int32_t* t = (const int32_t*)text;
+        for (int32_t i = 0; i < n; i++) bucket[t[i]]++;
+    } else {
+        const unsigned char* t = (const unsigned char*)text;
+        for (int32_t i = 0; i < n; i++) bucket[t[i]]++;
+    }
+    int32_t sum = 0;
+    for (int32_t c = 0; c < alphabet; c++) {
+        sum += bucket[c];
+        bucket[c] = end ? sum : sum - bucket[c];
+    }
+}
+
+// 버킷 끝에 놓인 LMS 위치로부터 L형(왼쪽에서 오른쪽), S형(오른쪽에서 왼쪽) 위치를 차례로 유도한다.
+// 접근마다 문자 크기를 가르지 않도록 바이트 문자열과 int32_t 문자열의 반복문을 따로 둔다.
+void saisInduce(const void* text, int wide, int32_t* sa, int32_t n, int32_t alphabet, const unsigned char* types, int32_t* bucket) {
+    const int32_t* wideText = (const int32_t*)text;
+    const unsigned char* byteText = (const unsigned char*)text;
+    saisBuckets(text, wide, n, alphabet, bucket, 0);
+    // 가상의 끝 문자가 맨 앞 접미사이므로 그 바로 앞 위치(L형)가 가장 먼저 놓인다
+    sa[bucket[SAIS_CHAR(text, wide, n - 1)]++] = n - 1;
+    for (int32_t i = 0; i < n; i++) {
+        int32_t j = sa[i] - 1;
+        if (sa[i] <= 0 || SAIS_IS_S(types, j)) continue;
+        if (wide) sa[bucket[wideText[j]]++] = j;
+        else sa[bucket[byteText[j]]++] = j;
+    }
+    saisBuckets(text, wide, n, alphabet, bucket, 1);
+    for (int32_t i = n - 1; i >= 0; i--) {
+        int32_t j = sa[i] - 1;
+        if (sa[i] <= 0 || !SAIS_IS_S(types, j)) continue;
+        if (wide) sa[--bucket[wideText[j]]] = j;
+        else sa[--bucket[byteText[j]]] = j;
+    }
+}
+
+// 정렬된 LMS 부분 문자열에 이름을 붙여 축약 문자열을 sa 끝 m칸에 만들고 이름 수를 돌려준다
+int32_t saisNameSubstrings(const void* text, int wide, int32_t* sa, int32_t n, int32_t m, const unsigned char* types) {
+    for (int32_t i = m; i < n; i++) sa[i] = -1;
+    int32_t names = 0;
+    int32_t prev = -1;
+    for (int32_t i = 0; i < m; i++) {
+        int32_t pos = sa[i];
+        int diff = 0;
+        for (int32_t d = 0;; d++) {
+            if (prev < 0 || pos + d == n || prev + d == n || SAIS_CHAR(text, wide, pos + d) != SAIS_CHAR(text, wide, prev + d) ||
+                SAIS_IS_S(types, pos + d) != SAIS_IS_S(types, prev + d)) {
+                diff = 1;
+                break;
+            }
+            if (d > 0 && (SAIS_IS_LMS(types, pos + d) || SAIS_IS_LMS(types, prev + d))) break;
+        }
+        if (diff) {
+            names++;
+            prev = pos;
+        }
+        // LMS 위치는 둘 이상 떨어져 있으므로 pos / 2 칸이 겹치지 않는다
+        sa[m + (pos >> 1)] = names - 1;
+    }
+    for (int32_t i = n - 1, j = n - 1; i >= m; i--) {
+        if (sa[i] >= 0) sa[j--] = sa[i];
+    }
+    return names;
+}
+
+// text[0..n)의 접미사 배열을 sa에 만든다 (Nong, Zhang, Chan의 SA-IS). 끝에 어떤 문자보다 작은
+// 가상의 문자가 있는 것으로 본다. wide가 0이면 바이트, 아니면 int32_t 문자열이고 문자는 alphabet 미만이다.
+// 버킷 배열은 재귀 전에 놓아 주므로 한 번에 하나만 살아 있다. 메모리가 부족하면 0을 돌려준다.
+int saisSort(const void* text, int wide, int32_t* sa, int32_t n, int32_t alphabet) {
+    if (n <= 1) {
+        if (n == 1) sa[0] = 0;
+        return 1;
+    }
+    unsigned char* types = (unsigned char*)calloc((size_t)n / 8 + 1, 1);
+    int32_t* bucket = (int32_t*)malloc((size_t)alphabet * sizeof(int32_t));
+    if (!types || !bucket) {
+        free(types);
+        free(bucket);
+        return 0;
+    }
+    types[n >> 3] |= (unsigned char)(1u << (n & 7));
+    int nextIsS = 0; // 위치 n - 1은 가상의 끝 문자보다 크므로 L형
+    for (int32_t i = n - 2; i >= 0; i--) {
+        int32_t c = SAIS_CHAR(text, wide, i);
+        int32_t next = SAIS_CHAR(text, wide, i + 1);
+        nextIsS = c < next || (c == next && nextIsS);
+        if (nextIsS) types[i >> 3] |= (unsigned char)(1u << (i & 7));
+    }
+
+    // 1. LMS 위치를 버킷 끝에 놓고 유도하면 LMS 부분 문자열끼리는 바르게 정렬된다
+    for (int32_t i = 0; i < n; i++) sa[i] = -1;
+    saisBuckets(text, wide, n, alphabet, bucket, 1);
+    for (int32_t i = 1; i < n; i++) {
+        if (SAIS_IS_LMS(types, i)) sa[--bucket[SAIS_CHAR(text, wide, i)]] = i;
+    }
+    saisInduce(text, wide, sa, n, alphabet, types, bucket);
+    int32_t m = 0;
+    for (int32_t i = 0; i < n; i++) {
+        if (SAIS_IS_LMS(types, sa[i])) sa[m++] = sa[i];
+    }
+
+    // 2. 이름이 모두 다르면 축약 문자열의 접미사 배열을 바로 얻고, 아니면 재귀로 정렬한다
+    int32_t names = saisNameSubstrings(text, wide, sa, n, m, types);
+    int32_t* reduced = &sa[n - m];
+    if (names < m) {
+        free(bucket);
+        if (!saisSort(reduced, 1, sa, m, names)) {
+            free(types);
+            return 0;
+        }
+        bucket = (int32_t*)malloc((size_t)alphabet * sizeof(int32_t));
+        if (!bucket) {
+            free(types);
+            return 0;
+        }
+    } else {
+        for (int32_t i = 0; i < m; i++) sa[reduced[i]] = i;
+    }
+
+    // 3. 정렬된 LMS 위치를 버킷 끝에 차례로 놓고 다시 유도한다
+    for (int32_t i = 1, j = 0; i < n; i++) {
+        if (SAIS_IS_LMS(types, i)) reduced[j++] = i;
+    }
+    for (int32_t i = 0; i < m; i++) sa[i] = reduced[sa[i]];
+    for (int32_t i = m; i < n; i++) sa[i] = -1;
+    saisBuckets(text, wide, n, alphabet, bucket, 1);
+    for (int32_t i = m - 1; i >= 0; i--) {
+        int32_t j = sa[i];
+        sa[i] = -1;
+        sa[--bucket[SAIS_CHAR(text, wide, j)]] = j;
+    }
+    saisInduce(text, wide, sa, n, alphabet, types, bucket);
+    free(types);
+    free(bucket);
+    return 1;
+}
+
+// 접미사 배열로 BWT를 구한다. 가상의 끝 문자는 빼고 size 바이트를 쓰며,
+// 그 문자가 있던 행 번호(1 ~ size)를 돌려준다.
+uint32_t bwtFromSuffixArray(const unsigned char* data, size_t size, const int32_t* sa, unsigned char* bwt) {
+    uint32_t primary = 0;
+    size_t k = 0;
+    bwt[k++] = data[size - 1]; // 0행: 끝 문자로 시작하는 회전
+    for (size_t i = 0; i < size; i++) {
+        if (sa[i] == 0) {
+            primary = (uint32_t)i + 1;
+            continue;
+        }
+        bwt[k++] = data[sa[i] - 1];
+    }
+    return primary;
+}
+
+// 0의 연속 run을 자릿값 1(RUNA), 2(RUNB)인 전단사 2진수로 낮은 자리부터 쓴다
+size_t writeZeroRun(size_t run, uint16_t* symbols) {
+    size_t count = 0;
+    while (run > 0) {
+        if (run & 1) {
+            symbols[count++] = ADV_BWT_RUNA;
+            run = (run - 1) / 2;
+        } else {
+            symbols[count++] = ADV_BWT_RUNB;
+            run = (run - 2) / 2;
+        }
+    }
+    return count;
+}
+
+// BWT 결과를 MTF와 0 연속 부호로 심볼열로 바꾸고 심볼 수를 돌려준다. freq에 심볼 빈도를 센다.
+size_t mtfEncode(const unsigned char* bwt, size_t size, uint16_t* symbols, unsigned freq[]) {
+    unsigned char order[256];
+    for (int i = 0; i < 256; i++) order[i] = (unsigned char)i;
+    size_t count = 0;
+    size_t run = 0;
+    for (size_t i = 0; i < size; i++) {
+        unsigned char c = bwt[i];
+        if (c == order[0]) {
+            run++;
+            continue;
+        }
+        count += writeZeroRun(run, &symbols[count]);
+        run = 0;
+        int rank = 1;
+        while (order[rank] != c) rank++;
+        memmove(&order[1], order, (size_t)rank);
+        order[0] = c;
+        symbols[count++] = (uint16_t)(rank + 1);
+    }
+    count += writeZeroRun(run, &symbols[count]);
+    memset(freq, 0, ADV_BWT_SYMBOLS * sizeof(unsigned));
+    for (size_t i = 0; i < count; i++) freq[symbols[i]]++;
+    return count;
+}
+
+// 심볼 ADV_BWT_GROUP개 묶음마다 코드표 여러 개 중 하나를 골라 쓴다 (bzip2와 같은 방식).
+// 묶음의 코드표 번호(선택자)는 MTF한 뒤 순위를 1의 개수로 적는다.
+struct BwtTables {
+    int tableCount;
+    unsigned char lengths[ADV_BWT_TABLES][ADV_BWT_SYMBOLS];
+    unsigned char* selectors;
+    size_t groupCount;
+};
+
+#define BWT_ITERATIONS 4
+#define BWT_MISSING_COST (ADV_BWT_GROUP * 16) // 길이표에 없는 심볼: 다른 어떤 코드표보다 비싸게 해 고르지 않는다 (묶음 합도 16비트 안)
+
+size_t advBlockSortMemory(int decompress) {
+    size_t n = ADV_BLOCK_SIZE;
+    // 해제: BWT 결과, 행마다 다음 행 번호, 선택자, 디코딩 테이블
+    if (decompress) return n + (n + 1) * sizeof(uint32_t) + n / ADV_BWT_GROUP + 1 + ADV_BWT_TABLES * sizeof(struct HuffDecoder);
+    // 압축: 접미사 배열(나중에 심볼열로 재사용), BWT 결과, 단계마다의 형 비트(축약 문자열은 많아야
+    // 절반이라 합이 n / 4를 넘지 않는다), 한 번에 하나만 있는 버킷 배열(이름 수도 많아야 n / 2)
+    return n * sizeof(int32_t) + n + n / 4 + 64 + (n / 2) * sizeof(int32_t);
+}
+
+// 심볼 빈도를 누적해 알파벳을 코드표 수만큼의 구간으로 나누고, 구간 안의 심볼을 싸게 본 첫 길이표를 만든다
+void initBwtTables(const unsigned freq[], size_t count, struct BwtTables* t) {
+    size_t remaining = count;
+    int s = 0;
+    for (int k = 0; k < t->tableCount; k++) {
+        size_t target = remaining / (size_t)(t->tableCount - k);
+        size_t sum = 0;
+        int first = s;
+        while (s < ADV_BWT_SYMBOLS && (sum < target || s == first || k == t->tableCount - 1)) sum += freq[s++];
+        for (int x = 0; x < ADV_BWT_SYMBOLS; x++) t->lengths[k][x] = x >= first && x < s ? 1 : 15;
+        remaining -= sum;
+    }
+}
+
+// 묶음마다 비트 수가 가장 적은 코드표를 고르고 코드표별 심볼 빈도를 센다. 심볼 비트 수를 돌려준다.
+// 심볼마다 코드표 세 개씩의 길이를 16비트 칸에 모아 두고 더하므로 묶음 하나에 덧셈은 심볼당 두 번이다.
+uint64_t assignBwtGroups(const uint16_t* symbols, size_t count, struct BwtTables* t, unsigned freq[][ADV_BWT_SYMBOLS]) {
+    uint64_t packed[2][ADV_BWT_SYMBOLS];
+    for (int s = 0; s < ADV_BWT_SYMBOLS; s++) {
+        packed[0][s] = packed[1][s] = 0;
+        for (int k = 0; k < t->tableCount; k++) {
+            uint64_t length = t->lengths[k][s] ? t->lengths[k][s] : BWT_MISSING_COST;
+            packed[k / 3][s] |= length << (16 * (k % 3));
+        }
+    }
+    memset(freq, 0, (size_t)t->tableCount * sizeof(freq[0]));
+    uint64_t total = 0;
+    for (size_t g = 0; g < t->groupCount; g++) {
+        size_t begin = g * ADV_BWT_GROUP;
+        size_t end = count - begin < ADV_BWT_GROUP ? count : begin + ADV_BWT_GROUP;
+        uint64_t sum0 = 0, sum1 = 0;
+        for (size_t i = begin; i < end; i++) {
+            sum0 += packed[0][symbols[i]];
+            sum1 += packed[1][symbols[i]];
+        }
+        int best = 0;
+        unsigned bestCost = UINT32_MAX;
+        for (int k = 0; k < t->tableCount; k++) {
+            unsigned cost = (unsigned)((k < 3 ? sum0 : sum1) >> (16 * (k % 3))) & 0xFFFF;
+            if (cost < bestCost) {
+                bestCost = cost;
+                best = k;
+            }
+        }
+        t->selectors[g] = (unsigned char)best;
+        total += bestCost;
+        for (size_t i = begin; i < end; i++) freq[best][symbols[i]]++;
+    }
+    return total;
+}
+
+// 묶음을 코드표에 나누고 길이표를 다시 만들기를 되풀이한다. 쓰이지 않은 코드표는 지운다.
+// 심볼 비트 수를 돌려준다.
+uint64_t chooseBwtTables(const uint16_t* symbols, size_t count, const unsigned freq[], int maxLength, struct BwtTables* t) {
+    unsigned tableFreq[ADV_BWT_TABLES][ADV_BWT_SYMBOLS];
+    t->tableCount = count < 200 ? 2 : count < 600 ? 3 : count < 1200 ? 4 : count < 2400 ? 5 : ADV_BWT_TABLES;
+    initBwtTables(freq, count, t);
+    for (int iter = 0; iter < BWT_ITERATIONS; iter++) {
+        assignBwtGroups(symbols, count, t, tableFreq);
+        for (int k = 0; k < t->tableCount; k++) {
+            buildCodeLengths(tableFreq[k], ADV_BWT_SYMBOLS, t->lengths[k], maxLength);
+            // 심볼이 하나뿐이어도 1비트 코드를 준다
+            for (int s = 0; s < ADV_BWT_SYMBOLS; s++) {
+                if (tableFreq[k][s] && t->lengths[k][s] == 0) t->lengths[k][s] = 1;
+            }
+        }
+    }
+    // 마지막 길이표로 다시 고른다. 각 묶음은 직전에 고른 코드표에 모든 심볼이 있으므로 없는 심볼을 고르지 않는다.
+    uint64_t bits = assignBwtGroups(symbols, count, t, tableFreq);
+    int renumber[ADV_BWT_TABLES];
+    int used = 0;
+    for (int k = 0; k < t->tableCount; k++) {
+        int inUse = 0;
+        for (int s = 0; s < ADV_BWT_SYMBOLS && !inUse; s++) inUse = tableFreq[k][s] != 0;
+        renumber[k] = used;
+        if (!inUse) continue;
+        if (used != k) memcpy(t->lengths[used], t->lengths[k], ADV_BWT_SYMBOLS);
+        used++;
+    }
+    t->tableCount = used;
+    for (size_t g = 0; g < t->groupCount; g++) t->selectors[g] = (unsigned char)renumber[t->selectors[g]];
+    return bits;
+}
+
+// 선택자를 MTF해 순위로 바꾸고 (제자리) 그 비트 수를 돌려준다
+uint64_t mtfSelectors(unsigned char* selectors, size_t groupCount) {
+    unsigned char order[ADV_BWT_TABLES];
+    for (int k = 0; k < ADV_BWT_TABLES; k++) order[k] = (unsigned char)k;
+    uint64_t bits = 0;
+    for (size_t g = 0; g < groupCount; g++) {
+        unsigned char table = selectors[g];
+        int rank = 0;
+        while (order[rank] != table) rank++;
+        memmove(&order[1], order, (size_t)rank);
+        order[0] = table;
+        selectors[g] = (unsigned char)rank;
+        bits += (uint64_t)rank + 1;
+    }
+    return bits;
+}
+
+// 블록 정렬 프레임을 기록한다. 프레임이 limit 바이트 이상이 될 것 같으면 (다른 부호화보다
+// 작지 않으면) 아무것도 쓰지 않고 0을 돌려준다. 메모리가 부족해도 0이다.
+size_t compressBwtBlock(const unsigned char* data, size_t size, unsigned char* out, const struct AdvOptions* options, size_t limit) {
+    if (size < ADV_BWT_MIN_SIZE) return 0;
+    int32_t* sa = (int32_t*)malloc(size * sizeof(int32_t));
+    unsigned char* bwt = (unsigned char*)malloc(size);
+    if (!sa || !bwt || !saisSort(data, 0, sa, (int32_t)size, 256)) {
+        free(sa);
+        free(bwt);
+        return 0;
+    }
+    uint32_t primary = bwtFromSuffixArray(data, size, sa, bwt);
+
+    // 심볼열은 블록 바이트 수를 넘지 않으므로 다 쓴 접미사 배열 자리에 둔다
+    uint16_t* symbols = (uint16_t*)sa;
+    unsigned freq[ADV_BWT_SYMBOLS];
+    size_t symbolCount = mtfEncode(bwt, size, symbols, freq);
+
+    // 선택자와 그 MTF 순위도 다 쓴 BWT 결과 자리에 둔다 (묶음 수는 블록 바이트 수의 1/50 정도)
+    struct BwtTables tables;
+    tables.groupCount = (symbolCount + ADV_BWT_GROUP - 1) / ADV_BWT_GROUP;
+    tables.selectors = bwt;
+    uint64_t bits = chooseBwtTables(symbols, symbolCount, freq, options->maxCodeLength, &tables);
+    unsigned char* selectors = tables.selectors;
+    unsigned char* ranks = &bwt[tables.groupCount];
+    memcpy(ranks, selectors, tables.groupCount);
+    bits += mtfSelectors(ranks, tables.groupCount);
+
+    unsigned char packed[ADV_BWT_TABLES][ADV_PACKED_LENGTHS_MAX(ADV_BWT_SYMBOLS)];
+    size_t packedSize[ADV_BWT_TABLES];
+    size_t tableSize = 1;
+    for (int k = 0; k < tables.tableCount; k++) {
+        packedSize[k] = writePackedLengths(tables.lengths[k], ADV_BWT_SYMBOLS, packed[k]);
+        tableSize += packedSize[k];
+    }
+    size_t frameSize = ADV_BLOCK_HEADER_SIZE + 8 + tableSize + (size_t)((bits + 7) / 8);
+    if (frameSize >= limit) {
+        free(bwt);
+        free(sa);
+        return 0;
+    }
+
+    out[0] = ADV_BLOCK_BWT;
+    putLE32(&out[1], (uint32_t)size);
+    size_t idx = ADV_BLOCK_HEADER_SIZE;
+    putLE32(&out[idx], primary);
+    putLE32(&out[idx + 4], (uint32_t)symbolCount);
+    idx += 8;
+    out[idx++] = (unsigned char)tables.tableCount;
+    uint64_t codes[ADV_BWT_TABLES][ADV_BWT_SYMBOLS];
+    for (int k = 0; k < tables.tableCount; k++) {
+        memcpy(&out[idx], packed[k], packedSize[k]);
+        idx += packedSize[k];
+        assignCanonicalCodes(tables.lengths[k], ADV_BWT_SYMBOLS, codes[k]);
+    }
+    struct BitWriter writer = { out, idx, 0, 0 };
+    // 선택자 순위 r은 1을 r개 쓰고 0으로 끝낸다
+    for (size_t g = 0; g < tables.groupCount; g++) putBits(&writer, (2u << ranks[g]) - 2, ranks[g] + 1);
+    for (size_t i = 0; i < symbolCount; i++) {
+        int k = selectors[i / ADV_BWT_GROUP];
+        putBits(&writer, (uint32_t)codes[k][symbols[i]], tables.lengths[k][symbols[i]]);
+    }
+    flushBits(&writer);
+    free(bwt);
+    free(sa);
+
+    putLE32(&out[5], (uint32_t)(writer.pos - ADV_BLOCK_HEADER_SIZE));
+    return writer.pos;
+}
+
+// 선택자 순위를 읽어 MTF를 되돌린다 (순위가 코드표 수 이상이면 0)
+int readSelectors(struct BitReader* reader, size_t groupCount, int tableCount, unsigned char* selectors) {
+    unsigned char order[ADV_BWT_TABLES];
+    for (int k = 0; k < ADV_BWT_TABLES; k++) order[k] = (unsigned char)k;
+    for (size_t g = 0; g < groupCount; g++) {
+        int rank = 0;
+        while (getBits(reader, 1)) {
+            if (++rank >= tableCount) return 0;
+        }
+        unsigned char table = order[rank];
+        memmove(&order[1], order, (size_t)rank);
+        order[0] = table;
+        selectors[g] = table;
+    }
+    return !bitReaderOverrun(reader);
+}
+
+// 심볼열을 풀어 MTF와 0 연속 부호를 되돌린 BWT 결과를 bwt에 정확히 rawSize 바이트로 쓴다
+int mtfDecode(struct BitReader* reader, size_t symbolCount, const struct HuffDecoder* decoders, const unsigned char* selectors,
+              unsigned char* bwt, size_t rawSize) {
+    unsigned char order[256];
+    for (int i = 0; i < 256; i++) order[i] = (unsigned char)i;
+    size_t pos = 0;
+    size_t run = 0;
+    size_t weight = 1;
+    for (size_t i = 0; i < symbolCount; i++) {
+        const struct HuffDecoder* decoder = &decoders[selectors[i / ADV_BWT_GROUP]];
+        int symbol = decodeSymbol(reader, decoder->table, &decoder->longCodes);
+        if (symbol < 0) return ADV_ERR_FORMAT;
+        if (symbol <= ADV_BWT_RUNB) {
+            if (weight > rawSize) return ADV_ERR_FORMAT;
+            run += (size_t)(symbol + 1) * weight;
+            weight <<= 1;
+            if (run > rawSize - pos) return ADV_ERR_FORMAT;
+            continue;
+        }
+        memset(&bwt[pos], order[0], run);
+        pos += run;
+        run = 0;
+        weight = 1;
+        if (pos >= rawSize) return ADV_ERR_FORMAT;
+        int rank = symbol - 1;
+        unsigned char c = order[rank];
+        memmove(&order[1], order, (size_t)rank);
+        order[0] = c;
+        bwt[pos++] = c;
+    }
+    memset(&bwt[pos], order[0], run);
+    pos += run;
+    return pos == rawSize ? ADV_OK : ADV_ERR_FORMAT;
+}
+
+// BWT를 되돌린다. 행 r의 항목은 (다음 바이트가 있는 행 << 8) | 행 r의 첫 바이트이며,
+// 끝 문자의 행(0)에서 시작해 따라가면 원본이 앞에서부터 나온다.
+void inverseBwt(const unsigned char* bwt, size_t size, uint32_t primary, uint32_t* next, unsigned char* out) {
+    size_t start[256];
+    size_t count[256] = {0};
+    for (size_t i = 0; i < size; i++) count[bwt[i]]++;
+    size_t sum = 1; // 0행은 끝 문자로 시작한다
+    next[0] = 0; // 올바른 블록이면 마지막 바이트 뒤에만 닿는다
+    for (int c = 0; c < 256; c++) {
+        start[c] = sum;
+        sum += count[c];
+    }
+    for (size_t i = 0; i < size; i++) {
+        // 저장된 i번째 바이트는 끝 문자가 빠진 자리 뒤부터 한 행씩 밀린다
+        size_t row = i < primary ? i : i + 1;
+        next[start[bwt[i]]++] = (uint32_t)row << 8 | bwt[i];
+    }
+    uint32_t row = primary;
+    for (size_t i = 0; i < size; i++) {
+        uint32_t entry = next[row];
+        out[i] = (unsigned char)entry;
+        row = entry >> 8;
+    }
+}
+
+// 코드표들과 선택자를 읽고 심볼열을 풀어 bwt에 BWT 결과를 쓴다
+int decodeBwtSymbols(const unsigned char* in, size_t avail, size_t symbolCount, struct HuffDecoder* decoders, unsigned char* selectors,
+                     unsigned char* bwt, size_t rawSize) {
+    if (avail < 1) return ADV_ERR_FORMAT;
+    int tableCount = in[0];
+    if (tableCount < 1 || tableCount > ADV_BWT_TABLES) return ADV_ERR_FORMAT;
+    size_t idx = 1;
+    for (int k = 0; k < tableCount; k++) {
+        unsigned char lengths[ADV_BWT_SYMBOLS];
+        uint64_t codes[ADV_BWT_SYMBOLS];
+        size_t tableSize = readPackedLengths(&in[idx], avail - idx, lengths, ADV_BWT_SYMBOLS);
+        if (tableSize == 0 || !validateCodeLengths(lengths, ADV_BWT_SYMBOLS)) return ADV_ERR_FORMAT;
+        assignCanonicalCodes(lengths, ADV_BWT_SYMBOLS, codes);
+        buildDecodeTable(codes, lengths, ADV_BWT_SYMBOLS, decoders[k].table, &decoders[k].longCodes);
+        idx += tableSize;
+    }
+    struct BitReader reader = { &in[idx], avail - idx, 0, 0, 0 };
+    size_t groupCount = (symbolCount + ADV_BWT_GROUP - 1) / ADV_BWT_GROUP;
+    if (!readSelectors(&reader, groupCount, tableCount, selectors)) return ADV_ERR_FORMAT;
+    int result = mtfDecode(&reader, symbolCount, decoders, selectors, bwt, rawSize);
+    if (result == ADV_OK && bitReaderOverrun(&reader)) result = ADV_ERR_FORMAT;
+    return result;
+}
+
+// 블록 정렬 블록 페이로드를 정확히 rawSize 바이트로 복원한다
+int decompressBwtBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize) {
+    if (payloadSize < 8 || rawSize == 0 || rawSize >= ADV_BWT_MAX_SIZE) return ADV_ERR_FORMAT;
+    uint32_t primary = getLE32(payload);
+    size_t symbolCount = getLE32(&payload[4]);
+    if (primary == 0 || primary > rawSize || symbolCount > rawSize) return ADV_ERR_FORMAT;
+
+    struct HuffDecoder* decoders = (struct HuffDecoder*)malloc(ADV_BWT_TABLES * sizeof(struct HuffDecoder));
+    unsigned char* selectors = (unsigned char*)malloc(symbolCount / ADV_BWT_GROUP + 1);
+    unsigned char* bwt = (unsigned char*)malloc(rawSize);
+    uint32_t* next = (uint32_t*)malloc((rawSize + 1) * sizeof(uint32_t));
+    int result = decoders && selectors && bwt && next ? ADV_OK : ADV_ERR_NOMEM;
+    if (result == ADV_OK) result = decodeBwtSymbols(&payload[8], payloadSize - 8, symbolCount, decoders, selectors, bwt, rawSize);
+    if (result == ADV_OK) inverseBwt(bwt, rawSize, primary, next, out);
+    free(decoders);
+    free(selectors);
+    free(bwt);
+    free(next);
+    return result;
+}
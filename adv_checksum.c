@@ -0,0 +1,158 @@
+#include <string.h>
+#include <pthread.h>
+#include "adv_internal.h"
+
+// x86 GCC/Clang 빌드에서는 SSE4.2 crc32 명령 구현을 함께 컴파일하고 실행 시 CPU를 확인해 쓴다
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <nmmintrin.h>
+#define ADV_HAVE_SSE42_CRC 1
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define ADV_HAVE_ARM_CRC 1
+#endif
+
+// CRC32C (Castagnoli, 반사 다항식 0x82F63B78)
+// CPU의 CRC32C 명령을 쓸 수 있으면 그것으로, 아니면 8바이트씩 처리하는 slicing-by-8 표로 계산한다.
+// 구현 선택과 표 생성은 처음 쓸 때 한 번만 한다.
+
+#define CRC32C_POLY 0x82F63B78u
+
+uint32_t crc32cTable[8][256];
+uint32_t crc32cPowers[32]; // x^(2^n) mod P (블록 CRC를 이어 붙일 때 쓴다)
+uint32_t (*crc32cImpl)(uint32_t crc, const unsigned char* data, size_t size);
+pthread_once_t crc32cTableOnce = PTHREAD_ONCE_INIT;
+
+uint32_t crc32cSoftware(uint32_t crc, const unsigned char* data, size_t size) {
+    crc = ~crc;
+    while (size >= 8) {
+        uint32_t lo = ((uint32_t)data[0] | (uint32_t)data[1] << 8 | (uint32_t)data[2] << 16 | (uint32_t)data[3] << 24) ^ crc;
+        crc = crc32cTable[7][lo & 0xFF] ^ crc32cTable[6][(lo >> 8) & 0xFF] ^
+              crc32cTable[5][(lo >> 16) & 0xFF] ^ crc32cTable[4][lo >> 24] ^
+              crc32cTable[3][data[4]] ^ crc32cTable[2][data[5]] ^
+              crc32cTable[1][data[6]] ^ crc32cTable[0][data[7]];
+        data += 8;
+        size -= 8;
+    }
+    while (size--) {
+        crc = (crc >> 8) ^ crc32cTable[0][(crc ^ *data++) & 0xFF];
+    }
+    return ~crc;
+}
+
+// a * b mod P (반사 비트 순서: 최상위 비트가 x^0)
+uint32_t crc32cMultiply(uint32_t a, uint32_t b) {
+    uint32_t product = 0;
+    for (uint32_t m = 1u << 31; m != 0; m >>= 1) {
+        if (a & m) product ^= b;
+        b = b & 1 ? (b >> 1) ^ CRC32C_POLY : b >> 1;
+    }
+    return product;
+}
+
+// x^(8 * size) mod P: CRC 뒤에 size 바이트가 이어질 때 곱해지는 값 (crc32cPowers가 채워진 뒤에 쓴다)
+uint32_t crc32cShift(uint64_t size) {
+    uint32_t shift = 1u << 31; // x^0
+    for (int n = 3; size != 0; size >>= 1, n++) {
+        if (size & 1) shift = crc32cMultiply(crc32cPowers[n & 31], shift);
+    }
+    return shift;
+}
+
+#ifdef ADV_HAVE_SSE42_CRC
+// 이보다 긴 구간은 세 갈래로 나눠 동시에 계산한다
+#define CRC32C_INTERLEAVE_MIN 4096
+
+__attribute__((target("sse4.2")))
+uint32_t crc32cSse42(uint32_t crc, const unsigned char* data, size_t size) {
+#ifdef __x86_64__
+    // crc32 명령은 지연 시간이 3사이클이라 한 갈래로는 처리량의 1/3만 쓴다.
+    // 서로 독립인 세 갈래를 번갈아 계산하고 끝에서 갈래 길이만큼의 이동값을 곱해 이어 붙인다.
+    if (size >= CRC32C_INTERLEAVE_MIN) {
+        size_t lane = size / 3 & ~(size_t)7;
+        uint64_t a = ~crc, b = 0xFFFFFFFFu, c = 0xFFFFFFFFu;
+        for (size_t i = 0; i < lane; i += 8) {
+            uint64_t wa, wb, wc;
+            memcpy(&wa, data + i, 8);
+            memcpy(&wb, data + lane + i, 8);
+            memcpy(&wc, data + 2 * lane + i, 8);
+            a = _mm_crc32_u64(a, wa);
+            b = _mm_crc32_u64(b, wb);
+            c = _mm_crc32_u64(c, wc);
+        }
+        uint32_t shift = crc32cShift(lane);
+        crc = crc32cMultiply(shift, crc32cMultiply(shift, ~(uint32_t)a) ^ ~(uint32_t)b) ^ ~(uint32_t)c;
+        data += 3 * lane;
+        size -= 3 * lane;
+    }
+#endif
+    crc = ~crc;
+#ifdef __x86_64__
+    uint64_t crc64 = crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc64 = _mm_crc32_u64(crc64, word);
+    }
+    crc = (uint32_t)crc64;
+#endif
+    for (; size >= 4; data += 4, size -= 4) {
+        uint32_t word;
+        memcpy(&word, data, 4);
+        crc = _mm_crc32_u32(crc, word);
+    }
+    while (size--) crc = _mm_crc32_u8(crc, *data++);
+    return ~crc;
+}
+#endif
+
+#ifdef ADV_HAVE_ARM_CRC
+uint32_t crc32cArm(uint32_t crc, const unsigned char* data, size_t size) {
+    crc = ~crc;
+    for (; size >= 8; data += 8, size -= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        crc = __crc32cd(crc, word);
+    }
+    while (size--) crc = __crc32cb(crc, *data++);
+    return ~crc;
+}
+#endif
+
+void initCrc32c(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (CRC32C_POLY & (0u - (crc & 1)));
+        }
+        crc32cTable[0][i] = crc;
+    }
+    // 표 k는 바이트 뒤에 0 바이트가 k개 더 이어질 때의 CRC
+    for (uint32_t i = 0; i < 256; i++) {
+        for (int k = 1; k < 8; k++) {
+            uint32_t prev = crc32cTable[k - 1][i];
+            crc32cTable[k][i] = (prev >> 8) ^ crc32cTable[0][prev & 0xFF];
+        }
+    }
+    crc32cPowers[0] = 1u << 30; // x^1
+    for (int n = 1; n < 32; n++) crc32cPowers[n] = crc32cMultiply(crc32cPowers[n - 1], crc32cPowers[n - 1]);
+
+    crc32cImpl = crc32cSoftware;
+#ifdef ADV_HAVE_SSE42_CRC
+    if (__builtin_cpu_supports("sse4.2")) crc32cImpl = crc32cSse42;
+#endif
+#ifdef ADV_HAVE_ARM_CRC
+    crc32cImpl = crc32cArm;
+#endif
+}
+
+uint32_t crc32cUpdate(uint32_t crc, const unsigned char* data, size_t size) {
+    pthread_once(&crc32cTableOnce, initCrc32c);
+    return crc32cImpl(crc, data, size);
+}
+
+// 앞 데이터의 CRC와 뒤 데이터(secondSize 바이트)의 CRC로 이어 붙인 데이터의 CRC를 구한다.
+// 앞 CRC에 x^(8 * secondSize)를 곱하는 것과 같으며 데이터는 다시 읽지 않는다.
+uint32_t crc32cCombine(uint32_t first, uint32_t second, uint64_t secondSize) {
+    pthread_once(&crc32cTableOnce, initCrc32c);
+    return crc32cMultiply(crc32cShift(secondSize), first) ^ second;
+}
@@ -0,0 +1,929 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include "adv_codec.h"
+
+#include <dirent.h>
+
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#include <direct.h>
+#define isatty _isatty
+#define makeDirectory(path) _mkdir(path)
+#else
+#include <glob.h>
+#include <unistd.h>
+#define makeDirectory(path) mkdir(path, 0777)
+#endif
+
+#define ADV_SUFFIX ".adv"
+#define CLI_PROGRESS_INTERVAL 0.5 // 표준 오류와 통계 파일로 보고하는 간격 (초)
+#define CLI_READ_CHUNK 65536 // 사전 표본을 읽어 들이는 단위
+#define CLI_RANGE_CHUNK 1048576 // -r 구간을 읽어 쓰는 단위
+
+// 아카이브 명령 (-a, -l, -x)
+enum {
+    ARCHIVE_NONE = 0,
+    ARCHIVE_CREATE,
+    ARCHIVE_LIST,
+    ARCHIVE_EXTRACT
+};
+
+// 명령행 옵션
+struct CliOptions {
+    int decompress;
+    int test; // -t: 풀어서 체크섬만 검사하고 기록하지 않는다
+    int archive;
+    int toStdout;
+    int force;
+    int quiet;
+    int showProgress;
+    const char *outputName;
+    const char *trainPath; // -T: 입력 파일들을 표본으로 사전을 학습해 저장할 경로
+    int range; // -r: 원본의 구간만 풀어 표준 출력으로 쓴다
+    unsigned long long rangeOffset;
+    unsigned long long rangeLength;
+    FILE *stats;
+    struct AdvOptions codec;
+};
+
+// SIGINT/SIGTERM을 받으면 코덱이 다음 배치 전에 멈추고(ADV_ERR_CANCELLED) 불완전한 출력 파일을 지운다.
+// 처리기는 한 번만 받고 기본 처리로 돌려 두므로 한 번 더 보내면 바로 끝난다.
+volatile int cliCancelled = 0;
+
+void handleInterrupt(int sig) {
+    cliCancelled = 1;
+    signal(sig, SIG_DFL);
+}
+
+// 진행 보고 대상: 파일 하나를 처리하는 동안 진행 콜백에 넘긴다
+struct CliProgress {
+    const char *name;
+    const char *mode;
+    const struct CliOptions *opts;
+    int interactive; // 표준 오류가 터미널이면 한 줄을 제자리에서 갱신한다
+};
+
+void printUsage(const char *prog) {
+    fprintf(stderr,
+            "사용법: %s [-z|-d|-t] [-0..-9] [-B] [-c] [-f] [-q] [-p] [-L 비트] [-S 통계파일] [-o 출력파일] [파일...]\n"
+            "       %s [옵션] -a 아카이브 파일|디렉터리...\n"
+            "       %s -l 아카이브\n"
+            "       %s [-c] [-f] -x 아카이브 [항목...]\n"
+            "       %s -r 시작[:길이] 압축파일... | -r 시작[:길이] -x 아카이브 항목...\n"
+            "       %s -T 사전파일 [-L 비트] [-f] 표본파일...\n"
+            "  -z  압축 (기본값)\n"
+            "  -d  압축 해제\n"
+            "  -t  압축 파일(아카이브는 모든 항목)을 풀어 체크섬만 검사 (출력 파일을 만들지 않음)\n"
+            "  -a  파일과 디렉터리(하위 포함)를 아카이브 하나로 묶기\n"
+            "  -l  아카이브 항목 목록 (블록을 풀지 않음)\n"
+            "  -x  아카이브 항목을 현재 디렉터리에 풀기 (항목을 지정하지 않으면 전체)\n"
+            "  -r  원본의 시작 위치부터 길이만큼(생략하면 끝까지) 그 구간이 걸친 블록만 풀어 표준 출력으로 쓰기\n"
+            "  -0..-9  압축 강도 (0은 일치 탐색 없이 엔트로피 부호화만, 기본값 %d)\n"
+            "  -B  블록 정렬(BWT) 부호화도 시도 (느리지만 가장 작다, 보관용)\n"
+            "  -c  결과를 표준 출력으로 쓰기\n"
+            "  -f  기존 출력 파일 덮어쓰기\n"
+            "  -q  요약 출력 생략\n"
+            "  -p  진행률과 처리 속도를 표준 오류에 표시\n"
+            "  -L  하프만 코드 길이 상한 (%d~%d, 기본값 %d)\n"
+            "  -S  진행 상황과 단계별 시간을 파일에 JSON 한 줄씩 덧붙여 기록\n"
+            "  -o  출력 파일 이름 지정 (입력 파일이 하나일 때만)\n"
+            "  -D  사전 파일을 읽어 압축에 쓰고 해제할 때 찾을 수 있게 등록 (여러 번 지정 가능)\n"
+            "  -T  표본 파일들의 바이트 분포로 사전을 학습해 저장\n"
+            "  파일을 지정하지 않거나 '-'를 주면 표준 입력을 읽어 표준 출력으로 쓴다.\n",
+            prog, prog, prog, prog, prog, prog, ADV_LEVEL_DEFAULT, ADV_CODE_LIMIT_MIN, ADV_CODE_LIMIT_MAX, ADV_CODE_LIMIT_DEFAULT);
+}
+
+int fileExists(const char *path) {
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+// 입력 파일 이름으로 출력 파일 이름을 만든다. 결과는 호출자가 free한다.
+char *makeOutputName(const char *input, int decompress) {
+    size_t len = strlen(input);
+    size_t suffixLen = strlen(ADV_SUFFIX);
+    if (!decompress) {
+        char *name = (char *)malloc(len + suffixLen + 1);
+        if (!name) return NULL;
+        memcpy(name, input, len);
+        memcpy(name + len, ADV_SUFFIX, suffixLen + 1);
+        return name;
+    }
+    if (len <= suffixLen || strcmp(input + len - suffixLen, ADV_SUFFIX) != 0) return NULL;
+    char *name = (char *)malloc(len - suffixLen + 1);
+    if (!name) return NULL;
+    memcpy(name, input, len - suffixLen);
+    name[len - suffixLen] = '\0';
+    return name;
+}
+
+// JSON 문자열로 쓸 수 있도록 따옴표와 제어 문자를 이스케이프한다
+void writeJsonString(FILE *out, const char *text) {
+    fputc('"', out);
+    for (const unsigned char *p = (const unsigned char *)text; *p; p++) {
+        if (*p == '"' || *p == '\\') fprintf(out, "\\%c", *p);
+        else if (*p < 0x20) fprintf(out, "\\u%04x", *p);
+        else fputc(*p, out);
+    }
+    fputc('"', out);
+}
+
+void reportProgress(const struct AdvProgress *progress, void *userData) {
+    struct CliProgress *cli = (struct CliProgress *)userData;
+    double speed = progress->elapsed > 0 ? progress->inputBytes / progress->elapsed / 1e6 : 0.0;
+    if (cli->opts->showProgress) {
+        char percent[16] = "";
+        if (progress->totalBytes > 0) {
+            snprintf(percent, sizeof(percent), " %5.1f%%", 100.0 * progress->inputBytes / progress->totalBytes);
+        }
+        fprintf(stderr, "%s%s:%s %lld 바이트, %.1f MB/s, %.1f초%s",
+                cli->interactive ? "\r" : "", cli->name, percent, progress->inputBytes, speed, progress->elapsed,
+                cli->interactive && !progress->finished ? "   " : "\n");
+    }
+    if (cli->opts->stats) {
+        FILE *out = cli->opts->stats;
+        fprintf(out, "{\"file\":");
+        writeJsonString(out, cli->name);
+        fprintf(out, ",\"mode\":\"%s\",\"total\":%lld,\"input\":%lld,\"output\":%lld,\"blocks\":%lld,"
+                     "\"seconds\":%.3f,\"read_s\":%.3f,\"codec_s\":%.3f,\"write_s\":%.3f,\"mb_s\":%.2f,\"final\":%d}\n",
+                cli->mode, progress->totalBytes, progress->inputBytes, progress->outputBytes, progress->blocks,
+                progress->elapsed, progress->stageTime[ADV_STAGE_READ], progress->stageTime[ADV_STAGE_CODEC],
+                progress->stageTime[ADV_STAGE_WRITE], speed, progress->finished);
+        fflush(out);
+    }
+}
+
+// -p나 -S가 있으면 코덱 설정에 진행 콜백을 건다
+void attachProgress(struct AdvOptions *codec, struct CliProgress *progress, const char *name, const char *mode,
+                    const struct CliOptions *opts) {
+    *codec = opts->codec;
+    progress->name = name;
+    progress->mode = mode;
+    progress->opts = opts;
+    progress->interactive = isatty(2);
+    if (opts->showProgress || opts->stats) {
+        codec->progress = reportProgress;
+        codec->progressData = progress;
+        codec->progressInterval = CLI_PROGRESS_INTERVAL;
+    }
+}
+
+int runCodec(FILE *source, FILE *dest, const char *name, const struct CliOptions *opts, long *processed) {
+    struct AdvOptions codec;
+    struct CliProgress progress;
+    attachProgress(&codec, &progress, name, opts->decompress ? "decompress" : "compress", opts);
+    int result = opts->decompress
+        ? decompressFile(source, dest, processed, &codec)
+        : compressFile(source, dest, processed, &codec);
+    if (fflush(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    return result;
+}
+
+// -t: 아카이브의 모든 항목을 풀어 항목별 CRC32C를 검사한다
+int testArchive(FILE *source, const char *name, const struct CliOptions *opts) {
+    struct AdvArchive archive;
+    int result = advArchiveOpen(source, &archive);
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", name, advErrorMessage(result));
+        return 1;
+    }
+    int failed = 0;
+    for (size_t i = 0; i < archive.count; i++) {
+        struct AdvOptions codec;
+        struct CliProgress progress;
+        attachProgress(&codec, &progress, archive.entries[i].name, "test", opts);
+        long processed = 0;
+        result = advArchiveExtract(source, &archive, i, NULL, &processed, &codec);
+        if (result != ADV_OK) {
+            fprintf(stderr, "%s: %s: %s\n", name, archive.entries[i].name, advErrorMessage(result));
+            failed = 1;
+        }
+    }
+    if (!failed && !opts->quiet) fprintf(stderr, "%s: 항목 %lu개 정상\n", name, (unsigned long)archive.count);
+    advArchiveFree(&archive);
+    return failed;
+}
+
+// -t: 압축 파일을 풀어 블록과 파일 전체의 체크섬을 검사한다. 복원한 데이터는 버린다.
+int testSource(FILE *source, const char *name, const struct CliOptions *opts) {
+    struct AdvOptions codec;
+    struct CliProgress progress;
+    attachProgress(&codec, &progress, name, "test", opts);
+    long processed = 0;
+    int result = decompressFile(source, NULL, &processed, &codec);
+    if (result == ADV_ERR_ARCHIVE && source != stdin) return testArchive(source, name, opts);
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", name, advErrorMessage(result));
+        return 1;
+    }
+    if (!opts->quiet) fprintf(stderr, "%s: 정상\n", name);
+    return 0;
+}
+
+// 표준 입력을 처리하여 표준 출력으로 쓴다
+int processStdio(const struct CliOptions *opts) {
+    if (opts->test) return testSource(stdin, "(표준 입력)", opts);
+    long processed = 0;
+    int result = runCodec(stdin, stdout, "(표준 입력)", opts, &processed);
+    if (result != ADV_OK) {
+        fprintf(stderr, "(표준 입력): %s\n", advErrorMessage(result));
+        return 1;
+    }
+    return 0;
+}
+
+// 파일 하나를 처리한다. 실패하면 1을 돌려준다.
+int processPath(const char *input, const struct CliOptions *opts) {
+    if (opts->test) {
+        FILE *source = fopen(input, "rb");
+        if (source == NULL) {
+            fprintf(stderr, "%s: 파일을 열 수 없습니다.\n", input);
+            return 1;
+        }
+        int failed = testSource(source, input, opts);
+        fclose(source);
+        return failed;
+    }
+
+    char *generated = NULL;
+    const char *output = opts->outputName;
+    if (!opts->toStdout && output == NULL) {
+        generated = makeOutputName(input, opts->decompress);
+        if (generated == NULL) {
+            fprintf(stderr, "%s: '%s' 확장자가 없어 출력 파일 이름을 정할 수 없습니다 (-o 또는 -c 사용)\n",
+                    input, ADV_SUFFIX);
+            return 1;
+        }
+        output = generated;
+    }
+
+    FILE *source = fopen(input, "rb");
+    if (source == NULL) {
+        fprintf(stderr, "%s: 파일을 열 수 없습니다.\n", input);
+        free(generated);
+        return 1;
+    }
+
+    FILE *dest = stdout;
+    if (!opts->toStdout) {
+        if (!opts->force && fileExists(output)) {
+            fprintf(stderr, "%s: 출력 파일이 이미 있습니다 (-f로 덮어쓰기)\n", output);
+            fclose(source);
+            free(generated);
+            return 1;
+        }
+        // 해제 결과를 출력 파일 매핑에 바로 쓸 수 있도록 읽기/쓰기로 연다
+        dest = fopen(output, "wb+");
+        if (dest == NULL) {
+            fprintf(stderr, "%s: 출력 파일을 열 수 없습니다.\n", output);
+            fclose(source);
+            free(generated);
+            return 1;
+        }
+    }
+
+    long processed = 0;
+    int result = runCodec(source, dest, input, opts, &processed);
+    fclose(source);
+    long outSize = 0;
+    if (!opts->toStdout) {
+        fseek(dest, 0, SEEK_END);
+        outSize = ftell(dest);
+        if (fclose(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    }
+
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", input, advErrorMessage(result));
+        // 불완전한 출력 파일은 남기지 않는다
+        if (!opts->toStdout) remove(output);
+        free(generated);
+        return 1;
+    }
+
+    if (!opts->quiet && !opts->toStdout) {
+        // 압축률은 항상 (압축된 크기 / 원본 크기)로 표시한다
+        long rawSize = opts->decompress ? outSize : processed;
+        long packedSize = opts->decompress ? processed : outSize;
+        double ratio = rawSize > 0 ? (double)packedSize / rawSize * 100.0 : 0.0;
+        fprintf(stderr, "%s -> %s: %ld -> %ld 바이트 (%.1f%%)\n",
+                input, output, processed, outSize, ratio);
+    }
+    free(generated);
+    return 0;
+}
+
+// 인자 하나를 처리한다. 와일드카드가 있으면 셸 대신 직접 펼친다.
+int processArgument(const char *arg, const struct CliOptions *opts) {
+    if (strcmp(arg, "-") == 0) return processStdio(opts);
+#ifndef _WIN32
+    if (strpbrk(arg, "*?[") != NULL) {
+        glob_t matches;
+        if (glob(arg, 0, NULL, &matches) == 0) {
+            int failed = 0;
+            for (size_t i = 0; i < matches.gl_pathc && !cliCancelled; i++) {
+                failed |= processPath(matches.gl_pathv[i], opts);
+            }
+            globfree(&matches);
+            return failed;
+        }
+    }
+#endif
+    return processPath(arg, opts);
+}
+
+// -r 값 "시작[:길이]"을 해석한다. 길이를 생략하면 원본 끝까지 읽는다.
+int parseRange(const char *text, struct CliOptions *opts) {
+    char *end;
+    opts->rangeOffset = strtoull(text, &end, 10);
+    opts->rangeLength = ULLONG_MAX;
+    if (end == text || *text == '-') return 0;
+    if (*end == ':') {
+        const char *length = end + 1;
+        opts->rangeLength = strtoull(length, &end, 10);
+        if (end == length || *length == '-') return 0;
+    }
+    opts->range = 1;
+    return *end == '\0';
+}
+
+// -r: 구간을 표준 출력으로 쓴다. reader가 구간이 걸친 블록만 풀고, 같은 블록은 캐시에서 다시 쓴다.
+int copyRange(struct AdvReader *reader, const char *name, const struct CliOptions *opts) {
+    unsigned char *buf = (unsigned char *)malloc(CLI_RANGE_CHUNK);
+    unsigned long long offset = opts->rangeOffset;
+    unsigned long long remaining = opts->rangeLength;
+    unsigned long long copied = 0;
+    int result = buf ? ADV_OK : ADV_ERR_NOMEM;
+    while (result == ADV_OK && remaining > 0) {
+        if (cliCancelled) {
+            result = ADV_ERR_CANCELLED;
+            break;
+        }
+        size_t want = remaining < CLI_RANGE_CHUNK ? (size_t)remaining : CLI_RANGE_CHUNK;
+        size_t got;
+        result = advReaderRead(reader, offset, buf, want, &got);
+        if (result != ADV_OK || got == 0) break;
+        if (fwrite(buf, 1, got, stdout) != got) result = ADV_ERR_WRITE;
+        offset += got;
+        remaining -= got;
+        copied += got;
+    }
+    free(buf);
+    if (fflush(stdout) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", name, advErrorMessage(result));
+        return 1;
+    }
+    if (!opts->quiet) {
+        struct AdvReaderStats stats;
+        advReaderGetStats(reader, &stats);
+        fprintf(stderr, "%s: %llu 바이트 중 %llu 바이트 (블록 %llu개 해제, 프레임 %llu 바이트 읽음)\n",
+                name, advReaderSize(reader), copied, stats.blocksDecoded, stats.bytesRead);
+    }
+    return 0;
+}
+
+// -r: 압축 파일 하나에서 구간을 읽는다
+int readRange(const char *input, const struct CliOptions *opts) {
+    FILE *source = fopen(input, "rb");
+    if (source == NULL) {
+        fprintf(stderr, "%s: 파일을 열 수 없습니다.\n", input);
+        return 1;
+    }
+    struct AdvReader *reader;
+    int result = advReaderOpen(source, ADV_READER_CACHE_DEFAULT, &reader);
+    int failed = 1;
+    if (result == ADV_ERR_ARCHIVE) {
+        fprintf(stderr, "%s: %s (-r 구간 -x %s 항목으로 읽으세요)\n", input, advErrorMessage(result), input);
+    } else if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", input, advErrorMessage(result));
+    } else {
+        failed = copyRange(reader, input, opts);
+        advReaderClose(reader);
+    }
+    fclose(source);
+    return failed;
+}
+
+// 경로를 아카이브 항목 이름으로 바꾼다: 구분자는 '/'로 바꾸고 드라이브 문자와 앞의 '/'는 뗀다.
+// 빈 구성 요소와 "."는 지우고 ".."는 앞 구성 요소와 함께 접는다 (맨 앞에서 위로 가는 ".."는 버린다).
+// "foo/../bar"도 "bar"로 저장되어 풀 때 거부되지 않는다.
+const char *archiveEntryName(char *path) {
+    for (char *p = path; *p; p++) {
+        if (*p == '\\') *p = '/';
+    }
+    char *name = path;
+    if (name[0] != '\0' && name[1] == ':') name += 2;
+    // 쓰는 위치는 읽는 위치를 앞지르지 않으므로 제자리에서 고쳐 쓴다
+    char *out = name;
+    const char *p = name;
+    while (*p) {
+        size_t length = strcspn(p, "/");
+        if (length == 2 && p[0] == '.' && p[1] == '.') {
+            while (out > name && out[-1] != '/') out--;
+            if (out > name) out--;
+        } else if (length > 0 && !(length == 1 && p[0] == '.')) {
+            if (out > name) *out++ = '/';
+            memmove(out, p, length);
+            out += length;
+        }
+        p += length;
+        if (*p) p++;
+    }
+    *out = '\0';
+    return name;
+}
+
+// 풀 때 현재 디렉터리 밖을 가리키는 이름(절대 경로, ".." 구성 요소)은 거부한다
+int isSafeEntryName(const char *name) {
+    if (name[0] == '/' || name[0] == '\\' || (name[0] != '\0' && name[1] == ':')) return 0;
+    for (const char *p = name; *p; ) {
+        const char *end = p + strcspn(p, "/\\");
+        if (end - p == 2 && p[0] == '.' && p[1] == '.') return 0;
+        p = *end ? end + 1 : end;
+    }
+    return 1;
+}
+
+int compareNames(const void *a, const void *b) {
+    return strcmp(*(const char *const *)a, *(const char *const *)b);
+}
+
+// 아카이브를 만드는 동안의 상태
+struct ArchiveBuild {
+    struct AdvArchiveWriter *writer;
+    const struct CliOptions *opts;
+    struct stat archiveStat; // 아카이브 자신을 항목으로 넣지 않기 위해
+    long entries;
+    long processed;
+};
+
+// 파일 하나를 항목으로 더하거나, 디렉터리면 이름 순으로 하위 항목을 모두 더한다
+int addArchivePath(struct ArchiveBuild *build, const char *path) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: 파일을 찾을 수 없습니다.\n", path);
+        return 1;
+    }
+    if (S_ISDIR(st.st_mode)) {
+        DIR *dir = opendir(path);
+        if (dir == NULL) {
+            fprintf(stderr, "%s: 디렉터리를 열 수 없습니다.\n", path);
+            return 1;
+        }
+        char **names = NULL;
+        size_t count = 0, capacity = 0;
+        struct dirent *item;
+        while ((item = readdir(dir)) != NULL) {
+            if (strcmp(item->d_name, ".") == 0 || strcmp(item->d_name, "..") == 0) continue;
+            if (count == capacity) {
+                capacity = capacity ? capacity * 2 : 64;
+                char **grown = (char **)realloc(names, capacity * sizeof(char *));
+                if (!grown) break;
+                names = grown;
+            }
+            size_t len = strlen(path) + strlen(item->d_name) + 2;
+            names[count] = (char *)malloc(len);
+            if (!names[count]) break;
+            size_t pathLen = strlen(path);
+            snprintf(names[count], len, "%s%s%s", path, pathLen && path[pathLen - 1] == '/' ? "" : "/", item->d_name);
+            count++;
+        }
+        closedir(dir);
+        qsort(names, count, sizeof(char *), compareNames);
+        int failed = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (!failed) failed = addArchivePath(build, names[i]);
+            free(names[i]);
+        }
+        free(names);
+        return failed;
+    }
+    if (!S_ISREG(st.st_mode)) return 0;
+    if (st.st_ino != 0 && st.st_dev == build->archiveStat.st_dev && st.st_ino == build->archiveStat.st_ino) return 0;
+
+    FILE *source = fopen(path, "rb");
+    if (source == NULL) {
+        fprintf(stderr, "%s: 파일을 열 수 없습니다.\n", path);
+        return 1;
+    }
+    char *name = (char *)malloc(strlen(path) + 1);
+    int result = ADV_ERR_NOMEM;
+    if (name) {
+        strcpy(name, path);
+        const char *entryName = archiveEntryName(name);
+        if (entryName[0] == '\0' || !isSafeEntryName(entryName)) {
+            // 풀 수 없는 항목은 만들지 않는다
+            fprintf(stderr, "%s: 아카이브 항목 이름으로 쓸 수 없는 경로입니다.\n", path);
+            free(name);
+            fclose(source);
+            return 1;
+        }
+        result = advArchiveAdd(build->writer, entryName, source, &build->processed);
+        free(name);
+    }
+    fclose(source);
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", path, advErrorMessage(result));
+        return 1;
+    }
+    build->entries++;
+    return 0;
+}
+
+// -a: 주어진 파일과 디렉터리를 아카이브 하나로 묶는다
+int createArchive(const char *archivePath, char **paths, int count, const struct CliOptions *opts) {
+    if (!opts->force && fileExists(archivePath)) {
+        fprintf(stderr, "%s: 출력 파일이 이미 있습니다 (-f로 덮어쓰기)\n", archivePath);
+        return 1;
+    }
+    FILE *dest = fopen(archivePath, "wb");
+    if (dest == NULL) {
+        fprintf(stderr, "%s: 출력 파일을 열 수 없습니다.\n", archivePath);
+        return 1;
+    }
+
+    struct AdvOptions codec;
+    struct CliProgress progress;
+    attachProgress(&codec, &progress, archivePath, "archive", opts);
+    struct ArchiveBuild build = { NULL, opts, {0}, 0, 0 };
+    fstat(fileno(dest), &build.archiveStat);
+    int result = advArchiveCreate(dest, &codec, &build.writer);
+    int failed = result != ADV_OK;
+    for (int i = 0; i < count && !failed; i++) {
+        failed = addArchivePath(&build, paths[i]);
+    }
+    if (build.writer) {
+        int closed = advArchiveClose(build.writer);
+        if (result == ADV_OK) result = closed;
+    }
+    long outSize = ftell(dest);
+    if (fclose(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    if (failed || result != ADV_OK) {
+        if (result != ADV_OK) fprintf(stderr, "%s: %s\n", archivePath, advErrorMessage(result));
+        remove(archivePath);
+        return 1;
+    }
+    if (!opts->quiet) {
+        double ratio = build.processed > 0 ? (double)outSize / build.processed * 100.0 : 0.0;
+        fprintf(stderr, "%s: 항목 %ld개, %ld -> %ld 바이트 (%.1f%%)\n",
+                archivePath, build.entries, build.processed, outSize, ratio);
+    }
+    return 0;
+}
+
+// -l: 중앙 디렉터리만 읽어 항목을 나열한다
+int listArchive(const char *archivePath) {
+    FILE *source = fopen(archivePath, "rb");
+    if (source == NULL) {
+        fprintf(stderr, "%s: 파일을 열 수 없습니다.\n", archivePath);
+        return 1;
+    }
+    struct AdvArchive archive;
+    int result = advArchiveOpen(source, &archive);
+    fclose(source);
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", archivePath, advErrorMessage(result));
+        return 1;
+    }
+    unsigned long long total = 0, packed = 0;
+    printf("        원본         압축   비율   블록   CRC32C  이름\n");
+    for (size_t i = 0; i < archive.count; i++) {
+        const struct AdvArchiveEntry *entry = &archive.entries[i];
+        double ratio = entry->size > 0 ? (double)entry->packedSize / entry->size * 100.0 : 0.0;
+        printf("%12llu %12llu %5.1f%% %6u %08x  %s\n",
+               entry->size, entry->packedSize, ratio, entry->blockCount, entry->checksum, entry->name);
+        total += entry->size;
+        packed += entry->packedSize;
+    }
+    printf("%12llu %12llu  항목 %lu개\n", total, packed, (unsigned long)archive.count);
+    advArchiveFree(&archive);
+    return 0;
+}
+
+// 항목 이름의 상위 디렉터리들을 만든다
+void makeParentDirectories(const char *name) {
+    char *path = (char *)malloc(strlen(name) + 1);
+    if (!path) return;
+    strcpy(path, name);
+    for (char *p = path; *p; p++) {
+        if (*p != '/' || p == path) continue;
+        *p = '\0';
+        makeDirectory(path);
+        *p = '/';
+    }
+    free(path);
+}
+
+// 항목 하나를 풀어 같은 이름의 파일로(-c면 표준 출력으로) 쓴다
+int extractEntry(FILE *source, const struct AdvArchive *archive, size_t index, const struct CliOptions *opts) {
+    const char *name = archive->entries[index].name;
+    if (opts->range) {
+        struct AdvReader *reader;
+        int result = advReaderOpenEntry(source, archive, index, ADV_READER_CACHE_DEFAULT, &reader);
+        if (result != ADV_OK) {
+            fprintf(stderr, "%s: %s\n", name, advErrorMessage(result));
+            return 1;
+        }
+        int failed = copyRange(reader, name, opts);
+        advReaderClose(reader);
+        return failed;
+    }
+    FILE *dest = stdout;
+    if (!opts->toStdout) {
+        if (!isSafeEntryName(name)) {
+            fprintf(stderr, "%s: 현재 디렉터리 밖을 가리키는 항목은 풀지 않습니다.\n", name);
+            return 1;
+        }
+        if (!opts->force && fileExists(name)) {
+            fprintf(stderr, "%s: 출력 파일이 이미 있습니다 (-f로 덮어쓰기)\n", name);
+            return 1;
+        }
+        makeParentDirectories(name);
+        dest = fopen(name, "wb");
+        if (dest == NULL) {
+            fprintf(stderr, "%s: 출력 파일을 열 수 없습니다.\n", name);
+            return 1;
+        }
+    }
+
+    struct AdvOptions codec;
+    struct CliProgress progress;
+    attachProgress(&codec, &progress, name, "extract", opts);
+    long processed = 0;
+    int result = advArchiveExtract(source, archive, index, dest, &processed, &codec);
+    if (fflush(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    if (!opts->toStdout && fclose(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", name, advErrorMessage(result));
+        if (!opts->toStdout) remove(name);
+        return 1;
+    }
+    if (!opts->quiet && !opts->toStdout) {
+        fprintf(stderr, "%s: %llu 바이트\n", name, archive->entries[index].size);
+    }
+    return 0;
+}
+
+// -x: 지정한 항목만, 없으면 모든 항목을 푼다. 다른 항목의 블록은 읽지 않는다.
+int extractArchive(const char *archivePath, char **names, int count, const struct CliOptions *opts) {
+    FILE *source = fopen(archivePath, "rb");
+    if (source == NULL) {
+        fprintf(stderr, "%s: 파일을 열 수 없습니다.\n", archivePath);
+        return 1;
+    }
+    struct AdvArchive archive;
+    int result = advArchiveOpen(source, &archive);
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", archivePath, advErrorMessage(result));
+        fclose(source);
+        return 1;
+    }
+    int failed = 0;
+    if (count == 0) {
+        for (size_t i = 0; i < archive.count && !cliCancelled; i++) failed |= extractEntry(source, &archive, i, opts);
+    }
+    for (int i = 0; i < count && !cliCancelled; i++) {
+        long index = advArchiveFind(&archive, names[i]);
+        if (index < 0) {
+            fprintf(stderr, "%s: 아카이브에 없는 항목입니다.\n", names[i]);
+            failed = 1;
+            continue;
+        }
+        failed |= extractEntry(source, &archive, (size_t)index, opts);
+    }
+    advArchiveFree(&archive);
+    fclose(source);
+    return failed;
+}
+
+// 사전 파일을 읽어 캐시에 등록하고, 압축할 때 쓸 사전으로 정한다 (마지막에 준 것)
+int loadDictionary(const char *path, struct CliOptions *opts) {
+    FILE *source = fopen(path, "rb");
+    if (source == NULL) {
+        fprintf(stderr, "%s: 사전 파일을 열 수 없습니다.\n", path);
+        return 1;
+    }
+    struct AdvDictionary *dict;
+    int result = advDictionaryLoad(source, &dict);
+    fclose(source);
+    unsigned int id = result == ADV_OK ? advDictionaryId(dict) : 0;
+    if (result == ADV_OK) result = advDictionaryRegister(dict);
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", path, advErrorMessage(result));
+        return 1;
+    }
+    opts->codec.dictionary = id;
+    return 0;
+}
+
+// 표본 파일을 모두 이어 붙여 사전을 학습한다
+int trainDictionary(const char *dictPath, char **samples, int count, const struct CliOptions *opts) {
+    if (!opts->force && fileExists(dictPath)) {
+        fprintf(stderr, "%s: 출력 파일이 이미 있습니다 (-f로 덮어쓰기)\n", dictPath);
+        return 1;
+    }
+    unsigned char *data = NULL;
+    size_t size = 0, capacity = 0;
+    int result = ADV_OK;
+    for (int i = 0; i < count && result == ADV_OK; i++) {
+        FILE *source = fopen(samples[i], "rb");
+        if (source == NULL) {
+            fprintf(stderr, "%s: 입력 파일을 열 수 없습니다.\n", samples[i]);
+            free(data);
+            return 1;
+        }
+        for (;;) {
+            if (capacity - size < CLI_READ_CHUNK) {
+                unsigned char *grown = (unsigned char *)realloc(data, capacity * 2 + CLI_READ_CHUNK);
+                if (!grown) {
+                    result = ADV_ERR_NOMEM;
+                    break;
+                }
+                data = grown;
+                capacity = capacity * 2 + CLI_READ_CHUNK;
+            }
+            size_t n = fread(data + size, 1, capacity - size, source);
+            size += n;
+            if (n == 0) break;
+        }
+        if (result == ADV_OK && ferror(source)) result = ADV_ERR_READ;
+        fclose(source);
+        if (result != ADV_OK) fprintf(stderr, "%s: %s\n", samples[i], advErrorMessage(result));
+    }
+
+    struct AdvDictionary *dict = NULL;
+    if (result == ADV_OK) result = advDictionaryTrain(data, size, ADV_DICT_ID_AUTO, &opts->codec, &dict);
+    free(data);
+    if (result != ADV_OK) return 1;
+
+    FILE *dest = fopen(dictPath, "wb");
+    if (dest == NULL) {
+        fprintf(stderr, "%s: 출력 파일을 열 수 없습니다.\n", dictPath);
+        advDictionaryFree(dict);
+        return 1;
+    }
+    result = advDictionarySave(dict, dest);
+    if (fclose(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    if (result != ADV_OK) {
+        fprintf(stderr, "%s: %s\n", dictPath, advErrorMessage(result));
+        remove(dictPath);
+    } else if (!opts->quiet) {
+        fprintf(stderr, "%s: 표본 %d개 (%zu 바이트), 사전 ID %08x\n", dictPath, count, size, advDictionaryId(dict));
+    }
+    advDictionaryFree(dict);
+    return result != ADV_OK;
+}
+
+int main(int argc, char *argv[]) {
+    struct CliOptions opts = {0};
+    advDefaultOptions(&opts.codec);
+    // 옵션은 첫 번째 파일 이름(아카이브 모드에서는 아카이브 이름) 앞에만 온다
+    int first = argc;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        if (strcmp(arg, "--") == 0) {
+            first = i + 1;
+            break;
+        }
+        if (arg[0] != '-' || arg[1] == '\0') {
+            first = i;
+            break;
+        }
+        for (const char *p = arg + 1; *p; p++) {
+            switch (*p) {
+            case 'z': opts.decompress = 0; break;
+            case 'd': opts.decompress = 1; break;
+            case 't': opts.test = 1; break;
+            case 'a': opts.archive = ARCHIVE_CREATE; break;
+            case 'l': opts.archive = ARCHIVE_LIST; break;
+            case 'x': opts.archive = ARCHIVE_EXTRACT; break;
+            case 'c': opts.toStdout = 1; break;
+            case 'f': opts.force = 1; break;
+            case 'q': opts.quiet = 1; break;
+            case 'p': opts.showProgress = 1; break;
+            case 'B': opts.codec.blockSort = 1; break;
+            case '0': case '1': case '2': case '3': case '4':
+            case '5': case '6': case '7': case '8': case '9':
+                opts.codec.level = *p - '0';
+                break;
+            case 'h':
+                printUsage(argv[0]);
+                return 0;
+            case 'o':
+            case 'r':
+            case 'S':
+            case 'D':
+            case 'T':
+            case 'L': {
+                // 값은 옵션 뒤에 붙어 있거나 다음 인자로 온다
+                const char *value = NULL;
+                if (p[1] != '\0') {
+                    value = p + 1;
+                } else if (i + 1 < argc) {
+                    value = argv[++i];
+                } else {
+                    printUsage(argv[0]);
+                    return 1;
+                }
+                if (*p == 'o') {
+                    opts.outputName = value;
+                } else if (*p == 'D') {
+                    if (loadDictionary(value, &opts)) return 1;
+                } else if (*p == 'T') {
+                    opts.trainPath = value;
+                } else if (*p == 'r') {
+                    if (!parseRange(value, &opts)) {
+                        fprintf(stderr, "%s: 구간은 시작[:길이] 형식이어야 합니다.\n", value);
+                        return 1;
+                    }
+                } else if (*p == 'S') {
+                    if (opts.stats) fclose(opts.stats);
+                    opts.stats = fopen(value, "a");
+                    if (opts.stats == NULL) {
+                        fprintf(stderr, "%s: 통계 파일을 열 수 없습니다.\n", value);
+                        return 1;
+                    }
+                } else {
+                    opts.codec.maxCodeLength = atoi(value);
+                    if (opts.codec.maxCodeLength < ADV_CODE_LIMIT_MIN || opts.codec.maxCodeLength > ADV_CODE_LIMIT_MAX) {
+                        fprintf(stderr, "코드 길이 상한은 %d~%d 사이여야 합니다.\n", ADV_CODE_LIMIT_MIN, ADV_CODE_LIMIT_MAX);
+                        return 1;
+                    }
+                }
+                p += strlen(p) - 1;
+                break;
+            }
+            default:
+                fprintf(stderr, "알 수 없는 옵션: -%c\n", *p);
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    }
+
+#ifdef _WIN32
+    _setmode(_fileno(stdin), _O_BINARY);
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+    opts.codec.cancel = &cliCancelled;
+    signal(SIGINT, handleInterrupt);
+    signal(SIGTERM, handleInterrupt);
+
+    if (opts.codec.blockSort && !opts.decompress && !opts.quiet &&
+        (opts.archive == ARCHIVE_NONE || opts.archive == ARCHIVE_CREATE) && !opts.range && opts.trainPath == NULL) {
+        fprintf(stderr, "블록 정렬 모드: 블록당 작업 메모리 최대 %.1f MiB (해제할 때 %.1f MiB)\n",
+                advBlockSortMemory(0) / 1048576.0, advBlockSortMemory(1) / 1048576.0);
+    }
+    if (opts.trainPath != NULL) {
+        if (first >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        int failed = trainDictionary(opts.trainPath, &argv[first], argc - first, &opts);
+        if (opts.stats) fclose(opts.stats);
+        return failed ? 1 : 0;
+    }
+    if (opts.archive != ARCHIVE_NONE) {
+        // 첫 번째 인자가 아카이브, 나머지는 넣을 파일이나 풀 항목이다
+        if (first >= argc || (opts.archive == ARCHIVE_CREATE && argc - first < 2) ||
+            (opts.range && (opts.archive != ARCHIVE_EXTRACT || argc - first < 2))) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        int failed;
+        if (opts.archive == ARCHIVE_CREATE) failed = createArchive(argv[first], &argv[first + 1], argc - first - 1, &opts);
+        else if (opts.archive == ARCHIVE_LIST) failed = listArchive(argv[first]);
+        else failed = extractArchive(argv[first], &argv[first + 1], argc - first - 1, &opts);
+        if (opts.stats) fclose(opts.stats);
+        return failed ? 1 : 0;
+    }
+    if (opts.range) {
+        if (first >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        int failed = 0;
+        for (int i = first; i < argc && !cliCancelled; i++) failed |= readRange(argv[i], &opts);
+        if (opts.stats) fclose(opts.stats);
+        return failed ? 1 : 0;
+    }
+    if (opts.outputName != NULL && argc - first > 1) {
+        fprintf(stderr, "-o는 입력 파일이 하나일 때만 쓸 수 있습니다.\n");
+        return 1;
+    }
+    int failed = 0;
+    if (first >= argc) {
+        failed = processStdio(&opts);
+    } else {
+        for (int i = first; i < argc && !cliCancelled; i++) {
+            failed |= processArgument(argv[i], &opts);
+        }
+    }
+    if (opts.stats) fclose(opts.stats);
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,1419 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include "adv_internal.h"
+
+#ifndef _WIN32
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#endif
+
+// 리틀 엔디언 32비트 정수 읽기/쓰기
+void putLE32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+uint32_t getLE32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void putLE64(unsigned char* p, uint64_t v) {
+    putLE32(p, (uint32_t)v);
+    putLE32(p + 4, (uint32_t)(v >> 32));
+}
+
+uint64_t getLE64(const unsigned char* p) {
+    return (uint64_t)getLE32(p) | ((uint64_t)getLE32(p + 4) << 32);
+}
+
+// v1, v2 코드 길이표: [고유 문자 수(2바이트)][문자][코드 길이]...
+// 읽어서 정규 코드를 복원하고 읽은 바이트 수를 돌려준다 (오류 시 0)
+size_t readCodeLengthTable(const unsigned char* in, size_t avail, uint64_t codes[], unsigned char lengths[]) {
+    if (avail < 2) return 0;
+    unsigned unique = in[0] | (in[1] << 8);
+    size_t idx = 2;
+    if (unique == 0 || unique > 256 || avail < idx + unique * 2) return 0;
+
+    memset(lengths, 0, 256);
+    for(unsigned i = 0; i < unique; i++) {
+        unsigned char symbol = in[idx++];
+        unsigned char len = in[idx++];
+        if (len == 0 || len > MAX_CODE_LEN) return 0;
+        lengths[symbol] = len;
+    }
+    if (!validateCodeLengths(lengths, 256)) return 0;
+    assignCanonicalCodes(lengths, 256, codes);
+    return idx;
+}
+
+// 하프만 블록의 코드 길이표를 형식 버전에 맞게 읽어 정규 코드를 복원한다 (오류 시 0)
+size_t readBlockCodeLengths(int version, const unsigned char* in, size_t avail, uint64_t codes[], unsigned char lengths[]) {
+    if (version == ADV_FORMAT_FRAMED) return readCodeLengthTable(in, avail, codes, lengths);
+    size_t tableSize = readPackedLengths(in, avail, lengths, 256);
+    if (tableSize == 0 || !validateCodeLengths(lengths, 256)) return 0;
+    assignCanonicalCodes(lengths, 256, codes);
+    return tableSize;
+}
+
+// 프레임 형식(v2 이상)이면서 이 라이브러리가 읽을 수 있는 버전인지
+int isFramedVersion(int version) {
+    return version >= ADV_FORMAT_FRAMED && version <= ADV_FORMAT_VERSION;
+}
+
+void writeFileHeader(unsigned char* out) {
+    memcpy(out, ADV_MAGIC, ADV_MAGIC_SIZE);
+    out[ADV_MAGIC_SIZE] = ADV_FORMAT_VERSION;
+    out[ADV_MAGIC_SIZE + 1] = ADV_FLAG_INDEX;
+}
+
+// 블록 인덱스와 트레일러를 기록하고 기록한 바이트 수를 돌려준다
+size_t writeBlockIndex(unsigned char* out, const uint64_t* frameOffset, const uint32_t* rawSize, size_t blockCount, uint64_t indexOffset) {
+    size_t idx = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        putLE64(&out[idx], frameOffset[i]);
+        putLE32(&out[idx + 8], rawSize[i]);
+        idx += ADV_INDEX_ENTRY_SIZE;
+    }
+    putLE64(&out[idx], indexOffset);
+    putLE32(&out[idx + 8], (uint32_t)blockCount);
+    memcpy(&out[idx + 12], ADV_INDEX_MAGIC, 4);
+    return idx + ADV_INDEX_TRAILER_SIZE;
+}
+
+void advDefaultOptions(struct AdvOptions* options) {
+    options->maxCodeLength = ADV_CODE_LIMIT_DEFAULT;
+    options->level = ADV_LEVEL_DEFAULT;
+    options->progress = NULL;
+    options->progressData = NULL;
+    options->progressInterval = ADV_PROGRESS_INTERVAL;
+    options->dictionary = 0;
+    options->cancel = NULL;
+    options->blockSort = 0;
+}
+
+// 호출자가 준 설정을 복사하며 범위를 벗어난 값을 바로잡는다 (NULL이면 기본값)
+void resolveOptions(const struct AdvOptions* options, struct AdvOptions* resolved) {
+    advDefaultOptions(resolved);
+    if (options == NULL) return;
+    *resolved = *options;
+    if (resolved->maxCodeLength < ADV_CODE_LIMIT_MIN) resolved->maxCodeLength = ADV_CODE_LIMIT_MIN;
+    if (resolved->maxCodeLength > ADV_CODE_LIMIT_MAX) resolved->maxCodeLength = ADV_CODE_LIMIT_MAX;
+    if (resolved->level < ADV_LEVEL_MIN) resolved->level = ADV_LEVEL_MIN;
+    if (resolved->level > ADV_LEVEL_MAX) resolved->level = ADV_LEVEL_MAX;
+}
+
+// 압축하지 않은 그대로의 블록 프레임
+size_t writeStoredBlock(unsigned char* out, const unsigned char* data, size_t size) {
+    out[0] = ADV_BLOCK_STORED;
+    putLE32(&out[1], (uint32_t)size);
+    putLE32(&out[5], (uint32_t)size);
+    memcpy(&out[ADV_BLOCK_HEADER_SIZE], data, size);
+    return ADV_BLOCK_HEADER_SIZE + size;
+}
+
+// 같은 바이트가 size번 반복되는 블록 프레임
+size_t writeRunBlock(unsigned char* out, unsigned char symbol, size_t size) {
+    out[0] = ADV_BLOCK_RUN;
+    putLE32(&out[1], (uint32_t)size);
+    putLE32(&out[5], 1);
+    out[ADV_BLOCK_HEADER_SIZE] = symbol;
+    return ADV_BLOCK_HEADER_SIZE + 1;
+}
+
+// 빈도를 구한 블록 하나를 가장 작은 블록 종류로 인코딩해 프레임으로 기록한다 (체크섬 제외)
+size_t encodeBlock(const unsigned char* data, size_t size, const unsigned freq[], unsigned char* out, const struct AdvOptions* options) {
+    // 1. 한 종류의 바이트로만 된 블록은 그 바이트 하나만 기록한다
+    int distinct = 0;
+    int lastSymbol = 0;
+    for (int i = 0; i < 256; i++) {
+        if (freq[i]) {
+            distinct++;
+            lastSymbol = i;
+        }
+    }
+    if (distinct == 1) return writeRunBlock(out, (unsigned char)lastSymbol, size);
+
+    // 2. 상한 이내의 코드 길이를 구하고 하프만 블록의 크기를 빈도로 미리 계산한다
+    unsigned char lengths[256];
+    uint64_t codes[256];
+    buildCodeLengths(freq, 256, lengths, options->maxCodeLength);
+    unsigned char table[ADV_PACKED_LENGTHS_MAX(256)];
+    size_t tableSize = writePackedLengths(lengths, 256, table);
+    uint64_t bits = 0;
+    for (int i = 0; i < 256; i++) bits += (uint64_t)freq[i] * lengths[i];
+    // 다중 스트림이면 점프 테이블과 스트림마다 최대 1바이트의 패딩이 더 든다
+    int multiStream = size >= ADV_HUFF_STREAMS_MIN;
+    size_t huffmanSize = ADV_BLOCK_HEADER_SIZE + tableSize + (size_t)((bits + 7) / 8);
+    if (multiStream) huffmanSize += ADV_HUFF_JUMP_SIZE + ADV_HUFF_STREAMS - 1;
+
+    // 3. 같은 빈도로 tANS 블록의 크기도 추정해 더 작은 엔트로피 부호기를 고른다
+    uint16_t norm[256];
+    size_t ansSize = estimateAnsBlock(freq, size, norm);
+    size_t entropySize = ansSize < huffmanSize ? ansSize : huffmanSize;
+
+    // 사전을 쓰면 코드표 없이 사전 코드로 인코딩한 크기도 후보에 넣는다
+    const struct AdvDictionary* dict = options->dictionary ? findDictionary(options->dictionary) : NULL;
+    size_t dictSize = SIZE_MAX;
+    uint64_t dictBits = dict ? dictionaryBits(dict, freq) : UINT64_MAX;
+    if (dictBits != UINT64_MAX) {
+        dictSize = ADV_BLOCK_HEADER_SIZE + 4 + (size_t)((dictBits + 7) / 8);
+        if (multiStream) dictSize += ADV_HUFF_JUMP_SIZE + ADV_HUFF_STREAMS - 1;
+        if (dictSize < entropySize) entropySize = dictSize;
+    }
+
+    // 4. 바이트 분포가 고르면 (이미 압축된 데이터) 문맥 모델, 일치 탐색과 인코딩을 건너뛰고 그대로 저장한다.
+    // 문맥 모델은 블록마다 할당과 군집화가 들어서 순서 0 부호화가 줄이지 못하는 블록에는 쓰지 않는다.
+    size_t storedSize = ADV_BLOCK_HEADER_SIZE + size;
+    if (entropySize >= storedSize - size / ADV_STORE_MIN_SAVING) return writeStoredBlock(out, data, size);
+
+    // 앞 바이트 문맥별 코드표로 부호화한 크기도 후보에 넣는다 (텍스트와 구조화된 데이터)
+    struct ContextModel context;
+    size_t contextSize = estimateContextBlock(data, size, options->maxCodeLength, &context);
+    if (contextSize < entropySize) entropySize = contextSize;
+
+    // 5. LZ 블록이 그보다 작으면 그것을 쓴다. 블록 정렬 모드에서는 BWT 블록이 더 작으면 그것으로 덮어쓴다.
+    size_t lzSize = compressLzBlock(data, size, out, options, entropySize);
+    if (options->blockSort) {
+        size_t bwtSize = compressBwtBlock(data, size, out, options, lzSize > 0 ? lzSize : entropySize);
+        if (bwtSize > 0) return bwtSize;
+    }
+    if (lzSize > 0) return lzSize;
+    if (dictSize == entropySize) {
+        out[0] = ADV_BLOCK_DICT;
+        putLE32(&out[1], (uint32_t)size);
+        size_t payloadSize = writeDictionaryPayload(dict, data, size, &out[ADV_BLOCK_HEADER_SIZE]);
+        putLE32(&out[5], (uint32_t)payloadSize);
+        return ADV_BLOCK_HEADER_SIZE + payloadSize;
+    }
+    if (contextSize == entropySize) return compressContextBlock(data, size, &context, out);
+    if (ansSize < huffmanSize) return compressAnsBlock(data, size, norm, out);
+
+    // 6. 정규 코드를 배정하고 프레임 기록: 헤더, 코드 길이표, 인코딩된 비트
+    assignCanonicalCodes(lengths, 256, codes);
+    out[0] = multiStream ? ADV_BLOCK_HUFFMAN4 : ADV_BLOCK_HUFFMAN;
+    putLE32(&out[1], (uint32_t)size);
+    size_t idx = ADV_BLOCK_HEADER_SIZE;
+    memcpy(&out[idx], table, tableSize);
+    idx += tableSize;
+    if (multiStream) {
+        idx += huffmanEncodeStreams(data, size, &out[idx], codes, lengths);
+    } else {
+        idx += huffmanEncode(data, size, &out[idx], codes, lengths);
+    }
+    putLE32(&out[5], (uint32_t)(idx - ADV_BLOCK_HEADER_SIZE));
+    return idx;
+}
+
+// 블록 하나를 프레임으로 기록한다. 빈도를 세는 같은 읽기에서 원본의 CRC32C도 구해
+// 페이로드 끝에 붙이고 checksum에 돌려준다 (파일 체크섬은 블록 체크섬을 이어 붙여 만든다).
+// out은 ADV_BLOCK_BOUND(size) 바이트 이상이어야 하며 기록한 바이트 수를 돌려준다.
+size_t compressBlock(const unsigned char* data, size_t size, unsigned char* out, const struct AdvOptions* options, uint32_t* checksum) {
+    unsigned freq[256];
+    uint32_t crc = 0;
+    calculateFrequencyChecksum(data, size, freq, &crc);
+    size_t frameSize = encodeBlock(data, size, freq, out, options);
+    putLE32(&out[frameSize], crc);
+    putLE32(&out[5], getLE32(&out[5]) + ADV_CHECKSUM_SIZE);
+    if (checksum) *checksum = crc;
+    return frameSize + ADV_CHECKSUM_SIZE;
+}
+
+// 블록 페이로드를 정확히 rawSize 바이트로 복원한다 (version은 파일 형식 버전)
+int decompressBlock(int version, int blockType, const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize) {
+    switch (blockType) {
+    case ADV_BLOCK_HUFFMAN:
+    case ADV_BLOCK_HUFFMAN4:
+        break;
+    case ADV_BLOCK_LZ:
+        return decompressLzBlock(version, payload, payloadSize, out, rawSize);
+    case ADV_BLOCK_ANS:
+        return decompressAnsBlock(payload, payloadSize, out, rawSize);
+    case ADV_BLOCK_DICT:
+        return decompressDictionaryBlock(payload, payloadSize, out, rawSize);
+    case ADV_BLOCK_CONTEXT:
+        return decompressContextBlock(payload, payloadSize, out, rawSize);
+    case ADV_BLOCK_BWT:
+        return decompressBwtBlock(payload, payloadSize, out, rawSize);
+    case ADV_BLOCK_STORED:
+        if (payloadSize != rawSize) return ADV_ERR_FORMAT;
+        memcpy(out, payload, rawSize);
+        return ADV_OK;
+    case ADV_BLOCK_RUN:
+        if (payloadSize != 1) return ADV_ERR_FORMAT;
+        memset(out, payload[0], rawSize);
+        return ADV_OK;
+    default:
+        return ADV_ERR_FORMAT;
+    }
+
+    uint64_t codes[256];
+    unsigned char lengths[256];
+    size_t tableSize = readBlockCodeLengths(version, payload, payloadSize, codes, lengths);
+    if (tableSize == 0) return ADV_ERR_FORMAT;
+    if (blockType == ADV_BLOCK_HUFFMAN4) {
+        return huffmanDecodeStreams(&payload[tableSize], payloadSize - tableSize, codes, lengths, out, rawSize);
+    }
+    if (huffmanDecode(&payload[tableSize], payloadSize - tableSize, codes, lengths, out, rawSize) != rawSize) {
+        return ADV_ERR_FORMAT;
+    }
+    return ADV_OK;
+}
+
+// 프레임 하나를 복원하고 체크섬을 확인한다. v4부터는 페이로드 끝 4바이트가 원본 블록의
+// CRC32C라서, 복원한 출력이 캐시에 있는 동안 바로 계산해 대조한다 (다르면 ADV_ERR_CHECKSUM).
+// checksum이 NULL이 아니면 블록의 CRC32C를 돌려준다 (v3 이하는 이때만 계산한다).
+int decodeBlock(int version, int blockType, const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize, uint32_t* checksum) {
+    if (version < ADV_FORMAT_CHECKSUM) {
+        int result = decompressBlock(version, blockType, payload, payloadSize, out, rawSize);
+        if (result == ADV_OK && checksum) *checksum = crc32cUpdate(0, out, rawSize);
+        return result;
+    }
+    if (payloadSize < ADV_CHECKSUM_SIZE) return ADV_ERR_FORMAT;
+    payloadSize -= ADV_CHECKSUM_SIZE;
+    int result = decompressBlock(version, blockType, payload, payloadSize, out, rawSize);
+    if (result != ADV_OK) return result;
+    uint32_t crc = crc32cUpdate(0, out, rawSize);
+    if (crc != getLE32(&payload[payloadSize])) return ADV_ERR_CHECKSUM;
+    if (checksum) *checksum = crc;
+    return ADV_OK;
+}
+
+// v4 끝 프레임: 끝 표시 뒤에 원본 전체의 CRC32C
+size_t writeEndFrame(unsigned char* out, uint32_t checksum) {
+    out[0] = ADV_BLOCK_END;
+    putLE32(&out[1], checksum);
+    return ADV_END_FRAME_SIZE;
+}
+
+// 병렬 압축 배치: 블록 i의 입력과 출력 위치
+struct BlockBatch {
+    const unsigned char **input;
+    size_t *inputSize;
+    unsigned char **output;
+    size_t *outputSize;
+    uint32_t *checksum;
+    const struct AdvOptions *options;
+};
+
+void compressBlockTask(void *ctx, size_t index) {
+    struct BlockBatch *batch = (struct BlockBatch *)ctx;
+    batch->outputSize[index] = compressBlock(batch->input[index], batch->inputSize[index], batch->output[index], batch->options,
+                                             &batch->checksum[index]);
+}
+
+// 새로운 압축 알고리즘 정의 (블록 단위 정규 하프만 코딩)
+// 압축된 데이터는 다음과 같은 형식으로 저장됩니다:
+// [파일 헤더][블록 프레임]...[끝 프레임][블록 인덱스][트레일러]
+int advancedCompression(const unsigned char* data, size_t size, unsigned char** compressedData, size_t* compressedSize, const struct AdvOptions* options) {
+    size_t blockCount = (size + ADV_BLOCK_SIZE - 1) / ADV_BLOCK_SIZE;
+    size_t bound = ADV_FILE_HEADER_SIZE + blockCount * (ADV_BLOCK_BOUND(0) + ADV_INDEX_ENTRY_SIZE) + size + size / 8 + ADV_END_FRAME_SIZE + ADV_INDEX_TRAILER_SIZE;
+    unsigned char* finalBuffer = (unsigned char*)malloc(bound);
+    const unsigned char** input = (const unsigned char**)malloc((blockCount + 1) * sizeof(unsigned char*));
+    unsigned char** output = (unsigned char**)malloc((blockCount + 1) * sizeof(unsigned char*));
+    size_t* inputSize = (size_t*)malloc((blockCount + 1) * sizeof(size_t));
+    size_t* outputSize = (size_t*)malloc((blockCount + 1) * sizeof(size_t));
+    uint32_t* checksum = (uint32_t*)malloc((blockCount + 1) * sizeof(uint32_t));
+    uint64_t* frameOffset = (uint64_t*)malloc((blockCount + 1) * sizeof(uint64_t));
+    uint32_t* rawSize = (uint32_t*)malloc((blockCount + 1) * sizeof(uint32_t));
+    if (!finalBuffer || !input || !output || !inputSize || !outputSize || !checksum || !frameOffset || !rawSize) {
+        free(finalBuffer);
+        free(input);
+        free(output);
+        free(inputSize);
+        free(outputSize);
+        free(checksum);
+        free(frameOffset);
+        free(rawSize);
+        return ADV_ERR_NOMEM;
+    }
+
+    // 블록마다 최대 크기만큼 자리를 잡아 두고 병렬로 압축한 뒤 앞으로 당겨 붙인다
+    size_t slot = ADV_FILE_HEADER_SIZE;
+    for (size_t i = 0; i < blockCount; i++) {
+        size_t pos = i * ADV_BLOCK_SIZE;
+        input[i] = &data[pos];
+        inputSize[i] = size - pos < ADV_BLOCK_SIZE ? size - pos : ADV_BLOCK_SIZE;
+        output[i] = &finalBuffer[slot];
+        slot += ADV_BLOCK_BOUND(inputSize[i]);
+    }
+    struct AdvOptions resolved;
+    resolveOptions(options, &resolved);
+    struct BlockBatch batch = { input, inputSize, output, outputSize, checksum, &resolved };
+    int threadCount = getCpuCount();
+    struct WorkerPool* pool = blockCount > 1 && threadCount > 1 ? createWorkerPool(threadCount) : NULL;
+    if (pool) {
+        runParallel(pool, blockCount, compressBlockTask, &batch);
+        destroyWorkerPool(pool);
+    } else {
+        for (size_t i = 0; i < blockCount; i++) compressBlockTask(&batch, i);
+    }
+
+    writeFileHeader(finalBuffer);
+    size_t idx = ADV_FILE_HEADER_SIZE;
+    uint32_t fileChecksum = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        memmove(&finalBuffer[idx], output[i], outputSize[i]);
+        frameOffset[i] = idx;
+        rawSize[i] = (uint32_t)inputSize[i];
+        fileChecksum = crc32cCombine(fileChecksum, checksum[i], inputSize[i]);
+        idx += outputSize[i];
+    }
+    idx += writeEndFrame(&finalBuffer[idx], fileChecksum);
+    idx += writeBlockIndex(&finalBuffer[idx], frameOffset, rawSize, blockCount, idx);
+
+    free(input);
+    free(output);
+    free(inputSize);
+    free(outputSize);
+    free(checksum);
+    free(frameOffset);
+    free(rawSize);
+    *compressedData = finalBuffer;
+    *compressedSize = idx;
+    return ADV_OK;
+}
+
+// 이전 형식(v0) 헤더 해석: [고유 문자 수][문자][빈도]...
+// 빈도로 트리를 다시 만들어 당시 트리 경로 그대로의 코드를 얻는다.
+size_t readLegacyHeader(const unsigned char* compressed_data, size_t compressed_size, uint64_t codes[], unsigned char lengths[]) {
+    unsigned unique = compressed_data[0];
+    size_t idx = 1;
+
+    // 256개 심볼은 1바이트에 0으로 기록되었다 (빈 입력은 출력 자체가 없음)
+    if (unique == 0) unique = 256;
+    if (compressed_size < 1 + unique * (1 + sizeof(unsigned))) {
+        // 유효하지 않은 압축 데이터
+        return 0;
+    }
+
+    unsigned char uniqueChars[256];
+    unsigned uniqueFreqArr[256];
+    for(unsigned i = 0; i < unique; i++) {
+        uniqueChars[i] = compressed_data[idx++];
+        memcpy(&uniqueFreqArr[i], &compressed_data[idx], sizeof(unsigned));
+        idx += sizeof(unsigned);
+    }
+
+    struct MinHeapNode* root = buildHuffmanTree(uniqueChars, uniqueFreqArr, unique);
+    collectTreeCodes(root, 0, 0, codes, lengths);
+    freeHuffmanTree(root);
+    return idx;
+}
+
+// 병렬 해제 배치: 작업 i는 블록 first + i의 프레임 위치와 복원될 위치를 쓴다
+struct FrameBatch {
+    int version;
+    size_t first;
+    const unsigned char* data;
+    const size_t* frameOffset;
+    const size_t* rawOffset;
+    unsigned char* output;
+    int* result;
+    uint32_t* checksum; // v4 블록별 원본 CRC32C (v3 이하는 NULL)
+};
+
+void decompressFrameTask(void* ctx, size_t index) {
+    struct FrameBatch* batch = (struct FrameBatch*)ctx;
+    size_t block = batch->first + index;
+    const unsigned char* frame = &batch->data[batch->frameOffset[block]];
+    batch->result[block] = decodeBlock(batch->version, frame[0], &frame[ADV_BLOCK_HEADER_SIZE], getLE32(&frame[5]),
+                                       &batch->output[batch->rawOffset[block]], getLE32(&frame[1]),
+                                       batch->checksum ? &batch->checksum[block] : NULL);
+}
+
+// v2 프레임 헤더만 훑어 블록별 프레임 위치와 복원될 위치, 전체 원본 크기를 구한다.
+// v4이면 끝 프레임에 기록된 원본 전체의 CRC32C도 읽는다.
+int scanFrames(const unsigned char* data, size_t size, size_t* blockCount, size_t** frameOffset, size_t** rawOffset, size_t* total, uint32_t* fileChecksum) {
+    size_t idx = ADV_FILE_HEADER_SIZE;
+    size_t count = 0;
+    size_t outSize = 0;
+    for (;;) {
+        if (idx >= size) return ADV_ERR_FORMAT;
+        if (data[idx] == ADV_BLOCK_END) break;
+        if (size - idx < ADV_BLOCK_HEADER_SIZE) return ADV_ERR_FORMAT;
+        // 블록 크기를 넘는 원본 크기는 손상이다. 몇 바이트짜리 반복 블록이 거대한 출력을 할당하게 하지 않는다.
+        size_t rawSize = getLE32(&data[idx + 1]);
+        size_t payloadSize = getLE32(&data[idx + 5]);
+        if (rawSize > ADV_BLOCK_SIZE || size - idx - ADV_BLOCK_HEADER_SIZE < payloadSize) return ADV_ERR_FORMAT;
+        if (outSize >= SIZE_MAX - rawSize) return ADV_ERR_FORMAT; // 출력 버퍼 크기(total + 1)가 넘치지 않게
+        outSize += rawSize;
+        idx += ADV_BLOCK_HEADER_SIZE + payloadSize;
+        count++;
+    }
+    *fileChecksum = 0;
+    if (data[ADV_MAGIC_SIZE] >= ADV_FORMAT_CHECKSUM) {
+        if (size - idx < ADV_END_FRAME_SIZE) return ADV_ERR_FORMAT;
+        *fileChecksum = getLE32(&data[idx + 1]);
+    }
+
+    size_t* frames = (size_t*)malloc((count + 1) * sizeof(size_t));
+    size_t* raws = (size_t*)malloc((count + 1) * sizeof(size_t));
+    if (!frames || !raws) {
+        free(frames);
+        free(raws);
+        return ADV_ERR_NOMEM;
+    }
+    size_t outIdx = 0;
+    idx = ADV_FILE_HEADER_SIZE;
+    for (size_t i = 0; i < count; i++) {
+        frames[i] = idx;
+        raws[i] = outIdx;
+        outIdx += getLE32(&data[idx + 1]);
+        idx += ADV_BLOCK_HEADER_SIZE + getLE32(&data[idx + 5]);
+    }
+    *blockCount = count;
+    *frameOffset = frames;
+    *rawOffset = raws;
+    *total = outIdx;
+    return ADV_OK;
+}
+
+// 훑어 둔 프레임을 워커 풀에서 병렬로 해제해 output의 제자리에 복원한다.
+// 페이로드는 data 위에서 바로 읽으므로 입력이 매핑된 파일이어도 복사가 없다.
+// 진행을 보고할 때(meter가 NULL이 아닐 때)는 스트리밍 경로와 같은 배치 단위로 나눠 처리하고
+// 배치마다 취소를 확인한다.
+// v4는 워커가 확인한 블록 CRC32C를 차례로 이어 붙여 fileChecksum과 대조한다.
+int decodeFrames(int version, const unsigned char* data, size_t blockCount, const size_t* frameOffset, const size_t* rawOffset, unsigned char* output, struct ProgressMeter* meter, uint32_t fileChecksum) {
+    int* blockResult = (int*)malloc((blockCount + 1) * sizeof(int));
+    uint32_t* checksum = version >= ADV_FORMAT_CHECKSUM ? (uint32_t*)malloc((blockCount + 1) * sizeof(uint32_t)) : NULL;
+    if (!blockResult || (version >= ADV_FORMAT_CHECKSUM && !checksum)) {
+        free(blockResult);
+        free(checksum);
+        return ADV_ERR_NOMEM;
+    }
+
+    struct FrameBatch batch = { version, 0, data, frameOffset, rawOffset, output, blockResult, checksum };
+    int threadCount = getCpuCount();
+    size_t batchSize = meter ? (size_t)threadCount * ADV_BLOCKS_PER_WORKER : blockCount;
+    struct WorkerPool* pool = blockCount > 1 && threadCount > 1 ? createWorkerPool(threadCount) : NULL;
+    int result = ADV_OK;
+    uint32_t combined = 0;
+    for (size_t first = 0; result == ADV_OK && first < blockCount; first += batchSize) {
+        if (meter && progressCancelled(meter)) {
+            result = ADV_ERR_CANCELLED;
+            break;
+        }
+        size_t count = blockCount - first < batchSize ? blockCount - first : batchSize;
+        batch.first = first;
+        if (pool) {
+            runParallel(pool, count, decompressFrameTask, &batch);
+        } else {
+            for (size_t i = 0; i < count; i++) decompressFrameTask(&batch, i);
+        }
+        for (size_t i = first; i < first + count && result == ADV_OK; i++) {
+            const unsigned char* frame = &data[frameOffset[i]];
+            result = blockResult[i];
+            if (checksum) combined = crc32cCombine(combined, checksum[i], getLE32(&frame[1]));
+            if (meter) progressAdvance(meter, ADV_BLOCK_HEADER_SIZE + getLE32(&frame[5]), getLE32(&frame[1]), 1);
+        }
+    }
+    if (result == ADV_OK && checksum && combined != fileChecksum) result = ADV_ERR_CHECKSUM;
+    destroyWorkerPool(pool);
+    free(blockResult);
+    free(checksum);
+    return result;
+}
+
+// v2 프레임 해제: 정확한 크기의 버퍼를 잡고 각 블록을 제자리로 병렬 복원한다
+int decompressFrames(const unsigned char* data, size_t size, unsigned char** decompressedData, size_t* decompressedSize) {
+    size_t blockCount, total;
+    size_t* frameOffset;
+    size_t* rawOffset;
+    uint32_t fileChecksum;
+    int result = scanFrames(data, size, &blockCount, &frameOffset, &rawOffset, &total, &fileChecksum);
+    if (result != ADV_OK) return result;
+
+    unsigned char* out = (unsigned char*)malloc(total + 1);
+    result = out ? decodeFrames(data[ADV_MAGIC_SIZE], data, blockCount, frameOffset, rawOffset, out, NULL, fileChecksum) : ADV_ERR_NOMEM;
+    free(frameOffset);
+    free(rawOffset);
+    if (result != ADV_OK) {
+        free(out);
+        return result;
+    }
+    *decompressedData = out;
+    *decompressedSize = total;
+    return ADV_OK;
+}
+
+// 하프만 압축 해제 함수 (v0부터 현재 형식까지 모두 처리)
+int advancedDecompression(const unsigned char* compressed_data, size_t compressed_size, unsigned char** decompressedData, size_t* decompressedSize) {
+    *decompressedData = NULL;
+    *decompressedSize = 0;
+    if (compressed_size < 1) {
+        return ADV_OK; // 이전 형식은 빈 입력을 빈 파일로 저장했다
+    }
+
+    // 1. 헤더에서 심볼별 코드와 길이 복원
+    uint64_t codes[256] = {0};
+    unsigned char lengths[256] = {0};
+    size_t idx;
+    if (compressed_size >= ADV_FILE_HEADER_SIZE && memcmp(compressed_data, ADV_MAGIC, ADV_MAGIC_SIZE) == 0) {
+        if (isFramedVersion(compressed_data[ADV_MAGIC_SIZE])) {
+            if (compressed_data[ADV_MAGIC_SIZE + 1] & ADV_FLAG_ARCHIVE) return ADV_ERR_ARCHIVE;
+            return decompressFrames(compressed_data, compressed_size, decompressedData, decompressedSize);
+        }
+        if (compressed_data[ADV_MAGIC_SIZE] != 1) {
+            return ADV_ERR_FORMAT; // 지원하지 않는 버전
+        }
+        // v1: [매직][버전][코드 길이표][인코딩된 비트]
+        idx = ADV_MAGIC_SIZE + 1;
+        size_t tableSize = readCodeLengthTable(&compressed_data[idx], compressed_size - idx, codes, lengths);
+        idx = tableSize ? idx + tableSize : 0;
+    } else {
+        idx = readLegacyHeader(compressed_data, compressed_size, codes, lengths);
+    }
+    if (idx == 0) {
+        return ADV_ERR_FORMAT;
+    }
+
+    // 2. 하프만 디코딩 (압축 데이터 위에서 바로 수행, 원본 크기를 모르므로 비트 수 기준 최대 크기 할당)
+    size_t encodedSize = compressed_size - idx;
+    unsigned char* decoded = (unsigned char*)malloc(encodedSize * 8 + 1);
+    if (!decoded) {
+        return ADV_ERR_NOMEM;
+    }
+    *decompressedSize = huffmanDecode(&compressed_data[idx], encodedSize, codes, lengths, decoded, encodedSize * 8);
+    *decompressedData = decoded;
+    return ADV_OK;
+}
+
+// 스트리밍 인코더 준비: 워커 풀과 배치 버퍼를 한 번 잡아 두고 여러 입력에 다시 쓴다.
+// 최대 메모리는 입력 크기와 무관하게 배치 크기만큼의 블록 버퍼로 고정된다.
+int frameEncoderInit(struct FrameEncoder* enc, const struct AdvOptions* options) {
+    memset(enc, 0, sizeof(*enc));
+    int threadCount = getCpuCount();
+    enc->batchSize = (size_t)threadCount * ADV_BLOCKS_PER_WORKER;
+    enc->pool = threadCount > 1 ? createWorkerPool(threadCount) : NULL;
+    enc->input = (const unsigned char**)calloc(enc->batchSize, sizeof(unsigned char*));
+    enc->output = (unsigned char**)calloc(enc->batchSize, sizeof(unsigned char*));
+    enc->inputSize = (size_t*)calloc(enc->batchSize, sizeof(size_t));
+    enc->outputSize = (size_t*)calloc(enc->batchSize, sizeof(size_t));
+    enc->checksum = (uint32_t*)calloc(enc->batchSize, sizeof(uint32_t));
+    resolveOptions(options, &enc->options);
+    if (!enc->input || !enc->output || !enc->inputSize || !enc->outputSize || !enc->checksum) {
+        return ADV_ERR_NOMEM;
+    }
+    return ADV_OK;
+}
+
+void frameEncoderFree(struct FrameEncoder* enc) {
+    destroyWorkerPool(enc->pool);
+    free(enc->input);
+    free(enc->output);
+    free(enc->inputSize);
+    free(enc->outputSize);
+    free(enc->checksum);
+    free(enc->frameOffset);
+    free(enc->rawSize);
+}
+
+// source를 끝까지 읽어 블록 프레임으로 기록한다. 배치마다 워커 수만큼의 블록을 읽어
+// 병렬로 인코딩하고 순서대로 기록하며, 프레임 위치를 블록 인덱스에 모은다.
+// 읽기와 쓰기는 파이프라인이 맡아 코덱이 배치를 인코딩하는 동안 다음 배치를 읽고 앞 배치를 기록한다.
+// checksum에는 워커가 구한 블록 CRC32C를 이어 붙여 원본 전체의 CRC32C를 이어서 계산한다.
+int encodeFrames(struct FrameEncoder* enc, FILE* source, FILE* dest, long* processed, struct ProgressMeter* meter, uint32_t* checksum) {
+    size_t batchBytes = enc->batchSize * ADV_BLOCK_SIZE;
+    struct IoPipeline* pipe = pipelineCreate(source, batchBytes, UINT64_MAX, dest, enc->batchSize * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE),
+                                             !fitsInBuffer(source, batchBytes), 0);
+    if (!pipe) return ADV_ERR_NOMEM;
+    struct BlockBatch batch = { enc->input, enc->inputSize, enc->output, enc->outputSize, enc->checksum, &enc->options };
+    int result = ADV_OK;
+    while (result == ADV_OK) {
+        if (progressCancelled(meter)) {
+            result = ADV_ERR_CANCELLED;
+            break;
+        }
+        progressStage(meter, ADV_STAGE_READ);
+        const unsigned char* data;
+        size_t size;
+        result = pipelineRead(pipe, &data, &size);
+        if (result != ADV_OK || size == 0) break;
+
+        // 앞선 출력이 기록되어 버퍼가 빌 때까지 기다리는 시간은 쓰기 단계에 넣는다
+        progressStage(meter, ADV_STAGE_WRITE);
+        unsigned char* out;
+        result = pipelineOutput(pipe, &out);
+        if (result != ADV_OK) break;
+        size_t count = (size + ADV_BLOCK_SIZE - 1) / ADV_BLOCK_SIZE;
+        for (size_t i = 0; i < count; i++) {
+            enc->input[i] = &data[i * ADV_BLOCK_SIZE];
+            enc->inputSize[i] = size - i * ADV_BLOCK_SIZE < ADV_BLOCK_SIZE ? size - i * ADV_BLOCK_SIZE : ADV_BLOCK_SIZE;
+            enc->output[i] = &out[i * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE)];
+        }
+
+        progressStage(meter, ADV_STAGE_CODEC);
+        if (enc->pool) {
+            runParallel(enc->pool, count, compressBlockTask, &batch);
+        } else {
+            for (size_t i = 0; i < count; i++) compressBlockTask(&batch, i);
+        }
+
+        // 블록 인덱스는 블록당 12바이트라 입력이 커져도 메모리 부담이 작다
+        if (enc->blockCount + count > enc->indexCapacity) {
+            enc->indexCapacity = (enc->blockCount + count) * 2;
+            uint64_t* newOffset = (uint64_t*)realloc(enc->frameOffset, enc->indexCapacity * sizeof(uint64_t));
+            if (newOffset) enc->frameOffset = newOffset;
+            uint32_t* newSize = (uint32_t*)realloc(enc->rawSize, enc->indexCapacity * sizeof(uint32_t));
+            if (newSize) enc->rawSize = newSize;
+            if (!newOffset || !newSize) {
+                result = ADV_ERR_NOMEM;
+                break;
+            }
+        }
+
+        // 블록 상한 간격으로 놓인 프레임을 앞으로 당겨 한 번에 기록한다
+        size_t outSize = 0;
+        for (size_t i = 0; i < count; i++) {
+            memmove(&out[outSize], enc->output[i], enc->outputSize[i]);
+            outSize += enc->outputSize[i];
+            enc->frameOffset[enc->blockCount] = enc->written;
+            enc->rawSize[enc->blockCount] = (uint32_t)enc->inputSize[i];
+            enc->blockCount++;
+            enc->written += enc->outputSize[i];
+            *checksum = crc32cCombine(*checksum, enc->checksum[i], enc->inputSize[i]);
+            *processed += enc->inputSize[i];
+            progressAdvance(meter, enc->inputSize[i], enc->outputSize[i], 1);
+        }
+        progressStage(meter, ADV_STAGE_WRITE);
+        result = pipelineWrite(pipe, outSize);
+    }
+    progressStage(meter, ADV_STAGE_WRITE);
+    return pipelineClose(pipe, result);
+}
+
+// 스트리밍 압축: [파일 헤더][블록 프레임]...[끝 프레임][블록 인덱스][트레일러]
+int encodeStream(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options, struct ProgressMeter* meter) {
+    struct FrameEncoder enc;
+    int result = frameEncoderInit(&enc, options);
+
+    unsigned char header[ADV_FILE_HEADER_SIZE];
+    writeFileHeader(header);
+    if (result == ADV_OK && fwrite(header, 1, sizeof(header), dest) != sizeof(header)) result = ADV_ERR_WRITE;
+    enc.written += ADV_FILE_HEADER_SIZE;
+    progressAdvance(meter, 0, ADV_FILE_HEADER_SIZE, 0);
+
+    uint32_t checksum = 0;
+    if (result == ADV_OK) result = encodeFrames(&enc, source, dest, processed, meter, &checksum);
+
+    progressStage(meter, ADV_STAGE_WRITE);
+    unsigned char end[ADV_END_FRAME_SIZE];
+    size_t endSize = writeEndFrame(end, checksum);
+    if (result == ADV_OK && fwrite(end, 1, endSize, dest) != endSize) result = ADV_ERR_WRITE;
+    enc.written += endSize;
+
+    // 끝 프레임 뒤에 블록 인덱스와 트레일러 기록
+    if (result == ADV_OK) {
+        size_t indexSize = enc.blockCount * ADV_INDEX_ENTRY_SIZE + ADV_INDEX_TRAILER_SIZE;
+        unsigned char* index = (unsigned char*)malloc(indexSize);
+        if (!index) {
+            result = ADV_ERR_NOMEM;
+        } else {
+            writeBlockIndex(index, enc.frameOffset, enc.rawSize, enc.blockCount, enc.written);
+            if (fwrite(index, 1, indexSize, dest) != indexSize) result = ADV_ERR_WRITE;
+            progressAdvance(meter, 0, endSize + indexSize, 0);
+            free(index);
+        }
+    }
+
+    frameEncoderFree(&enc);
+    return result;
+}
+
+int compressStream(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options) {
+    struct ProgressMeter meter;
+    progressStart(&meter, options, sourceSize(source));
+    int result = encodeStream(source, dest, processed, options, &meter);
+    progressFinish(&meter);
+    return result;
+}
+
+// 파일 끝의 트레일러와 블록 인덱스를 읽는다. 성공하면 ADV_OK를 돌려주고,
+// 인덱스가 없거나 탐색할 수 없는 입력이면 오류 코드를 돌려준다 (파일 위치는 첫 프레임으로 복귀).
+// v4이면 인덱스 바로 앞의 끝 프레임에서 원본 전체의 CRC32C도 읽는다.
+int readBlockIndex(int version, FILE* source, size_t* blockCount, uint64_t** frameOffset, uint32_t** rawSize, uint32_t* fileChecksum) {
+    unsigned char trailer[ADV_INDEX_TRAILER_SIZE];
+    unsigned char end[ADV_END_FRAME_SIZE];
+    size_t endSize = version >= ADV_FORMAT_CHECKSUM ? ADV_END_FRAME_SIZE : 1;
+    int result = ADV_ERR_FORMAT;
+    *frameOffset = NULL;
+    *rawSize = NULL;
+    *fileChecksum = 0;
+
+    if (fseek(source, 0, SEEK_END) != 0) return ADV_ERR_READ;
+    long fileSize = ftell(source);
+    if (fileSize < ADV_FILE_HEADER_SIZE + 1 + ADV_INDEX_TRAILER_SIZE ||
+        fseek(source, -ADV_INDEX_TRAILER_SIZE, SEEK_END) != 0 ||
+        fread(trailer, 1, sizeof(trailer), source) != sizeof(trailer) ||
+        memcmp(&trailer[12], ADV_INDEX_MAGIC, 4) != 0) {
+        fseek(source, ADV_FILE_HEADER_SIZE, SEEK_SET);
+        return ADV_ERR_FORMAT;
+    }
+
+    uint64_t indexOffset = getLE64(trailer);
+    size_t count = getLE32(&trailer[8]);
+    if (indexOffset < ADV_FILE_HEADER_SIZE + endSize ||
+        indexOffset + (uint64_t)count * ADV_INDEX_ENTRY_SIZE + ADV_INDEX_TRAILER_SIZE != (uint64_t)fileSize ||
+        fseek(source, (long)(indexOffset - endSize), SEEK_SET) != 0 ||
+        fread(end, 1, endSize, source) != endSize || end[0] != ADV_BLOCK_END) {
+        fseek(source, ADV_FILE_HEADER_SIZE, SEEK_SET);
+        return ADV_ERR_FORMAT;
+    }
+    if (endSize == ADV_END_FRAME_SIZE) *fileChecksum = getLE32(&end[1]);
+
+    unsigned char* entries = (unsigned char*)malloc(count * ADV_INDEX_ENTRY_SIZE + 1);
+    uint64_t* offsets = (uint64_t*)malloc((count + 1) * sizeof(uint64_t));
+    uint32_t* sizes = (uint32_t*)malloc((count + 1) * sizeof(uint32_t));
+    if (!entries || !offsets || !sizes) {
+        result = ADV_ERR_NOMEM;
+    } else if (fseek(source, (long)indexOffset, SEEK_SET) == 0 &&
+               fread(entries, 1, count * ADV_INDEX_ENTRY_SIZE, source) == count * ADV_INDEX_ENTRY_SIZE) {
+        // 프레임은 헤더 뒤부터 끝 프레임 앞까지 차례로 놓여 있어야 한다
+        uint64_t minOffset = ADV_FILE_HEADER_SIZE;
+        result = ADV_OK;
+        for (size_t i = 0; i < count; i++) {
+            offsets[i] = getLE64(&entries[i * ADV_INDEX_ENTRY_SIZE]);
+            sizes[i] = getLE32(&entries[i * ADV_INDEX_ENTRY_SIZE + 8]);
+            if (offsets[i] < minOffset || offsets[i] + ADV_BLOCK_HEADER_SIZE + endSize > indexOffset || sizes[i] > ADV_BLOCK_SIZE) {
+                result = ADV_ERR_FORMAT;
+                break;
+            }
+            minOffset = offsets[i] + ADV_BLOCK_HEADER_SIZE;
+        }
+    }
+    free(entries);
+    fseek(source, ADV_FILE_HEADER_SIZE, SEEK_SET);
+
+    if (result != ADV_OK) {
+        free(offsets);
+        free(sizes);
+        return result;
+    }
+    *blockCount = count;
+    *frameOffset = offsets;
+    *rawSize = sizes;
+    return ADV_OK;
+}
+
+#ifndef _WIN32
+// 출력이 처음 위치에 있는 일반 파일이라 오프셋 지정 쓰기와 크기 조정이 가능한지 확인한다.
+// O_APPEND로 열린 출력(셸의 >>)은 ftell이 0이어도 기존 내용 뒤에 이어 써야 하므로 스트리밍 경로로 보낸다.
+int isPositionalOutput(FILE* dest) {
+    struct stat st;
+    int fd = fileno(dest);
+    if (fflush(dest) != 0 || fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || ftell(dest) != 0) return 0;
+    int flags = fcntl(fd, F_GETFL);
+    return flags != -1 && (flags & O_APPEND) == 0;
+}
+
+// 지정한 오프셋에서 정확히 size 바이트를 읽는다 (파일이 먼저 끝나면 형식 오류)
+int readAt(int fd, unsigned char* buf, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = pread(fd, buf, size, (off_t)offset);
+        if (n < 0) return ADV_ERR_READ;
+        if (n == 0) return ADV_ERR_FORMAT;
+        buf += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return ADV_OK;
+}
+
+int writeAt(int fd, const unsigned char* buf, size_t size, uint64_t offset) {
+    while (size > 0) {
+        ssize_t n = pwrite(fd, buf, size, (off_t)offset);
+        if (n <= 0) return ADV_ERR_WRITE;
+        buf += n;
+        size -= (size_t)n;
+        offset += (uint64_t)n;
+    }
+    return ADV_OK;
+}
+
+// 인덱스 기반 병렬 해제 배치: 작업 i는 블록 first + i를 슬롯 i에서 처리한다
+struct IndexedBatch {
+    int version;
+    int sourceFd;
+    int destFd;
+    const uint64_t* frameOffset;
+    const uint32_t* rawSize;
+    const uint64_t* rawOffset;
+    size_t first;
+    unsigned char* inSlots;
+    unsigned char* outSlots;
+    int* result;
+    size_t* frameBytes;
+    uint32_t* checksum;
+};
+
+void decompressIndexedTask(void* ctx, size_t index) {
+    struct IndexedBatch* batch = (struct IndexedBatch*)ctx;
+    size_t block = batch->first + index;
+    unsigned char* in = &batch->inSlots[index * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE)];
+    unsigned char* out = &batch->outSlots[index * ADV_BLOCK_SIZE];
+    unsigned char header[ADV_BLOCK_HEADER_SIZE];
+
+    int result = readAt(batch->sourceFd, header, sizeof(header), batch->frameOffset[block]);
+    size_t rawSize = getLE32(&header[1]);
+    size_t payloadSize = getLE32(&header[5]);
+    if (result == ADV_OK && (header[0] == ADV_BLOCK_END || rawSize != batch->rawSize[block] ||
+                             payloadSize > ADV_BLOCK_BOUND(ADV_BLOCK_SIZE) - ADV_BLOCK_HEADER_SIZE)) {
+        result = ADV_ERR_FORMAT;
+    }
+    if (result == ADV_OK) result = readAt(batch->sourceFd, in, payloadSize, batch->frameOffset[block] + ADV_BLOCK_HEADER_SIZE);
+    if (result == ADV_OK) result = decodeBlock(batch->version, header[0], in, payloadSize, out, rawSize, &batch->checksum[index]);
+    if (result == ADV_OK && batch->destFd >= 0) result = writeAt(batch->destFd, out, rawSize, batch->rawOffset[block]);
+    batch->result[index] = result;
+    batch->frameBytes[index] = ADV_BLOCK_HEADER_SIZE + payloadSize;
+}
+
+// 인덱스 기반 병렬 해제: 출력 파일을 원본 크기로 먼저 잡아 두고
+// 워커들이 블록을 각자 읽고 복원해 최종 오프셋에 바로 기록한다.
+// 블록 CRC32C는 순서대로 이어 붙여 fileChecksum과 대조하며 (v4), dest가 NULL이면 검사만 한다.
+// 배치마다 취소를 확인한다.
+int decompressIndexed(int version, FILE* source, FILE* dest, size_t blockCount, const uint64_t* frameOffset, const uint32_t* rawSize, uint32_t fileChecksum, long* processed, struct ProgressMeter* meter) {
+    int threadCount = getCpuCount();
+    size_t batchSize = (size_t)threadCount * ADV_BLOCKS_PER_WORKER;
+    uint64_t* rawOffset = (uint64_t*)malloc((blockCount + 1) * sizeof(uint64_t));
+    unsigned char* inSlots = (unsigned char*)malloc(batchSize * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE));
+    unsigned char* outSlots = (unsigned char*)malloc(batchSize * ADV_BLOCK_SIZE);
+    int* blockResult = (int*)malloc(batchSize * sizeof(int));
+    size_t* frameBytes = (size_t*)malloc(batchSize * sizeof(size_t));
+    uint32_t* checksum = (uint32_t*)malloc(batchSize * sizeof(uint32_t));
+    int result = ADV_OK;
+    if (!rawOffset || !inSlots || !outSlots || !blockResult || !frameBytes || !checksum) {
+        result = ADV_ERR_NOMEM;
+    }
+
+    uint64_t total = 0;
+    for (size_t i = 0; result == ADV_OK && i < blockCount; i++) {
+        rawOffset[i] = total;
+        total += rawSize[i];
+    }
+    if (result == ADV_OK && dest && (fflush(dest) != 0 || ftruncate(fileno(dest), (off_t)total) != 0)) {
+        result = ADV_ERR_WRITE;
+    }
+
+    struct WorkerPool* pool = result == ADV_OK && blockCount > 1 && threadCount > 1 ? createWorkerPool(threadCount) : NULL;
+    struct IndexedBatch batch = { version, fileno(source), dest ? fileno(dest) : -1, frameOffset, rawSize, rawOffset, 0,
+                                  inSlots, outSlots, blockResult, frameBytes, checksum };
+    uint32_t combined = 0;
+    // 워커가 읽기와 쓰기까지 맡으므로 전체를 코덱 단계로 센다
+    progressStage(meter, ADV_STAGE_CODEC);
+    for (size_t first = 0; result == ADV_OK && first < blockCount; first += batchSize) {
+        if (progressCancelled(meter)) {
+            result = ADV_ERR_CANCELLED;
+            break;
+        }
+        size_t count = blockCount - first < batchSize ? blockCount - first : batchSize;
+        batch.first = first;
+        if (pool) {
+            runParallel(pool, count, decompressIndexedTask, &batch);
+        } else {
+            for (size_t i = 0; i < count; i++) decompressIndexedTask(&batch, i);
+        }
+        for (size_t i = 0; i < count && result == ADV_OK; i++) {
+            result = blockResult[i];
+            combined = crc32cCombine(combined, checksum[i], rawSize[first + i]);
+            *processed += frameBytes[i];
+            progressAdvance(meter, frameBytes[i], rawSize[first + i], 1);
+        }
+    }
+    if (result == ADV_OK && version >= ADV_FORMAT_CHECKSUM && combined != fileChecksum) result = ADV_ERR_CHECKSUM;
+
+    destroyWorkerPool(pool);
+    free(rawOffset);
+    free(inSlots);
+    free(outSlots);
+    free(blockResult);
+    free(frameBytes);
+    free(checksum);
+    return result;
+}
+#endif
+
+// 이전 형식(v0, v1) 스트림 해제: 원본 크기가 기록되어 있지 않아
+// 이미 읽은 헤더 바이트와 나머지 입력 전체를 메모리에 모아 한 번에 해제한다
+int decompressWholeStream(FILE* source, FILE* dest, const unsigned char* head, size_t headSize, long* processed, struct ProgressMeter* meter) {
+    size_t capacity = CHUNK;
+    size_t size = headSize;
+    unsigned char* data = (unsigned char*)malloc(capacity);
+    if (!data) return ADV_ERR_NOMEM;
+    memcpy(data, head, headSize);
+    for (;;) {
+        if (size == capacity) {
+            unsigned char* grown = (unsigned char*)realloc(data, capacity * 2);
+            if (!grown) {
+                free(data);
+                return ADV_ERR_NOMEM;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+        size_t n = fread(&data[size], 1, capacity - size, source);
+        if (n == 0) break;
+        size += n;
+    }
+    if (ferror(source)) {
+        free(data);
+        return ADV_ERR_READ;
+    }
+
+    progressStage(meter, ADV_STAGE_CODEC);
+    unsigned char* decompressed = NULL;
+    size_t decompressedSize = 0;
+    int result = advancedDecompression(data, size, &decompressed, &decompressedSize);
+    free(data);
+    progressStage(meter, ADV_STAGE_WRITE);
+    if (result == ADV_OK && dest && decompressedSize > 0 && fwrite(decompressed, 1, decompressedSize, dest) != decompressedSize) {
+        result = ADV_ERR_WRITE;
+    }
+    if (result == ADV_OK) {
+        *processed += (long)size;
+        progressAdvance(meter, size, decompressedSize, 0);
+    }
+    free(decompressed);
+    return result;
+}
+
+// 프레임 헤더를 차례로 읽어 블록 단위로 복원해 바로 기록한다. 끝 프레임을 만나거나
+// blockLimit개를 복원하면 멈추며, 한도를 채우기 전에 끝 프레임이 오면 손상으로 본다.
+// 입력은 파이프라인이 readLimit 바이트까지 미리 읽어 두고, 완성된 프레임을 워커 수만큼 모아
+// 병렬로 복원한 뒤 파이프라인이 기록하는 동안 다음 배치를 모은다.
+// 블록 CRC32C를 이어 붙여 checksum에 돌려주고, v4 파일의 끝 프레임에 기록된 값과도 대조한다.
+// dest가 NULL이면 기록하지 않고 검사만 한다.
+int decodeSequential(int version, FILE* source, FILE* dest, size_t blockLimit, uint64_t readLimit, long* processed, struct ProgressMeter* meter, uint32_t* checksum) {
+    int threadCount = getCpuCount();
+    size_t batchSize = (size_t)threadCount * ADV_BLOCKS_PER_WORKER;
+    size_t chunkSize = batchSize * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE);
+    // 모아 둔 입력: 배치를 다 채우지 못한 프레임들과 읽다 만 프레임 뒤에 읽은 입력을 하나 더 붙일 수 있는 크기
+    unsigned char* stage = (unsigned char*)malloc(2 * chunkSize);
+    size_t* frameOffset = (size_t*)malloc(batchSize * sizeof(size_t));
+    size_t* rawOffset = (size_t*)malloc(batchSize * sizeof(size_t));
+    int* blockResult = (int*)malloc(batchSize * sizeof(int));
+    uint32_t* blockChecksum = (uint32_t*)malloc(batchSize * sizeof(uint32_t));
+    struct IoPipeline* pipe = pipelineCreate(source, chunkSize, readLimit, dest, batchSize * ADV_BLOCK_SIZE,
+                                             readLimit > chunkSize && !fitsInBuffer(source, chunkSize), 1);
+    int result = ADV_OK;
+    if (!stage || !frameOffset || !rawOffset || !blockResult || !blockChecksum || !pipe) result = ADV_ERR_NOMEM;
+
+    struct WorkerPool* pool = NULL;
+    struct FrameBatch batch = { version, 0, stage, frameOffset, rawOffset, NULL, blockResult, blockChecksum };
+    size_t stageSize = 0;
+    size_t stagePos = 0; // 아직 복원하지 않은 첫 프레임의 위치
+    int inputEnd = 0;
+    uint32_t combined = 0;
+    size_t block = 0;
+    while (result == ADV_OK) {
+        if (progressCancelled(meter)) {
+            result = ADV_ERR_CANCELLED;
+            break;
+        }
+        // 모아 둔 입력에서 완성된 프레임을 배치 크기까지 찾는다
+        size_t count = 0;
+        size_t pos = stagePos;
+        size_t rawTotal = 0;
+        int ended = 0;    // 끝 프레임(v4이면 파일 CRC32C까지)을 모두 읽음
+        int partial = 0;  // 프레임이 잘려 입력이 더 필요함
+        while (count < batchSize && block + count < blockLimit) {
+            size_t avail = stageSize - pos;
+            if (avail < 1) {
+                partial = 1;
+                break;
+            }
+            if (stage[pos] == ADV_BLOCK_END) {
+                // 아카이브 항목은 blockLimit으로 끝나므로 끝 프레임을 만나는 것은 단일 파일뿐이다
+                size_t endSize = version >= ADV_FORMAT_CHECKSUM ? ADV_END_FRAME_SIZE : 1;
+                if (blockLimit != SIZE_MAX) {
+                    result = ADV_ERR_FORMAT;
+                } else if (avail < endSize) {
+                    partial = 1;
+                } else {
+                    ended = 1;
+                }
+                break;
+            }
+            if (avail < ADV_BLOCK_HEADER_SIZE) {
+                partial = 1;
+                break;
+            }
+            size_t rawSize = getLE32(&stage[pos + 1]);
+            size_t payloadSize = getLE32(&stage[pos + 5]);
+            // 블록 크기 상한을 넘는 프레임은 손상된 것으로 보고 메모리를 고정된 크기로 유지한다
+            if (rawSize > ADV_BLOCK_SIZE || payloadSize > ADV_BLOCK_BOUND(ADV_BLOCK_SIZE) - ADV_BLOCK_HEADER_SIZE) {
+                result = ADV_ERR_FORMAT;
+                break;
+            }
+            if (avail - ADV_BLOCK_HEADER_SIZE < payloadSize) {
+                partial = 1;
+                break;
+            }
+            frameOffset[count] = pos;
+            rawOffset[count] = rawTotal;
+            rawTotal += rawSize;
+            pos += ADV_BLOCK_HEADER_SIZE + payloadSize;
+            count++;
+        }
+        if (result != ADV_OK) break;
+
+        // 배치가 차지 않았는데 입력이 남아 있으면 더 읽어 모은 뒤 다시 찾는다
+        if (partial && count < batchSize && !inputEnd) {
+            progressStage(meter, ADV_STAGE_READ);
+            const unsigned char* data;
+            size_t size;
+            result = pipelineRead(pipe, &data, &size);
+            if (result != ADV_OK) break;
+            if (size == 0) {
+                inputEnd = 1;
+                continue;
+            }
+            memmove(stage, &stage[stagePos], stageSize - stagePos);
+            stageSize -= stagePos;
+            stagePos = 0;
+            memcpy(&stage[stageSize], data, size);
+            stageSize += size;
+            continue;
+        }
+
+        if (count > 0) {
+            progressStage(meter, ADV_STAGE_WRITE);
+            unsigned char* out;
+            result = pipelineOutput(pipe, &out);
+            if (result != ADV_OK) break;
+            batch.output = out;
+            progressStage(meter, ADV_STAGE_CODEC);
+            if (count > 1 && threadCount > 1 && !pool) pool = createWorkerPool(threadCount);
+            if (pool && count > 1) {
+                runParallel(pool, count, decompressFrameTask, &batch);
+            } else {
+                for (size_t i = 0; i < count; i++) decompressFrameTask(&batch, i);
+            }
+            // 손상된 블록 앞까지만 기록한다
+            size_t outSize = 0;
+            for (size_t i = 0; i < count; i++) {
+                const unsigned char* frame = &stage[frameOffset[i]];
+                size_t rawSize = getLE32(&frame[1]);
+                size_t frameSize = ADV_BLOCK_HEADER_SIZE + getLE32(&frame[5]);
+                result = blockResult[i];
+                if (result != ADV_OK) break;
+                combined = crc32cCombine(combined, blockChecksum[i], rawSize);
+                outSize += rawSize;
+                *processed += frameSize;
+                progressAdvance(meter, frameSize, rawSize, 1);
+            }
+            progressStage(meter, ADV_STAGE_WRITE);
+            int writeResult = pipelineWrite(pipe, outSize);
+            if (result == ADV_OK) result = writeResult;
+            if (result != ADV_OK) break;
+            block += count;
+            stagePos = pos;
+        }
+
+        if (ended) {
+            if (version >= ADV_FORMAT_CHECKSUM && getLE32(&stage[pos + 1]) != combined) result = ADV_ERR_CHECKSUM;
+            break;
+        }
+        if (block == blockLimit) break;
+        if (count == 0 && partial) {
+            result = ADV_ERR_FORMAT; // 끝 프레임 없이 잘린 파일
+            break;
+        }
+    }
+
+    progressStage(meter, ADV_STAGE_WRITE);
+    if (pipe) result = pipelineClose(pipe, result);
+    if (checksum) *checksum = combined;
+    destroyWorkerPool(pool);
+    free(stage);
+    free(frameOffset);
+    free(rawOffset);
+    free(blockResult);
+    free(blockChecksum);
+    return result;
+}
+
+// 스트리밍 해제: v2 이상은 인덱스가 있으면 병렬로, 없으면 프레임 헤더를 차례로 읽어
+// 블록 단위로 복원해 바로 기록한다. 이전 형식은 전체를 읽어 해제한다.
+int decodeStream(FILE* source, FILE* dest, long* processed, struct ProgressMeter* meter) {
+    unsigned char header[ADV_BLOCK_HEADER_SIZE];
+    size_t got;
+    if (readSourceHead(source, header, ADV_FILE_HEADER_SIZE, &got) != ADV_OK) return ADV_ERR_READ;
+    if (got != ADV_FILE_HEADER_SIZE || memcmp(header, ADV_MAGIC, ADV_MAGIC_SIZE) != 0 || !isFramedVersion(header[ADV_MAGIC_SIZE])) {
+        return decompressWholeStream(source, dest, header, got, processed, meter);
+    }
+    if (header[ADV_MAGIC_SIZE + 1] & ADV_FLAG_ARCHIVE) return ADV_ERR_ARCHIVE;
+    *processed += ADV_FILE_HEADER_SIZE;
+    progressAdvance(meter, ADV_FILE_HEADER_SIZE, 0, 0);
+    int version = header[ADV_MAGIC_SIZE];
+
+#ifndef _WIN32
+    // 인덱스가 있고 입력은 탐색 가능, 출력은 일반 파일(또는 검사만 할 때)이면 블록을 병렬로 해제한다
+    if ((header[ADV_MAGIC_SIZE + 1] & ADV_FLAG_INDEX) && (dest == NULL || isPositionalOutput(dest))) {
+        size_t blockCount;
+        uint64_t* frameOffset;
+        uint32_t* rawSize;
+        uint32_t fileChecksum;
+        if (readBlockIndex(version, source, &blockCount, &frameOffset, &rawSize, &fileChecksum) == ADV_OK) {
+            int result = decompressIndexed(version, source, dest, blockCount, frameOffset, rawSize, fileChecksum, processed, meter);
+            free(frameOffset);
+            free(rawSize);
+            return result;
+        }
+    }
+#endif
+
+    return decodeSequential(version, source, dest, SIZE_MAX, UINT64_MAX, processed, meter, NULL);
+}
+
+int decompressStream(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options) {
+    struct ProgressMeter meter;
+    progressStart(&meter, options, sourceSize(source));
+    int result = decodeStream(source, dest, processed, &meter);
+    progressFinish(&meter);
+    return result;
+}
+
+#ifndef _WIN32
+// 매핑 압축: 원본 파일을 mmap하여 매핑 위에서 바로 블록을 인코딩한다 (읽기 버퍼 복사 없음).
+// 다음 배치의 원본은 미리 읽어 두도록 커널에 알리고, 프레임은 파이프라인이 코덱과 겹쳐 기록한다.
+// 출력 파일은 최대 크기로 미리 공간을 잡아 두고 다 쓴 뒤 실제 크기로 자른다.
+int compressMapped(FILE* source, FILE* dest, size_t size, long* processed, const struct AdvOptions* options, struct ProgressMeter* meter) {
+    int sourceFd = fileno(source);
+    int destFd = fileno(dest);
+    if (!isPositionalOutput(dest)) return ADV_ERR_UNSUPPORTED;
+    const unsigned char* data = (const unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, sourceFd, 0);
+    if (data == MAP_FAILED) return ADV_ERR_UNSUPPORTED;
+    madvise((void*)data, size, MADV_SEQUENTIAL);
+
+    size_t blockCount = (size + ADV_BLOCK_SIZE - 1) / ADV_BLOCK_SIZE;
+    size_t bound = ADV_FILE_HEADER_SIZE + blockCount * (ADV_BLOCK_BOUND(0) + ADV_INDEX_ENTRY_SIZE) + size + size / 8 + ADV_END_FRAME_SIZE + ADV_INDEX_TRAILER_SIZE;
+    int threadCount = getCpuCount();
+    size_t batchSize = (size_t)threadCount * ADV_BLOCKS_PER_WORKER;
+    const unsigned char** input = (const unsigned char**)calloc(batchSize, sizeof(unsigned char*));
+    unsigned char** output = (unsigned char**)calloc(batchSize, sizeof(unsigned char*));
+    size_t* inputSize = (size_t*)calloc(batchSize, sizeof(size_t));
+    size_t* outputSize = (size_t*)calloc(batchSize, sizeof(size_t));
+    uint32_t* checksum = (uint32_t*)calloc(batchSize, sizeof(uint32_t));
+    unsigned char* index = (unsigned char*)malloc(blockCount * ADV_INDEX_ENTRY_SIZE + ADV_INDEX_TRAILER_SIZE);
+    uint64_t* frameOffset = (uint64_t*)malloc((blockCount + 1) * sizeof(uint64_t));
+    uint32_t* rawSize = (uint32_t*)malloc((blockCount + 1) * sizeof(uint32_t));
+    int result = ADV_OK;
+    if (!input || !output || !inputSize || !outputSize || !checksum || !index || !frameOffset || !rawSize) {
+        result = ADV_ERR_NOMEM;
+    }
+
+    // 공간 예약이 지원되지 않는 파일 시스템이면 그냥 이어서 기록한다
+    if (result == ADV_OK && fflush(dest) != 0) result = ADV_ERR_WRITE;
+    if (result == ADV_OK) posix_fallocate(destFd, 0, (off_t)bound);
+
+    // 파일 헤더는 첫 배치의 출력 앞에 붙여 함께 기록한다
+    struct IoPipeline* pipe = NULL;
+    if (result == ADV_OK) {
+        pipe = pipelineCreate(NULL, 0, 0, dest, ADV_FILE_HEADER_SIZE + batchSize * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE), blockCount > batchSize, 0);
+        if (!pipe) result = ADV_ERR_NOMEM;
+    }
+    uint64_t written = 0;
+
+    struct WorkerPool* pool = result == ADV_OK && blockCount > 1 && threadCount > 1 ? createWorkerPool(threadCount) : NULL;
+    struct AdvOptions resolved;
+    resolveOptions(options, &resolved);
+    struct BlockBatch batch = { input, inputSize, output, outputSize, checksum, &resolved };
+    uint32_t fileChecksum = 0;
+    for (size_t first = 0; result == ADV_OK && first < blockCount; first += batchSize) {
+        if (progressCancelled(meter)) {
+            result = ADV_ERR_CANCELLED;
+            break;
+        }
+        size_t count = blockCount - first < batchSize ? blockCount - first : batchSize;
+        size_t start = first * ADV_BLOCK_SIZE;
+        size_t end = start + count * ADV_BLOCK_SIZE < size ? start + count * ADV_BLOCK_SIZE : size;
+        if (end < size) {
+            size_t ahead = size - end < count * ADV_BLOCK_SIZE ? size - end : count * ADV_BLOCK_SIZE;
+            madvise((void*)&data[end], ahead, MADV_WILLNEED);
+        }
+
+        progressStage(meter, ADV_STAGE_WRITE);
+        unsigned char* out;
+        result = pipelineOutput(pipe, &out);
+        if (result != ADV_OK) break;
+        size_t outSize = 0;
+        if (first == 0) {
+            writeFileHeader(out);
+            outSize = ADV_FILE_HEADER_SIZE;
+            written = ADV_FILE_HEADER_SIZE;
+            progressAdvance(meter, 0, ADV_FILE_HEADER_SIZE, 0);
+        }
+        for (size_t i = 0; i < count; i++) {
+            size_t pos = (first + i) * ADV_BLOCK_SIZE;
+            input[i] = &data[pos];
+            inputSize[i] = size - pos < ADV_BLOCK_SIZE ? size - pos : ADV_BLOCK_SIZE;
+            output[i] = &out[outSize + i * ADV_BLOCK_BOUND(ADV_BLOCK_SIZE)];
+        }
+        // 원본 읽기는 매핑의 페이지 폴트로 일어나므로 코덱 단계에 들어간다
+        progressStage(meter, ADV_STAGE_CODEC);
+        if (pool) {
+            runParallel(pool, count, compressBlockTask, &batch);
+        } else {
+            for (size_t i = 0; i < count; i++) compressBlockTask(&batch, i);
+        }
+        for (size_t i = 0; i < count; i++) {
+            memmove(&out[outSize], output[i], outputSize[i]);
+            outSize += outputSize[i];
+            frameOffset[first + i] = written;
+            rawSize[first + i] = (uint32_t)inputSize[i];
+            written += outputSize[i];
+            fileChecksum = crc32cCombine(fileChecksum, checksum[i], inputSize[i]);
+            *processed += inputSize[i];
+            progressAdvance(meter, inputSize[i], outputSize[i], 1);
+        }
+        progressStage(meter, ADV_STAGE_WRITE);
+        result = pipelineWrite(pipe, outSize);
+        // 처리가 끝난 원본 구간은 매핑에서 먼저 내려 상주 메모리를 배치 크기로 유지한다
+        madvise((void*)&data[start], end - start, MADV_DONTNEED);
+    }
+    progressStage(meter, ADV_STAGE_WRITE);
+    if (pipe) result = pipelineClose(pipe, result);
+    // 스레드 경로는 FILE로 기록하므로 오프셋 지정 쓰기 전에 버퍼를 비운다
+    if (result == ADV_OK && fflush(dest) != 0) result = ADV_ERR_WRITE;
+
+    unsigned char end[ADV_END_FRAME_SIZE];
+    size_t endSize = writeEndFrame(end, fileChecksum);
+    if (result == ADV_OK) {
+        result = writeAt(destFd, end, endSize, written);
+        written += endSize;
+    }
+    if (result == ADV_OK) {
+        size_t indexSize = writeBlockIndex(index, frameOffset, rawSize, blockCount, written);
+        result = writeAt(destFd, index, indexSize, written);
+        written += indexSize;
+        progressAdvance(meter, 0, endSize + indexSize, 0);
+    }
+    if (result == ADV_OK && ftruncate(destFd, (off_t)written) != 0) result = ADV_ERR_WRITE;
+
+    destroyWorkerPool(pool);
+    munmap((void*)data, size);
+    free(input);
+    free(output);
+    free(inputSize);
+    free(outputSize);
+    free(checksum);
+    free(index);
+    free(frameOffset);
+    free(rawSize);
+    return result;
+}
+
+// 매핑 해제: 압축 파일을 mmap하여 페이로드를 제자리에서 읽고,
+// 원본 크기로 잡아 둔 출력 파일 매핑에 블록을 바로 복원한다 (중간 버퍼 없음)
+int decompressMapped(FILE* source, FILE* dest, size_t size, long* processed, struct ProgressMeter* meter) {
+    int destFd = fileno(dest);
+    if (!isPositionalOutput(dest)) return ADV_ERR_UNSUPPORTED;
+    const unsigned char* data = (const unsigned char*)mmap(NULL, size, PROT_READ, MAP_PRIVATE, fileno(source), 0);
+    if (data == MAP_FAILED) return ADV_ERR_UNSUPPORTED;
+
+    // 이전 형식은 블록 위치를 알 수 없으므로 스트림 경로에서 처리한다
+    if (memcmp(data, ADV_MAGIC, ADV_MAGIC_SIZE) != 0 || !isFramedVersion(data[ADV_MAGIC_SIZE])) {
+        munmap((void*)data, size);
+        return ADV_ERR_UNSUPPORTED;
+    }
+    if (data[ADV_MAGIC_SIZE + 1] & ADV_FLAG_ARCHIVE) {
+        munmap((void*)data, size);
+        return ADV_ERR_ARCHIVE;
+    }
+
+    size_t blockCount, total;
+    size_t* frameOffset = NULL;
+    size_t* rawOffset = NULL;
+    uint32_t fileChecksum;
+    int result = scanFrames(data, size, &blockCount, &frameOffset, &rawOffset, &total, &fileChecksum);
+    if (result == ADV_OK && (fflush(dest) != 0 || ftruncate(destFd, (off_t)total) != 0)) {
+        result = ADV_ERR_WRITE;
+    }
+    // 공유 매핑으로 쓰다 공간이 모자라면 SIGBUS로 죽으므로 매핑 전에 공간을 실제로 확보한다.
+    // 파일 시스템이 예약을 지원하지 않으면 쓰기 오류를 받을 수 있는 스트리밍 경로에 맡긴다.
+    if (result == ADV_OK && total > 0) {
+        int reserve = posix_fallocate(destFd, 0, (off_t)total);
+        if (reserve == EINVAL || reserve == EOPNOTSUPP) result = ADV_ERR_UNSUPPORTED;
+        else if (reserve != 0) result = ADV_ERR_WRITE;
+    }
+    if (result == ADV_OK && total > 0) {
+        // 쓰기 전용으로 열린 출력은 공유 매핑이 안 되므로 스트리밍 경로에 맡긴다
+        unsigned char* out = (unsigned char*)mmap(NULL, total, PROT_READ | PROT_WRITE, MAP_SHARED, destFd, 0);
+        if (out == MAP_FAILED) {
+            result = ADV_ERR_UNSUPPORTED;
+        } else {
+            progressStage(meter, ADV_STAGE_CODEC);
+            result = decodeFrames(data[ADV_MAGIC_SIZE], data, blockCount, frameOffset, rawOffset, out, meter, fileChecksum);
+            progressStage(meter, ADV_STAGE_WRITE);
+            if (munmap(out, total) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+        }
+    } else if (result == ADV_OK && fileChecksum != 0) {
+        result = ADV_ERR_CHECKSUM; // 빈 원본의 CRC32C는 0
+    }
+    if (result == ADV_OK) {
+        *processed += (long)size;
+        // 파일 헤더와 끝 프레임, 인덱스 몫
+        progressAdvance(meter, (long long)size - meter->state.inputBytes, 0, 0);
+    }
+
+    munmap((void*)data, size);
+    free(frameOffset);
+    free(rawOffset);
+    return result;
+}
+#endif
+
+// 파일 압축: 일반 파일이면 매핑 경로로, 그 외(파이프, 매핑 실패, Windows)는 스트리밍 경로로 처리
+int compressFile(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options) {
+    struct ProgressMeter meter;
+    progressStart(&meter, options, sourceSize(source));
+    int result = ADV_ERR_UNSUPPORTED;
+#ifndef _WIN32
+    struct stat st;
+    if (fstat(fileno(source), &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        result = compressMapped(source, dest, (size_t)st.st_size, processed, options, &meter);
+    }
+#endif
+    if (result == ADV_ERR_UNSUPPORTED) result = encodeStream(source, dest, processed, options, &meter);
+    progressFinish(&meter);
+    return result;
+}
+
+// 파일 해제: 일반 파일의 v2 이상 형식은 매핑 경로로, 나머지는 스트림 경로로 처리.
+// dest가 NULL이면 기록 없이 블록과 파일 체크섬만 검사한다 (메모리를 배치 크기로 유지하는 스트림 경로).
+int decompressFile(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options) {
+    struct ProgressMeter meter;
+    progressStart(&meter, options, sourceSize(source));
+    int result = ADV_ERR_UNSUPPORTED;
+#ifndef _WIN32
+    struct stat st;
+    if (dest && fstat(fileno(source), &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= ADV_FILE_HEADER_SIZE + 1) {
+        result = decompressMapped(source, dest, (size_t)st.st_size, processed, &meter);
+    }
+#endif
+    if (result == ADV_ERR_UNSUPPORTED) result = decodeStream(source, dest, processed, &meter);
+    progressFinish(&meter);
+    return result;
+}
+
+// 코덱 결과 코드에 대한 로그 메시지
+const char* advErrorMessage(int result) {
+    switch (result) {
+        case ADV_ERR_READ: return "파일 읽기 오류";
+        case ADV_ERR_WRITE: return "파일 쓰기 오류";
+        case ADV_ERR_FORMAT: return "손상되었거나 지원하지 않는 압축 파일입니다.";
+        case ADV_ERR_NOMEM: return "메모리 할당 실패";
+        case ADV_ERR_UNSUPPORTED: return "지원하지 않는 입력입니다.";
+        case ADV_ERR_CHECKSUM: return "체크섬이 맞지 않습니다 (데이터 손상).";
+        case ADV_ERR_ARCHIVE: return "여러 파일을 담은 아카이브입니다.";
+        case ADV_ERR_DICTIONARY: return "사전을 찾을 수 없거나 같은 ID의 다른 사전이 있습니다.";
+        case ADV_ERR_CANCELLED: return "작업이 취소되었습니다.";
+        default: return "알 수 없는 오류";
+    }
+}
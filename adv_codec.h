@@ -0,0 +1,181 @@
+#ifndef ADV_CODEC_H
+#define ADV_CODEC_H
+
+// .adv 압축 코덱 라이브러리 공개 API
+// GUI(file_compressor.c)와 명령행 도구(adv_cli.c)가 함께 사용한다.
+
+#include <stdio.h>
+#include <stddef.h>
+
+// 코덱 함수의 결과 코드
+enum {
+    ADV_OK = 0,
+    ADV_ERR_READ,
+    ADV_ERR_WRITE,
+    ADV_ERR_FORMAT,
+    ADV_ERR_NOMEM,
+    ADV_ERR_UNSUPPORTED, // 이 입력에는 쓸 수 없는 처리 경로 (다른 경로로 대체)
+    ADV_ERR_CHECKSUM,    // 복원한 데이터의 체크섬이 기록된 값과 다름
+    ADV_ERR_ARCHIVE,     // 아카이브를 단일 파일 해제 함수에 넘김 (advArchive 함수로 처리)
+    ADV_ERR_DICTIONARY,  // 사전 ID가 캐시에 없거나 같은 ID로 다른 사전을 등록함
+    ADV_ERR_CANCELLED    // AdvOptions.cancel이 설정되어 작업을 멈춤 (출력은 중간까지만 기록됨)
+};
+
+// 하프만 코드 길이 상한의 범위와 기본값. 상한이 디코딩 테이블 크기(11비트) 이하이면
+// 모든 코드가 테이블 한 번 조회로 풀린다.
+#define ADV_CODE_LIMIT_MIN 8
+#define ADV_CODE_LIMIT_MAX 15
+#define ADV_CODE_LIMIT_DEFAULT 11
+
+// 압축 강도. 0은 일치 탐색 없이 엔트로피 부호화(하프만, tANS, 문맥 하프만 중 가장 작은 것)만 쓰고,
+// 1~9는 LZ77 일치 탐색을 점점 깊게 한다.
+#define ADV_LEVEL_MIN 0
+#define ADV_LEVEL_MAX 9
+#define ADV_LEVEL_DEFAULT 5
+
+// 진행 보고 단계. 단계별 시간은 작업 루프가 그 단계에 머문 벽시계 시간의 합이다.
+// 읽기/쓰기는 파이프라인이 코덱과 겹쳐 처리하므로, 그 단계 시간은 코덱이 입력이나
+// 빈 출력 버퍼를 기다린 시간이다 (I/O가 코덱 뒤에 숨으면 0에 가깝다).
+// 매핑 경로처럼 워커가 읽기까지 맡는 경로에서는 그 시간이 코덱 단계에 들어간다.
+enum {
+    ADV_STAGE_READ = 0,
+    ADV_STAGE_CODEC,
+    ADV_STAGE_WRITE,
+    ADV_STAGE_COUNT
+};
+
+// 진행 보고 기본 간격 (초)
+#define ADV_PROGRESS_INTERVAL 0.1
+
+// 진행 상황. 진행 콜백에 넘어가는 값은 호출 동안만 유효하므로 보관하려면 복사한다.
+struct AdvProgress {
+    long long totalBytes;  // 입력 전체 크기 (파이프처럼 알 수 없으면 0)
+    long long inputBytes;  // 처리를 마친 입력 바이트 (해제할 때는 압축된 바이트)
+    long long outputBytes; // 기록을 마친 출력 바이트
+    long long blocks;      // 처리를 마친 블록 수
+    double elapsed;        // 시작 후 경과 시간 (초, 단조 시계)
+    double stageTime[ADV_STAGE_COUNT];
+    int finished;          // 작업의 마지막 보고이면 1 (실패했을 때도 보낸다)
+};
+
+// 진행 콜백. 코덱 함수를 부른 스레드에서 progressInterval마다 많아야 한 번 호출된다.
+typedef void (*AdvProgressFn)(const struct AdvProgress* progress, void* userData);
+
+// 코덱 설정. advDefaultOptions로 초기화한 뒤 필요한 값만 바꾼다.
+// 코덱 함수에 NULL을 넘기면 기본값을 쓴다. 해제에는 진행 보고와 취소 설정만 쓰인다.
+struct AdvOptions {
+    int maxCodeLength; // 하프만 코드 길이 상한 (ADV_CODE_LIMIT_MIN ~ ADV_CODE_LIMIT_MAX)
+    int level;         // 압축 강도 (ADV_LEVEL_MIN ~ ADV_LEVEL_MAX)
+    AdvProgressFn progress;  // 진행 콜백 (NULL이면 보고하지 않는다)
+    void* progressData;      // 진행 콜백에 넘길 값
+    double progressInterval; // 보고 최소 간격 (초)
+    unsigned int dictionary; // 블록 부호화에 후보로 쓸 등록된 사전의 ID (0이면 쓰지 않는다)
+    const volatile int* cancel; // 다른 스레드나 시그널 처리기가 0이 아닌 값을 쓰면 다음 배치 전에 멈춘다 (NULL이면 없음)
+    int blockSort;           // 0이 아니면 블록마다 블록 정렬(BWT) 부호화도 시도한다 (느리지만 가장 작다)
+};
+
+void advDefaultOptions(struct AdvOptions* options);
+
+// 블록 정렬 모드에서 블록 하나를 압축(decompress가 0이 아니면 해제)할 때 쓰는 작업 메모리의 상한 (바이트).
+// 블록은 작업 스레드마다 하나씩 동시에 처리되며, 입출력 버퍼는 포함하지 않는다.
+size_t advBlockSortMemory(int decompress);
+
+// 메모리 버퍼 압축/해제. 결과 버퍼는 호출자가 free한다.
+// 해제는 모든 형식(v0 ~ v4)을 받는다. v4는 블록과 파일 전체의 CRC32C를 검사한다.
+int advancedCompression(const unsigned char* data, size_t size, unsigned char** compressedData, size_t* compressedSize, const struct AdvOptions* options);
+int advancedDecompression(const unsigned char* compressed_data, size_t compressed_size, unsigned char** decompressedData, size_t* decompressedSize);
+
+// 스트림 압축/해제. 파이프처럼 탐색할 수 없는 FILE도 처리한다.
+// 파이프 입력은 FILE 버퍼를 거치지 않고 기술자에서 도착한 만큼 읽으므로, 호출 전에 stdio로 읽어
+// FILE 버퍼에 남겨 둔 입력이 없어야 한다.
+// processed에는 지금까지 처리한 입력 바이트 수가 누적된다.
+int compressStream(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options);
+int decompressStream(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options);
+
+// 파일 압축/해제. 일반 파일끼리면 매핑 경로를, 그 외에는 스트림 경로를 사용한다.
+// 매핑 해제 경로를 쓰려면 dest를 읽기/쓰기("wb+")로 열어야 한다.
+// 해제할 때 dest가 NULL이면 아무것도 기록하지 않고 체크섬만 검사한다.
+int compressFile(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options);
+int decompressFile(FILE* source, FILE* dest, long* processed, const struct AdvOptions* options);
+
+// 아카이브: 여러 파일을 항목으로 담는 컨테이너. 항목마다 블록 프레임이 이어지고,
+// 끝에 이름, 크기, 위치, CRC32C를 담은 중앙 디렉터리가 온다. 목록은 디렉터리만 읽고,
+// 항목 하나는 다른 항목을 건드리지 않고 풀 수 있다.
+struct AdvArchiveEntry {
+    char* name;                    // '/'로 구분한 상대 경로
+    unsigned long long size;       // 원본 크기
+    unsigned long long packedSize; // 압축된 프레임들의 크기
+    unsigned long long offset;     // 첫 프레임의 파일 내 위치
+    unsigned int blockCount;
+    unsigned int checksum;         // 원본의 CRC32C
+};
+
+struct AdvArchive {
+    int version;
+    size_t count;
+    struct AdvArchiveEntry* entries;
+};
+
+// 아카이브 쓰기. dest는 파이프여도 된다. 항목을 모두 더한 뒤 advArchiveClose가
+// 디렉터리를 기록하고 writer를 해제한다. 오류가 나면 이후 호출은 같은 오류를 돌려준다.
+struct AdvArchiveWriter;
+int advArchiveCreate(FILE* dest, const struct AdvOptions* options, struct AdvArchiveWriter** writer);
+int advArchiveAdd(struct AdvArchiveWriter* writer, const char* name, FILE* source, long* processed);
+int advArchiveClose(struct AdvArchiveWriter* writer);
+
+// 아카이브 읽기. source는 탐색 가능해야 한다. 항목 이름은 advArchiveFree가 해제한다.
+int advArchiveOpen(FILE* source, struct AdvArchive* archive);
+void advArchiveFree(struct AdvArchive* archive);
+long advArchiveFind(const struct AdvArchive* archive, const char* name); // 없으면 -1
+// dest가 NULL이면 항목을 풀어 체크섬만 검사한다.
+int advArchiveExtract(FILE* source, const struct AdvArchive* archive, size_t index, FILE* dest, long* processed, const struct AdvOptions* options);
+
+// 임의 위치 읽기. source는 탐색 가능해야 하고 reader를 닫을 때까지 열려 있어야 한다.
+// 원본의 (offset, length) 구간이 걸친 블록만 풀어 읽으며, 푼 블록은 cacheBlocks개까지 LRU로 보관한다.
+// 블록 인덱스가 없는 파일은 열 때 프레임 헤더를 훑어 같은 표를 만든다. reader 하나를 여러 스레드가 함께 쓰면 안 된다.
+#define ADV_READER_CACHE_DEFAULT 8
+
+struct AdvReader;
+struct AdvReaderStats {
+    unsigned long long blocksDecoded; // 프레임을 읽어 푼 블록 수
+    unsigned long long cacheHits;     // 캐시에서 바로 꺼낸 블록 수
+    unsigned long long bytesRead;     // 읽은 프레임 바이트 수
+};
+
+int advReaderOpen(FILE* source, size_t cacheBlocks, struct AdvReader** reader);
+int advReaderOpenEntry(FILE* source, const struct AdvArchive* archive, size_t index, size_t cacheBlocks, struct AdvReader** reader);
+unsigned long long advReaderSize(const struct AdvReader* reader); // 원본 전체 크기
+// got에는 실제로 읽은 바이트 수가 담긴다 (원본 끝을 넘는 부분은 읽지 않는다)
+int advReaderRead(struct AdvReader* reader, unsigned long long offset, void* buffer, size_t length, size_t* got);
+void advReaderGetStats(const struct AdvReader* reader, struct AdvReaderStats* stats);
+void advReaderClose(struct AdvReader* reader);
+
+// 사전: 표본 코퍼스로 미리 학습한 공유 하프만 코드표. 사전으로 부호화한 블록과 레코드에는
+// 코드표 대신 사전 ID만 기록되므로, 해제하는 쪽도 같은 사전을 등록해 두어야 한다.
+// 인코딩/디코딩 테이블은 사전을 만들 때 한 번 채워 캐시에 두고 모든 호출이 함께 쓴다.
+#define ADV_DICT_ID_AUTO 0 // 학습할 때 ID를 코드표의 CRC32C로 정한다
+
+struct AdvDictionary;
+int advDictionaryTrain(const unsigned char* samples, size_t size, unsigned int id, const struct AdvOptions* options, struct AdvDictionary** dict);
+int advDictionaryLoad(FILE* source, struct AdvDictionary** dict);
+int advDictionarySave(const struct AdvDictionary* dict, FILE* dest);
+unsigned int advDictionaryId(const struct AdvDictionary* dict);
+void advDictionaryFree(struct AdvDictionary* dict); // 등록하지 않은 사전만 해제한다
+
+// 사전 캐시. 등록하면 소유권이 캐시로 넘어간다. 같은 ID로 같은 코드표를 다시 등록하면
+// 넘긴 사전을 해제하고 ADV_OK를, 다른 코드표면 ADV_ERR_DICTIONARY를 돌려준다.
+// advDictionaryClear는 사전을 쓰는 코덱 호출이 모두 끝난 뒤에 부른다.
+int advDictionaryRegister(struct AdvDictionary* dict);
+void advDictionaryClear(void);
+
+// 레코드: 파일 헤더와 프레임 없이 [사전 ID][원본 크기][비트]만 담은 작은 메시지 형식.
+// out은 ADV_RECORD_BOUND(size) 바이트면 항상 충분하다. 해제할 크기는 advRecordInfo로 알 수 있다.
+#define ADV_RECORD_BOUND(n) ((n) + 14)
+int advRecordCompress(unsigned int dictId, const unsigned char* data, size_t size, unsigned char* out, size_t outCapacity, size_t* outSize);
+int advRecordInfo(const unsigned char* record, size_t recordSize, unsigned int* dictId, size_t* size);
+int advRecordDecompress(const unsigned char* record, size_t recordSize, unsigned char* out, size_t outCapacity, size_t* outSize);
+
+// 결과 코드에 대한 메시지
+const char* advErrorMessage(int result);
+
+#endif
@@ -0,0 +1,438 @@
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+// 문맥 하프만 블록 (순서 1 문맥)
+// 텍스트나 구조화된 데이터는 다음 바이트의 분포가 바로 앞 바이트에 따라 크게 달라서, 블록 전체의
+// 분포 하나로 만든 코드로는 그 차이를 쓰지 못한다. 앞 바이트 256개를 다음 바이트 분포가 비슷한
+// 것끼리 최대 ADV_CONTEXT_TABLES개 묶음으로 나누고 묶음마다 길이 제한 하프만 코드를 둔다.
+// 부호화와 해제 모두 앞 바이트로 코드표를 고를 뿐 나머지는 다중 스트림 하프만과 같다.
+
+#define CONTEXT_ITERATIONS 6 // 묶음을 다시 나누는 최대 횟수
+
+// 블록의 문맥 통계: 앞 바이트마다 (다음 바이트, 횟수) 목록
+struct ContextStats {
+    unsigned total[256];
+    unsigned start[257]; // 문맥 c의 쌍은 [start[c], start[c + 1])
+    unsigned char* symbol;
+    unsigned* count;
+    uint64_t selfCost[256]; // 문맥 자신의 분포로 부호화한 비용 (군집 시드를 고를 때 쓴다)
+};
+
+// 앞 바이트 c 뒤에 심볼 s가 나온 횟수를 센다. 스트림마다 문맥 0에서 시작한다.
+// 네 스트림을 번갈아 세어 같은 쌍이 이어져도 한 카운터의 증가가 줄줄이 기다리지 않게 한다.
+void countContextPairs(const unsigned char* data, size_t size, unsigned hist[256][256]) {
+    memset(hist, 0, 256 * sizeof(hist[0]));
+    const unsigned char* in[ADV_HUFF_STREAMS];
+    unsigned prev[ADV_HUFF_STREAMS] = {0};
+    for (int k = 0; k < ADV_HUFF_STREAMS; k++) in[k] = &data[streamStart(size, k)];
+    // 마지막 스트림은 다른 스트림보다 짧거나 같으므로 그 길이만큼 번갈아 세고 나머지를 센다
+    size_t common = size - streamStart(size, ADV_HUFF_STREAMS - 1);
+    for (size_t i = 0; i < common; i++) {
+        for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+            unsigned symbol = in[k][i];
+            hist[prev[k]][symbol]++;
+            prev[k] = symbol;
+        }
+    }
+    for (int k = 0; k < ADV_HUFF_STREAMS - 1; k++) {
+        size_t end = streamStart(size, k + 1) - streamStart(size, k);
+        for (size_t i = common; i < end; i++) {
+            hist[prev[k]][in[k][i]]++;
+            prev[k] = in[k][i];
+        }
+    }
+}
+
+// 분포 count(합 total)로 심볼마다 드는 비트 (16비트 소수부 고정소수점).
+// 분포에 없던 심볼은 횟수 1/2로 본다.
+void contextCostTable(const unsigned count[256], unsigned total, uint32_t cost[256]) {
+    uint32_t base = log2Fixed(2 * total + 1);
+    for (int s = 0; s < 256; s++) cost[s] = base - log2Fixed(2 * count[s] + 1);
+}
+
+uint64_t contextCost(const struct ContextStats* st, int c, const uint32_t cost[256]) {
+    uint64_t bits = 0;
+    for (unsigned i = st->start[c]; i < st->start[c + 1]; i++) bits += (uint64_t)st->count[i] * cost[st->symbol[i]];
+    return bits;
+}
+
+// 문맥 c의 분포를 256칸 배열로 펼친다
+void expandContext(const struct ContextStats* st, int c, unsigned count[256]) {
+    memset(count, 0, 256 * sizeof(unsigned));
+    for (unsigned i = st->start[c]; i < st->start[c + 1]; i++) count[st->symbol[i]] = st->count[i];
+}
+
+// 각 문맥을 비용이 가장 작은 묶음에 넣고 바뀐 문맥 수를 돌려준다
+int assignContexts(const struct ContextStats* st, uint32_t cost[][256], int tableCount, unsigned char map[256]) {
+    int changed = 0;
+    for (int c = 0; c < 256; c++) {
+        if (st->total[c] == 0) continue;
+        int best = 0;
+        uint64_t bestBits = UINT64_MAX;
+        for (int k = 0; k < tableCount; k++) {
+            uint64_t bits = contextCost(st, c, cost[k]);
+            if (bits < bestBits) {
+                bestBits = bits;
+                best = k;
+            }
+        }
+        changed += map[c] != best;
+        map[c] = (unsigned char)best;
+    }
+    return changed;
+}
+
+// 묶음마다 구성 문맥의 분포를 합친다. 빈 묶음은 지우고 번호를 앞으로 당긴 뒤 묶음 수를 돌려준다.
+int mergeClusters(const struct ContextStats* st, int tableCount, unsigned char map[256], unsigned count[][256], unsigned total[]) {
+    int renumber[ADV_CONTEXT_TABLES];
+    memset(count, 0, (size_t)tableCount * 256 * sizeof(unsigned));
+    memset(total, 0, (size_t)tableCount * sizeof(unsigned));
+    for (int c = 0; c < 256; c++) {
+        if (st->total[c] == 0) continue;
+        for (unsigned i = st->start[c]; i < st->start[c + 1]; i++) count[map[c]][st->symbol[i]] += st->count[i];
+        total[map[c]] += st->total[c];
+    }
+    int used = 0;
+    for (int k = 0; k < tableCount; k++) {
+        renumber[k] = used;
+        if (total[k] == 0) continue;
+        if (used != k) {
+            memcpy(count[used], count[k], 256 * sizeof(unsigned));
+            total[used] = total[k];
+        }
+        used++;
+    }
+    for (int c = 0; c < 256; c++) {
+        if (st->total[c] != 0) map[c] = (unsigned char)renumber[map[c]];
+    }
+    return used;
+}
+
+// 문맥을 tableCount개 이하의 묶음으로 나누고 묶음마다 코드 길이를 만든다 (k-평균과 같은 반복).
+// 시드는 가장 많이 나온 문맥에서 시작해, 지금까지의 시드로 부호화할 때 손해가 가장 큰 문맥을 차례로 고른다.
+// 인코딩한 비트 수를 돌려준다.
+uint64_t clusterContexts(const struct ContextStats* st, int tableCount, int maxLength, struct ContextModel* model) {
+    unsigned count[ADV_CONTEXT_TABLES][256];
+    unsigned total[ADV_CONTEXT_TABLES];
+    uint32_t cost[ADV_CONTEXT_TABLES][256];
+    uint64_t nearest[256];
+    int first = 0;
+    for (int c = 0; c < 256; c++) {
+        nearest[c] = UINT64_MAX;
+        if (st->total[c] > st->total[first]) first = c;
+    }
+    expandContext(st, first, count[0]);
+    contextCostTable(count[0], st->total[first], cost[0]);
+    int seeds = 1;
+    while (seeds < tableCount) {
+        int far = -1;
+        uint64_t farLoss = 0;
+        for (int c = 0; c < 256; c++) {
+            if (st->total[c] == 0) continue;
+            uint64_t bits = contextCost(st, c, cost[seeds - 1]);
+            if (bits < nearest[c]) nearest[c] = bits;
+            uint64_t loss = nearest[c] > st->selfCost[c] ? nearest[c] - st->selfCost[c] : 0;
+            if (loss > farLoss) {
+                farLoss = loss;
+                far = c;
+            }
+        }
+        if (far < 0) break; // 남은 문맥이 모두 기존 시드와 같은 분포
+        expandContext(st, far, count[seeds]);
+        contextCostTable(count[seeds], st->total[far], cost[seeds]);
+        seeds++;
+    }
+
+    memset(model->map, 0, sizeof(model->map));
+    assignContexts(st, cost, seeds, model->map);
+    int clusters = mergeClusters(st, seeds, model->map, count, total);
+    for (int iter = 0; iter < CONTEXT_ITERATIONS; iter++) {
+        for (int k = 0; k < clusters; k++) contextCostTable(count[k], total[k], cost[k]);
+        if (assignContexts(st, cost, clusters, model->map) == 0) break;
+        clusters = mergeClusters(st, clusters, model->map, count, total);
+    }
+
+    // 나오지 않은 문맥은 앞 문맥과 같은 묶음에 넣어 지도의 반복 부호가 길어지게 한다
+    for (int c = 1; c < 256; c++) {
+        if (st->total[c] == 0) model->map[c] = model->map[c - 1];
+    }
+    model->tableCount = clusters;
+    for (int k = 0; k < clusters; k++) {
+        buildCodeLengths(count[k], 256, model->lengths[k], maxLength);
+        // 심볼이 하나뿐인 묶음도 1비트 코드를 받는다
+        for (int s = 0; s < 256; s++) {
+            if (count[k][s] && model->lengths[k][s] == 0) model->lengths[k][s] = 1;
+        }
+    }
+    uint64_t bits = 0;
+    for (int c = 0; c < 256; c++) {
+        const unsigned char* lengths = model->lengths[model->map[c]];
+        for (unsigned i = st->start[c]; i < st->start[c + 1]; i++) bits += (uint64_t)st->count[i] * lengths[st->symbol[i]];
+    }
+    return bits;
+}
+
+// 횟수표를 쌍 목록으로 옮기고 코드표 수 2, 4, 8로 묶어 보아 가장 작은 것을 model에 남긴다.
+// 코드표를 늘려도 블록이 작아지지 않으면 그 자리에서 멈춘다.
+size_t chooseContextModel(unsigned hist[256][256], struct ContextStats* st, int maxLength, struct ContextModel* model) {
+    unsigned char* symbol = st->symbol;
+    unsigned* count = st->count;
+    size_t best = SIZE_MAX;
+    unsigned pairs = 0;
+    int active = 0;
+    for (int c = 0; c < 256; c++) {
+        st->start[c] = pairs;
+        st->total[c] = 0;
+        st->selfCost[c] = 0;
+        for (int s = 0; s < 256; s++) {
+            if (hist[c][s] == 0) continue;
+            symbol[pairs] = (unsigned char)s;
+            count[pairs++] = hist[c][s];
+            st->total[c] += hist[c][s];
+        }
+        if (st->total[c] == 0) continue;
+        active++;
+        uint32_t base = log2Fixed(2 * st->total[c] + 1);
+        for (unsigned i = st->start[c]; i < pairs; i++) st->selfCost[c] += (uint64_t)count[i] * (base - log2Fixed(2 * count[i] + 1));
+    }
+    st->start[256] = pairs;
+    if (active < 2) return SIZE_MAX; // 문맥이 하나면 하프만 블록과 같다
+
+    for (int tableCount = 2; tableCount <= ADV_CONTEXT_TABLES; tableCount *= 2) {
+        struct ContextModel candidate;
+        uint64_t bits = clusterContexts(st, tableCount, maxLength, &candidate);
+        if (candidate.tableCount < 2) break;
+        unsigned char table[ADV_PACKED_LENGTHS_MAX(256)];
+        size_t tableSize = 1 + writePackedLengths(candidate.map, 256, table);
+        for (int k = 0; k < candidate.tableCount; k++) tableSize += writePackedLengths(candidate.lengths[k], 256, table);
+        // 스트림마다 최대 1바이트의 패딩이 더 든다
+        size_t frameSize = ADV_BLOCK_HEADER_SIZE + tableSize + ADV_HUFF_JUMP_SIZE + (size_t)((bits + 7) / 8) + ADV_HUFF_STREAMS - 1;
+        // 코드표를 두 배로 늘려도 작아지지 않으면 더 나누어 보지 않는다
+        if (frameSize >= best) break;
+        best = frameSize;
+        *model = candidate;
+        if (candidate.tableCount < tableCount) break; // 더 나눌 문맥이 없다
+    }
+    return best;
+}
+
+// 문맥 하프만 블록의 프레임 크기(헤더 포함, 체크섬 제외)를 구하고 그 묶음을 model에 남긴다.
+// 쓸 수 없는 블록이면 SIZE_MAX. 블록마다 횟수표 256 KiB와 쌍 목록을 잠시 할당한다.
+size_t estimateContextBlock(const unsigned char* data, size_t size, int maxLength, struct ContextModel* model) {
+    if (size < ADV_CONTEXT_MIN_SIZE) return SIZE_MAX;
+    unsigned (*hist)[256] = (unsigned (*)[256])malloc(256 * sizeof(*hist));
+    struct ContextStats* st = (struct ContextStats*)malloc(sizeof(struct ContextStats));
+    size_t pairCount = size < 65536 ? size : 65536;
+    unsigned char* symbol = (unsigned char*)malloc(pairCount);
+    unsigned* count = (unsigned*)malloc(pairCount * sizeof(unsigned));
+    size_t best = SIZE_MAX;
+    if (hist && st && symbol && count) {
+        countContextPairs(data, size, hist);
+        st->symbol = symbol;
+        st->count = count;
+        best = chooseContextModel(hist, st, maxLength, model);
+    }
+    free(hist);
+    free(st);
+    free(symbol);
+    free(count);
+    return best;
+}
+
+// 스트림 하나를 부호화한다. ctxCode[앞 바이트][심볼]은 (코드 << 4) | 길이 (길이 15 이하).
+// 길이 제한 코드 두 개는 32비트를 넘지 않으므로 huffmanEncode처럼 두 심볼마다 한 번만 내보낸다.
+size_t encodeContextStream(const unsigned char* input, size_t size, unsigned char* output, const uint32_t* const ctxCode[256]) {
+    size_t outIdx = 0;
+    uint64_t bitBuf = 0;
+    int bitCount = 0;
+    unsigned prev = 0;
+    size_t i = 0;
+    for (; i + 2 <= size; i += 2) {
+        uint32_t code0 = ctxCode[prev][input[i]];
+        uint32_t code1 = ctxCode[input[i]][input[i + 1]];
+        prev = input[i + 1];
+        bitBuf = (bitBuf << (code0 & 15)) | (code0 >> 4);
+        bitBuf = (bitBuf << (code1 & 15)) | (code1 >> 4);
+        bitCount += (int)(code0 & 15) + (int)(code1 & 15);
+        if (bitCount >= 32) {
+            bitCount -= 32;
+            uint32_t word = (uint32_t)(bitBuf >> bitCount);
+            output[outIdx++] = (unsigned char)(word >> 24);
+            output[outIdx++] = (unsigned char)(word >> 16);
+            output[outIdx++] = (unsigned char)(word >> 8);
+            output[outIdx++] = (unsigned char)word;
+        }
+    }
+    if (i < size) {
+        uint32_t code = ctxCode[prev][input[i]];
+        bitBuf = (bitBuf << (code & 15)) | (code >> 4);
+        bitCount += (int)(code & 15);
+    }
+    while (bitCount >= 8) {
+        bitCount -= 8;
+        output[outIdx++] = (unsigned char)(bitBuf >> bitCount);
+    }
+    if (bitCount > 0) output[outIdx++] = (unsigned char)(bitBuf << (8 - bitCount));
+    return outIdx;
+}
+
+// 문맥 하프만 블록 프레임을 기록한다 (체크섬 제외). model은 estimateContextBlock이 채운 것이다.
+size_t compressContextBlock(const unsigned char* data, size_t size, const struct ContextModel* model, unsigned char* out) {
+    uint32_t code[ADV_CONTEXT_TABLES][256];
+    const uint32_t* ctxCode[256];
+    out[0] = ADV_BLOCK_CONTEXT;
+    putLE32(&out[1], (uint32_t)size);
+    size_t idx = ADV_BLOCK_HEADER_SIZE;
+    out[idx++] = (unsigned char)model->tableCount;
+    idx += writePackedLengths(model->map, 256, &out[idx]);
+    for (int k = 0; k < model->tableCount; k++) {
+        uint64_t codes[256];
+        idx += writePackedLengths(model->lengths[k], 256, &out[idx]);
+        assignCanonicalCodes(model->lengths[k], 256, codes);
+        for (int s = 0; s < 256; s++) code[k][s] = (uint32_t)codes[s] << 4 | model->lengths[k][s];
+    }
+    for (int c = 0; c < 256; c++) ctxCode[c] = code[model->map[c]];
+
+    size_t jump = idx;
+    idx += ADV_HUFF_JUMP_SIZE;
+    for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+        size_t start = streamStart(size, k);
+        size_t streamSize = encodeContextStream(&data[start], streamStart(size, k + 1) - start, &out[idx], ctxCode);
+        if (k < ADV_HUFF_STREAMS - 1) putLE32(&out[jump + 4 * k], (uint32_t)streamSize);
+        idx += streamSize;
+    }
+    putLE32(&out[5], (uint32_t)(idx - ADV_BLOCK_HEADER_SIZE));
+    return idx;
+}
+
+// 해제 상태. 모든 코드가 HUFF_TABLE_BITS 이하이면 entries로 풀며, 항목마다 다음 심볼에 쓸
+// 코드표의 시작 위치를 담아 두어 심볼 하나에 테이블 조회 한 번만 기다리게 한다.
+struct ContextEntry {
+    unsigned char symbol;
+    unsigned char length;
+    uint16_t next; // 이 심볼 뒤에 쓸 코드표 번호 << HUFF_TABLE_BITS
+};
+
+struct ContextDecoder {
+    unsigned char map[256];
+    struct HuffDecoder tables[ADV_CONTEXT_TABLES];
+    struct ContextEntry entries[ADV_CONTEXT_TABLES << HUFF_TABLE_BITS];
+};
+
+// 스트림의 남은 심볼을 하나씩 푼다. 긴 코드도 처리한다. 실패하면 0을 돌려준다.
+int decodeContextTail(struct HuffStream* s, const struct ContextDecoder* dec, unsigned prev) {
+    while (s->out < s->outEnd) {
+        s->ptr += s->consumed >> 3;
+        s->consumed &= 7;
+        if (s->ptr >= s->end) return 0;
+        uint64_t bits = loadBE64Tail(s->ptr, s->end) << s->consumed;
+        const struct HuffDecoder* table = &dec->tables[dec->map[prev]];
+        const struct HuffDecodeEntry* entry = &table->table[bits >> (64 - HUFF_TABLE_BITS)];
+        unsigned len = entry->length;
+        unsigned char symbol = (unsigned char)entry->symbol;
+        if (len == 0) {
+            const struct HuffLongCodes* longCodes = &table->longCodes;
+            unsigned k;
+            for (k = 0; k < longCodes->count; k++) {
+                int longLen = longCodes->length[k];
+                if ((bits >> (64 - longLen)) == longCodes->code[k]) break;
+            }
+            if (k == longCodes->count) return 0;
+            len = longCodes->length[k];
+            symbol = (unsigned char)longCodes->symbol[k];
+        }
+        *s->out++ = symbol;
+        prev = symbol;
+        s->consumed += len;
+    }
+    return (size_t)(s->end - s->ptr) * 8 >= s->consumed;
+}
+
+// 네 스트림을 번갈아 풀며 심볼마다 앞 바이트의 코드표를 쓴다
+int decodeContextStreams(const unsigned char* encoded, size_t encodedSize, const struct ContextDecoder* dec, int longCodes, unsigned char* out, size_t rawSize) {
+    struct HuffStream streams[ADV_HUFF_STREAMS];
+    if (!openHuffStreams(encoded, encodedSize, out, rawSize, streams)) return ADV_ERR_FORMAT;
+
+    if (!longCodes) {
+        // 모든 코드가 테이블 안에 들면 한 번 읽은 64비트로 스트림마다 심볼 다섯 개를 푼다
+        const struct ContextEntry* entries = dec->entries;
+        unsigned base[ADV_HUFF_STREAMS];
+        for (int k = 0; k < ADV_HUFF_STREAMS; k++) base[k] = (unsigned)dec->map[0] << HUFF_TABLE_BITS;
+        unsigned bad = 0;
+        for (;;) {
+            int ready = 1;
+            for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+                struct HuffStream* s = &streams[k];
+                s->ptr += s->consumed >> 3;
+                s->consumed &= 7;
+                if (s->end - s->ptr < 8 || s->outEnd - s->out < 5) ready = 0;
+            }
+            if (!ready) break;
+            uint64_t bits[ADV_HUFF_STREAMS];
+            for (int k = 0; k < ADV_HUFF_STREAMS; k++) bits[k] = loadBE64(streams[k].ptr) << streams[k].consumed;
+            for (int n = 0; n < 5; n++) {
+                for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+                    const struct ContextEntry* entry = &entries[base[k] | (unsigned)(bits[k] >> (64 - HUFF_TABLE_BITS))];
+                    unsigned len = entry->length;
+                    base[k] = entry->next;
+                    *streams[k].out++ = entry->symbol;
+                    bits[k] <<= len;
+                    streams[k].consumed += len;
+                    bad |= len == 0; // 길이표에 없는 비트열
+                }
+            }
+        }
+        if (bad) return ADV_ERR_FORMAT;
+    }
+
+    for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+        unsigned char* begin = &out[streamStart(rawSize, k)];
+        if (!decodeContextTail(&streams[k], dec, streams[k].out > begin ? streams[k].out[-1] : 0)) return ADV_ERR_FORMAT;
+    }
+    return ADV_OK;
+}
+
+// 코드표들을 읽어 디코딩 테이블을 채우고 스트림을 푼다
+int decodeContextTables(const unsigned char* in, size_t avail, int tableCount, struct ContextDecoder* dec, unsigned char* out, size_t rawSize) {
+    size_t idx = 0;
+    int longCodes = 0;
+    for (int k = 0; k < tableCount; k++) {
+        unsigned char lengths[256];
+        uint64_t codes[256];
+        size_t tableSize = readPackedLengths(&in[idx], avail - idx, lengths, 256);
+        if (tableSize == 0 || !validateCodeLengths(lengths, 256)) return ADV_ERR_FORMAT;
+        assignCanonicalCodes(lengths, 256, codes);
+        buildDecodeTable(codes, lengths, 256, dec->tables[k].table, &dec->tables[k].longCodes);
+        longCodes |= dec->tables[k].longCodes.count != 0;
+        idx += tableSize;
+    }
+    if (!longCodes) {
+        for (int k = 0; k < tableCount; k++) {
+            const struct HuffDecodeEntry* table = dec->tables[k].table;
+            struct ContextEntry* entries = &dec->entries[k << HUFF_TABLE_BITS];
+            for (unsigned i = 0; i < (1u << HUFF_TABLE_BITS); i++) {
+                entries[i].symbol = (unsigned char)table[i].symbol;
+                entries[i].length = table[i].length;
+                entries[i].next = (uint16_t)(dec->map[table[i].symbol] << HUFF_TABLE_BITS);
+            }
+        }
+    }
+    return decodeContextStreams(&in[idx], avail - idx, dec, longCodes, out, rawSize);
+}
+
+// 문맥 하프만 블록을 정확히 rawSize 바이트로 복원한다. 해제 테이블(약 150 KiB)은 블록마다 잠시 할당한다.
+int decompressContextBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize) {
+    if (payloadSize < 1) return ADV_ERR_FORMAT;
+    int tableCount = payload[0];
+    if (tableCount < 2 || tableCount > ADV_CONTEXT_TABLES) return ADV_ERR_FORMAT;
+    struct ContextDecoder* dec = (struct ContextDecoder*)malloc(sizeof(struct ContextDecoder));
+    if (!dec) return ADV_ERR_NOMEM;
+    int result = ADV_ERR_FORMAT;
+    size_t mapSize = readPackedLengths(&payload[1], payloadSize - 1, dec->map, 256);
+    int valid = mapSize != 0;
+    for (int c = 0; c < 256 && valid; c++) valid = dec->map[c] < tableCount;
+    if (valid) result = decodeContextTables(&payload[1 + mapSize], payloadSize - 1 - mapSize, tableCount, dec, out, rawSize);
+    free(dec);
+    return result;
+}
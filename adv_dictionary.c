@@ -0,0 +1,226 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "adv_internal.h"
+
+// 사전: 표본 코퍼스의 빈도로 미리 만든 공유 하프만 코드표
+// 수백 바이트짜리 레코드는 블록마다 코드표를 싣고 트리를 만드는 비용이 본문보다 크다.
+// 사전을 쓰면 레코드에는 사전 ID만 남고, 인코딩/디코딩 테이블은 사전을 만들 때 한 번 채워
+// 캐시에 둔 것을 모든 레코드와 블록이 함께 읽는다.
+
+// 등록된 사전 목록. 등록과 비우기만 잠그고, 찾은 사전은 advDictionaryClear 전까지 그대로 유효하다.
+struct AdvDictionary* dictionaryCache = NULL;
+pthread_mutex_t dictionaryCacheLock = PTHREAD_MUTEX_INITIALIZER;
+
+// 코드 길이로 정규 코드와 디코딩 테이블을 채운 사전을 만든다
+int createDictionary(unsigned int id, const unsigned char lengths[], struct AdvDictionary** dict) {
+    *dict = NULL;
+    struct AdvDictionary* d = (struct AdvDictionary*)calloc(1, sizeof(struct AdvDictionary));
+    if (!d) return ADV_ERR_NOMEM;
+    d->id = id;
+    memcpy(d->lengths, lengths, sizeof(d->lengths));
+    assignCanonicalCodes(d->lengths, 256, d->codes);
+    buildDecodeTable(d->codes, d->lengths, 256, d->decoder.table, &d->decoder.longCodes);
+    *dict = d;
+    return ADV_OK;
+}
+
+// 표본 전체의 빈도에 1을 더해 모든 바이트가 코드를 갖게 한다 (표본에 없던 바이트도 인코딩 가능)
+int advDictionaryTrain(const unsigned char* samples, size_t size, unsigned int id, const struct AdvOptions* options, struct AdvDictionary** dict) {
+    struct AdvOptions resolved;
+    resolveOptions(options, &resolved);
+    unsigned freq[256];
+    calculateFrequency(samples, size, freq);
+    // 아주 큰 표본에서 빈도 합이 넘치지 않도록 비율을 유지한 채 줄인다
+    while (size > 0xFFFFFFu) {
+        for (int i = 0; i < 256; i++) freq[i] >>= 1;
+        size >>= 1;
+    }
+    for (int i = 0; i < 256; i++) freq[i]++;
+
+    unsigned char lengths[256];
+    buildCodeLengths(freq, 256, lengths, resolved.maxCodeLength);
+    if (id == ADV_DICT_ID_AUTO) {
+        id = crc32cUpdate(0, lengths, sizeof(lengths));
+        if (id == ADV_DICT_ID_AUTO) id = 1;
+    }
+    return createDictionary(id, lengths, dict);
+}
+
+// 사전 파일: [매직 4][형식 버전][사전 ID 4][압축된 코드 길이표]
+int advDictionarySave(const struct AdvDictionary* dict, FILE* dest) {
+    unsigned char buf[ADV_DICT_HEADER_SIZE + ADV_PACKED_LENGTHS_MAX(256)];
+    memcpy(buf, ADV_DICT_MAGIC, ADV_MAGIC_SIZE);
+    buf[ADV_MAGIC_SIZE] = ADV_DICT_VERSION;
+    putLE32(&buf[ADV_MAGIC_SIZE + 1], dict->id);
+    size_t size = ADV_DICT_HEADER_SIZE + writePackedLengths(dict->lengths, 256, &buf[ADV_DICT_HEADER_SIZE]);
+    return fwrite(buf, 1, size, dest) == size ? ADV_OK : ADV_ERR_WRITE;
+}
+
+int advDictionaryLoad(FILE* source, struct AdvDictionary** dict) {
+    *dict = NULL;
+    unsigned char buf[ADV_DICT_HEADER_SIZE + ADV_PACKED_LENGTHS_MAX(256) + 1];
+    size_t size = fread(buf, 1, sizeof(buf), source);
+    if (ferror(source)) return ADV_ERR_READ;
+    if (size < ADV_DICT_HEADER_SIZE || memcmp(buf, ADV_DICT_MAGIC, ADV_MAGIC_SIZE) != 0 ||
+        buf[ADV_MAGIC_SIZE] != ADV_DICT_VERSION || size == sizeof(buf)) {
+        return ADV_ERR_FORMAT;
+    }
+    unsigned int id = getLE32(&buf[ADV_MAGIC_SIZE + 1]);
+    unsigned char lengths[256];
+    size_t tableSize = readPackedLengths(&buf[ADV_DICT_HEADER_SIZE], size - ADV_DICT_HEADER_SIZE, lengths, 256);
+    if (id == ADV_DICT_ID_AUTO || tableSize == 0 || !validateCodeLengths(lengths, 256)) return ADV_ERR_FORMAT;
+    for (int i = 0; i < 256; i++) {
+        if (lengths[i] > ADV_CODE_LIMIT_MAX) return ADV_ERR_FORMAT;
+    }
+    return createDictionary(id, lengths, dict);
+}
+
+unsigned int advDictionaryId(const struct AdvDictionary* dict) {
+    return dict->id;
+}
+
+void advDictionaryFree(struct AdvDictionary* dict) {
+    free(dict);
+}
+
+int advDictionaryRegister(struct AdvDictionary* dict) {
+    pthread_mutex_lock(&dictionaryCacheLock);
+    int result = ADV_OK;
+    for (struct AdvDictionary* d = dictionaryCache; d != NULL; d = d->next) {
+        if (d->id != dict->id) continue;
+        // 같은 사전을 다시 등록하면 새 것은 버리고, 코드표가 다르면 충돌로 거절한다
+        result = memcmp(d->lengths, dict->lengths, sizeof(d->lengths)) == 0 ? ADV_OK : ADV_ERR_DICTIONARY;
+        if (result == ADV_OK) free(dict);
+        pthread_mutex_unlock(&dictionaryCacheLock);
+        return result;
+    }
+    dict->next = dictionaryCache;
+    dictionaryCache = dict;
+    pthread_mutex_unlock(&dictionaryCacheLock);
+    return result;
+}
+
+void advDictionaryClear(void) {
+    pthread_mutex_lock(&dictionaryCacheLock);
+    struct AdvDictionary* d = dictionaryCache;
+    dictionaryCache = NULL;
+    pthread_mutex_unlock(&dictionaryCacheLock);
+    while (d != NULL) {
+        struct AdvDictionary* next = d->next;
+        free(d);
+        d = next;
+    }
+}
+
+const struct AdvDictionary* findDictionary(unsigned int id) {
+    pthread_mutex_lock(&dictionaryCacheLock);
+    const struct AdvDictionary* d = dictionaryCache;
+    while (d != NULL && d->id != id) d = d->next;
+    pthread_mutex_unlock(&dictionaryCacheLock);
+    return d;
+}
+
+// 사전 코드로 인코딩한 비트 수. 사전에 없는 바이트가 있으면 UINT64_MAX.
+uint64_t dictionaryBits(const struct AdvDictionary* dict, const unsigned freq[]) {
+    uint64_t bits = 0;
+    for (int i = 0; i < 256; i++) {
+        if (freq[i] == 0) continue;
+        if (dict->lengths[i] == 0) return UINT64_MAX;
+        bits += (uint64_t)freq[i] * dict->lengths[i];
+    }
+    return bits;
+}
+
+// 사전 블록 페이로드: [사전 ID 4][인코딩된 비트] (ADV_HUFF_STREAMS_MIN 이상이면 다중 스트림)
+size_t writeDictionaryPayload(const struct AdvDictionary* dict, const unsigned char* data, size_t size, unsigned char* out) {
+    putLE32(out, dict->id);
+    if (size >= ADV_HUFF_STREAMS_MIN) return 4 + huffmanEncodeStreams(data, size, &out[4], dict->codes, dict->lengths);
+    return 4 + huffmanEncode(data, size, &out[4], dict->codes, dict->lengths);
+}
+
+int decompressDictionaryBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize) {
+    if (payloadSize < 4) return ADV_ERR_FORMAT;
+    const struct AdvDictionary* dict = findDictionary(getLE32(payload));
+    if (dict == NULL) return ADV_ERR_DICTIONARY;
+    if (rawSize >= ADV_HUFF_STREAMS_MIN) return huffmanDecodeStreamsWith(&dict->decoder, &payload[4], payloadSize - 4, out, rawSize);
+    return huffmanDecodeWith(&dict->decoder, &payload[4], payloadSize - 4, out, rawSize) == rawSize ? ADV_OK : ADV_ERR_FORMAT;
+}
+
+// 레코드: [사전 ID 4][원본 크기 * 2 + 저장 여부 (LEB128)][사전으로 인코딩한 비트 또는 원본]
+// 파일 헤더도 블록 프레임도 없이, 사전 코드로 줄지 않는 레코드만 그대로 저장한다.
+size_t writeVarint(unsigned char* out, uint64_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+        out[n++] = (unsigned char)(v | 0x80);
+        v >>= 7;
+    }
+    out[n++] = (unsigned char)v;
+    return n;
+}
+
+size_t readVarint(const unsigned char* in, size_t avail, uint64_t* v) {
+    *v = 0;
+    for (size_t n = 0; n < avail && n < 10; n++) {
+        *v |= (uint64_t)(in[n] & 0x7F) << (7 * n);
+        if (!(in[n] & 0x80)) return n + 1;
+    }
+    return 0;
+}
+
+int advRecordCompress(unsigned int dictId, const unsigned char* data, size_t size, unsigned char* out, size_t outCapacity, size_t* outSize) {
+    *outSize = 0;
+    const struct AdvDictionary* dict = findDictionary(dictId);
+    if (dict == NULL) return ADV_ERR_DICTIONARY;
+
+    uint64_t bits = 0;
+    for (size_t i = 0; i < size && bits != UINT64_MAX; i++) {
+        bits = dict->lengths[data[i]] ? bits + dict->lengths[data[i]] : UINT64_MAX;
+    }
+    int stored = bits == UINT64_MAX || (bits + 7) / 8 >= size;
+    size_t payloadSize = stored ? size : (size_t)((bits + 7) / 8);
+
+    unsigned char header[4 + 10];
+    putLE32(header, dict->id);
+    size_t headerSize = 4 + writeVarint(&header[4], (uint64_t)size * 2 + (unsigned)stored);
+    if (outCapacity < headerSize + payloadSize) return ADV_ERR_WRITE;
+    memcpy(out, header, headerSize);
+    if (stored) {
+        memcpy(&out[headerSize], data, size);
+    } else {
+        huffmanEncode(data, size, &out[headerSize], dict->codes, dict->lengths);
+    }
+    *outSize = headerSize + payloadSize;
+    return ADV_OK;
+}
+
+int advRecordInfo(const unsigned char* record, size_t recordSize, unsigned int* dictId, size_t* size) {
+    uint64_t value;
+    if (recordSize < 4 || readVarint(&record[4], recordSize - 4, &value) == 0 || value / 2 > SIZE_MAX) return ADV_ERR_FORMAT;
+    if (dictId) *dictId = getLE32(record);
+    if (size) *size = (size_t)(value / 2);
+    return ADV_OK;
+}
+
+int advRecordDecompress(const unsigned char* record, size_t recordSize, unsigned char* out, size_t outCapacity, size_t* outSize) {
+    *outSize = 0;
+    uint64_t value;
+    size_t varintSize = recordSize < 4 ? 0 : readVarint(&record[4], recordSize - 4, &value);
+    if (varintSize == 0) return ADV_ERR_FORMAT;
+    const struct AdvDictionary* dict = findDictionary(getLE32(record));
+    if (dict == NULL) return ADV_ERR_DICTIONARY;
+
+    uint64_t size = value / 2;
+    const unsigned char* payload = &record[4 + varintSize];
+    size_t payloadSize = recordSize - 4 - varintSize;
+    if (size > outCapacity) return ADV_ERR_WRITE;
+    if (value & 1) {
+        if (payloadSize != size) return ADV_ERR_FORMAT;
+        memcpy(out, payload, payloadSize);
+    } else if (huffmanDecodeWith(&dict->decoder, payload, payloadSize, out, (size_t)size) != size) {
+        return ADV_ERR_FORMAT;
+    }
+    *outSize = (size_t)size;
+    return ADV_OK;
+}
@@ -0,0 +1,775 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+// 하프만 코딩과 관련된 함수들
+struct MinHeapNode* newNode(unsigned char data, unsigned freq) {
+    struct MinHeapNode* temp = (struct MinHeapNode*) malloc(sizeof(struct MinHeapNode));
+    temp->left = temp->right = NULL;
+    temp->data = data;
+    temp->freq = freq;
+    return temp;
+}
+
+struct MinHeap* createMinHeap(unsigned capacity) {
+    struct MinHeap* minHeap = (struct MinHeap*) malloc(sizeof(struct MinHeap));
+    minHeap->size = 0;
+    minHeap->capacity = capacity;
+    minHeap->array = (struct MinHeapNode**) malloc(minHeap->capacity * sizeof(struct MinHeapNode*));
+    return minHeap;
+}
+
+void swapMinHeapNode(struct MinHeapNode** a, struct MinHeapNode** b) {
+    struct MinHeapNode* t = *a;
+    *a = *b;
+    *b = t;
+}
+
+void minHeapify(struct MinHeap* minHeap, int idx) {
+    int smallest = idx;
+    unsigned left = 2 * (unsigned)idx + 1;
+    unsigned right = 2 * (unsigned)idx + 2;
+
+    if (left < minHeap->size && minHeap->array[left]->freq < minHeap->array[smallest]->freq)
+        smallest = left;
+
+    if (right < minHeap->size && minHeap->array[right]->freq < minHeap->array[smallest]->freq)
+        smallest = right;
+
+    if (smallest != idx) {
+        swapMinHeapNode(&minHeap->array[smallest], &minHeap->array[idx]);
+        minHeapify(minHeap, smallest);
+    }
+}
+
+struct MinHeapNode* extractMin(struct MinHeap* minHeap) {
+    struct MinHeapNode* temp = minHeap->array[0];
+    minHeap->array[0] = minHeap->array[minHeap->size - 1];
+    --minHeap->size;
+    minHeapify(minHeap, 0);
+    return temp;
+}
+
+void insertMinHeap(struct MinHeap* minHeap, struct MinHeapNode* minHeapNode) {
+    ++minHeap->size;
+    int i = minHeap->size - 1;
+    while (i && minHeapNode->freq < minHeap->array[(i - 1) / 2]->freq) {
+        minHeap->array[i] = minHeap->array[(i - 1) / 2];
+        i = (i - 1) / 2;
+    }
+    minHeap->array[i] = minHeapNode;
+}
+
+void buildMinHeap(struct MinHeap* minHeap) {
+    int n = minHeap->size - 1;
+    for (int i = (n - 1) / 2; i >= 0; --i)
+        minHeapify(minHeap, i);
+}
+
+struct MinHeap* createAndBuildMinHeap(unsigned char data[], unsigned freq[], int size) {
+    struct MinHeap* minHeap = createMinHeap(size);
+    for (int i = 0; i < size; ++i)
+        minHeap->array[i] = newNode(data[i], freq[i]);
+    minHeap->size = size;
+    buildMinHeap(minHeap);
+    return minHeap;
+}
+
+struct MinHeapNode* buildHuffmanTree(unsigned char data[], unsigned freq[], int size) {
+    struct MinHeapNode *left, *right, *top;
+    struct MinHeap* minHeap = createAndBuildMinHeap(data, freq, size);
+    while (minHeap->size != 1) {
+        left = extractMin(minHeap);
+        right = extractMin(minHeap);
+        top = newNode('$', left->freq + right->freq);
+        top->left = left;
+        top->right = right;
+        insertMinHeap(minHeap, top);
+    }
+    struct MinHeapNode* root = extractMin(minHeap);
+    free(minHeap->array);
+    free(minHeap);
+    return root;
+}
+
+// 빈도 오름차순(같으면 심볼 순) 정렬용 비교 함수. 키는 (빈도 << 9) | 심볼이다.
+int compareSymbolKeys(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return x < y ? -1 : x > y;
+}
+
+// 오름차순으로 정렬된 빈도 배열 A[0..n-1]을 제자리에서 코드 길이로 바꾼다
+// (Moffat-Katajainen). 리프와 내부 노드 두 큐를 같은 배열 위에서 진행하므로
+// 노드 할당이나 힙 없이 O(n)이다. A[i]에는 A[i]의 빈도에 해당하는 코드 길이가 남는다.
+void computeCodeLengthsInPlace(unsigned A[], int n) {
+    if (n == 1) {
+        A[0] = 1;
+        return;
+    }
+    // 1단계: 왼쪽부터 두 개씩 합치며 내부 노드에 부모 위치를 기록
+    A[0] += A[1];
+    int root = 0, leaf = 2;
+    for (int next = 1; next < n - 1; next++) {
+        if (leaf >= n || A[root] < A[leaf]) {
+            A[next] = A[root];
+            A[root++] = next;
+        } else {
+            A[next] = A[leaf++];
+        }
+        if (leaf >= n || (root < next && A[root] < A[leaf])) {
+            A[next] += A[root];
+            A[root++] = next;
+        } else {
+            A[next] += A[leaf++];
+        }
+    }
+    // 2단계: 오른쪽부터 내부 노드의 깊이 계산
+    A[n - 2] = 0;
+    for (int next = n - 3; next >= 0; next--) {
+        A[next] = A[A[next]] + 1;
+    }
+    // 3단계: 깊이별 내부 노드 수로 리프 깊이(코드 길이)를 채움
+    int avail = 1, used = 0, depth = 0, next = n - 1;
+    root = n - 2;
+    while (avail > 0) {
+        while (root >= 0 && (int)A[root] == depth) {
+            used++;
+            root--;
+        }
+        while (avail > used) {
+            A[next--] = (unsigned)depth;
+            avail--;
+        }
+        avail = 2 * used;
+        depth++;
+        used = 0;
+    }
+}
+
+// 길이 제한 하프만 코드 (package-merge). 오름차순으로 정렬된 n개의 빈도에 대해
+// maxLength 이하에서 최적인 코드 길이를 lengths[i]에 채운다. n <= 2^maxLength여야 한다.
+// 단계마다 이전 목록의 두 항목을 묶은 꾸러미와 리프를 병합하며, 각 항목이 리프인지만
+// 기록해 두었다가 마지막 목록의 앞 2n-2개에서 거꾸로 따라가며 리프가 쓰인 횟수를 센다.
+void packageMerge(const unsigned weights[], int n, int maxLength, unsigned lengths[]) {
+    uint64_t prev[2 * ADV_MAX_SYMBOLS];
+    uint64_t cur[2 * ADV_MAX_SYMBOLS];
+    unsigned char isLeaf[ADV_CODE_LIMIT_MAX][2 * ADV_MAX_SYMBOLS];
+    int count[ADV_CODE_LIMIT_MAX];
+
+    for (int i = 0; i < n; i++) {
+        prev[i] = weights[i];
+        isLeaf[0][i] = 1;
+    }
+    count[0] = n;
+    for (int level = 1; level < maxLength; level++) {
+        int packages = count[level - 1] / 2;
+        int leaf = 0, pkg = 0, k = 0;
+        while (leaf < n || pkg < packages) {
+            uint64_t pkgWeight = pkg < packages ? prev[2 * pkg] + prev[2 * pkg + 1] : UINT64_MAX;
+            if (leaf < n && weights[leaf] <= pkgWeight) {
+                cur[k] = weights[leaf++];
+                isLeaf[level][k++] = 1;
+            } else {
+                cur[k] = pkgWeight;
+                isLeaf[level][k++] = 0;
+                pkg++;
+            }
+        }
+        count[level] = k;
+        memcpy(prev, cur, k * sizeof(cur[0]));
+    }
+
+    for (int i = 0; i < n; i++) lengths[i] = 0;
+    int take = 2 * n - 2;
+    for (int level = maxLength - 1; level >= 0 && take > 0; level--) {
+        int leaves = 0;
+        for (int k = 0; k < take; k++) leaves += isLeaf[level][k];
+        for (int i = 0; i < leaves; i++) lengths[i]++;
+        take = 2 * (take - leaves);
+    }
+}
+
+// 빈도표로 symbolCount개 심볼의 하프만 코드 길이를 만든다 (나오지 않은 심볼은 길이 0)
+// 최적 길이가 maxLength를 넘으면 package-merge로 길이 제한 코드를 다시 만든다.
+// 스택 배열만 쓰므로 블록마다, 여러 작업에서 동시에 불러도 할당이 없다.
+void buildCodeLengths(const unsigned freq[], int symbolCount, unsigned char lengths[], int maxLength) {
+    uint64_t keys[ADV_MAX_SYMBOLS];
+    unsigned work[ADV_MAX_SYMBOLS];
+    int n = 0;
+    memset(lengths, 0, symbolCount);
+    for (int i = 0; i < symbolCount; i++) {
+        if (freq[i] > 0) keys[n++] = ((uint64_t)freq[i] << 9) | (uint64_t)i;
+    }
+    if (n == 0) return;
+    qsort(keys, n, sizeof(keys[0]), compareSymbolKeys);
+    for (int i = 0; i < n; i++) work[i] = (unsigned)(keys[i] >> 9);
+    computeCodeLengthsInPlace(work, n);
+
+    // 정렬된 순서에서 가장 빈도가 낮은 심볼(맨 앞)이 가장 긴 코드를 받는다.
+    // 심볼이 2^maxLength개보다 많으면 가능한 가장 작은 상한으로 올린다.
+    while ((1 << maxLength) < n) maxLength++;
+    if ((int)work[0] > maxLength) {
+        unsigned weights[ADV_MAX_SYMBOLS];
+        for (int i = 0; i < n; i++) weights[i] = (unsigned)(keys[i] >> 9);
+        packageMerge(weights, n, maxLength, work);
+    }
+    for (int i = 0; i < n; i++) lengths[keys[i] & 0x1FF] = (unsigned char)work[i];
+}
+
+// 코드 길이가 접두어 코드를 이룰 수 있는지(크래프트 부등식) 확인한다.
+// 손상된 파일의 길이표로 디코딩 테이블 밖을 쓰지 않도록 읽을 때마다 검사한다.
+int validateCodeLengths(const unsigned char lengths[], int symbolCount) {
+    uint64_t kraft = 0;
+    for (int i = 0; i < symbolCount; i++) {
+        if (lengths[i] == 0) continue;
+        if (lengths[i] > MAX_CODE_LEN) return 0;
+        kraft += (uint64_t)1 << (MAX_CODE_LEN - lengths[i]);
+        if (kraft > ((uint64_t)1 << MAX_CODE_LEN)) return 0;
+    }
+    return 1;
+}
+
+// 코드 길이만으로 정규(canonical) 하프만 코드를 배정한다.
+// 길이가 짧은 순, 같은 길이에서는 심볼 값 순으로 연속된 코드 값을 받는다.
+void assignCanonicalCodes(const unsigned char lengths[], int symbolCount, uint64_t codes[]) {
+    unsigned lengthCount[MAX_CODE_LEN + 1] = {0};
+    uint64_t nextCode[MAX_CODE_LEN + 1];
+    for (int i = 0; i < symbolCount; i++) lengthCount[lengths[i]]++;
+    lengthCount[0] = 0;
+
+    uint64_t code = 0;
+    for (int len = 1; len <= MAX_CODE_LEN; len++) {
+        code = (code + lengthCount[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+    for (int i = 0; i < symbolCount; i++) {
+        codes[i] = lengths[i] ? nextCode[lengths[i]]++ : 0;
+    }
+}
+
+// 이전 형식(.adv v0) 해제용: 저장된 빈도로 힙 트리를 다시 만들어
+// 트리 경로 그대로의 코드와 길이를 수집한다
+void collectTreeCodes(struct MinHeapNode* root, uint64_t code, int depth, uint64_t codes[], unsigned char lengths[]) {
+    if (!root->left && !root->right) {
+        codes[root->data] = code;
+        lengths[root->data] = (unsigned char)depth;
+        return;
+    }
+    if (depth >= MAX_CODE_LEN) return; // 비트 버퍼에 담을 수 없는 코드는 버린다
+    collectTreeCodes(root->left, code << 1, depth + 1, codes, lengths);
+    collectTreeCodes(root->right, (code << 1) | 1, depth + 1, codes, lengths);
+}
+
+void freeHuffmanTree(struct MinHeapNode* root) {
+    if (root == NULL) return;
+    freeHuffmanTree(root->left);
+    freeHuffmanTree(root->right);
+    free(root);
+}
+
+// 하프만 압축 함수 (64비트 누산기로 비트 패킹)
+// 코드를 누산기 하위 비트에 이어 붙이고 32비트가 모일 때마다 한 워드씩 내보낸다.
+// output은 최소 size * 9 / 8 + 8 바이트여야 한다 (하프만 평균 길이는 9비트 미만).
+size_t huffmanEncode(const unsigned char* input, size_t size, unsigned char* output, const uint64_t codes[], const unsigned char lengths[]) {
+    size_t outIdx = 0;
+    uint64_t bitBuf = 0; // 하위 bitCount 비트가 아직 내보내지 않은 비트
+    int bitCount = 0;
+    size_t i = 0;
+
+    // 길이 제한 코드(16비트 이하)는 두 개를 붙여도 32비트를 넘지 않으므로
+    // 분기 없이 두 심볼마다 한 번만 내보낸다
+    int maxLength = 0;
+    for (int c = 0; c < 256; c++) {
+        if (lengths[c] > maxLength) maxLength = lengths[c];
+    }
+    if (maxLength <= 16) {
+        for (; i + 2 <= size; i += 2) {
+            int len0 = lengths[input[i]];
+            int len1 = lengths[input[i + 1]];
+            bitBuf = (bitBuf << len0) | codes[input[i]];
+            bitBuf = (bitBuf << len1) | codes[input[i + 1]];
+            bitCount += len0 + len1;
+            if (bitCount >= 32) {
+                bitCount -= 32;
+                uint32_t word = (uint32_t)(bitBuf >> bitCount);
+                output[outIdx++] = (unsigned char)(word >> 24);
+                output[outIdx++] = (unsigned char)(word >> 16);
+                output[outIdx++] = (unsigned char)(word >> 8);
+                output[outIdx++] = (unsigned char)word;
+            }
+        }
+    }
+
+    for (; i < size; i++) {
+        uint64_t code = codes[input[i]];
+        int len = lengths[input[i]];
+        if (len > 32) {
+            // 긴 코드는 상위 부분을 먼저 붙여 누산기 넘침을 막는다
+            bitBuf = (bitBuf << (len - 32)) | (code >> 32);
+            bitCount += len - 32;
+            if (bitCount >= 32) {
+                bitCount -= 32;
+                uint32_t word = (uint32_t)(bitBuf >> bitCount);
+                output[outIdx++] = (unsigned char)(word >> 24);
+                output[outIdx++] = (unsigned char)(word >> 16);
+                output[outIdx++] = (unsigned char)(word >> 8);
+                output[outIdx++] = (unsigned char)word;
+            }
+            code &= 0xFFFFFFFFu;
+            len = 32;
+        }
+        bitBuf = (bitBuf << len) | code;
+        bitCount += len;
+        if (bitCount >= 32) {
+            bitCount -= 32;
+            uint32_t word = (uint32_t)(bitBuf >> bitCount);
+            output[outIdx++] = (unsigned char)(word >> 24);
+            output[outIdx++] = (unsigned char)(word >> 16);
+            output[outIdx++] = (unsigned char)(word >> 8);
+            output[outIdx++] = (unsigned char)word;
+        }
+    }
+
+    // 마지막에 남은 비트가 있으면 0으로 패딩하여 저장
+    while (bitCount >= 8) {
+        bitCount -= 8;
+        output[outIdx++] = (unsigned char)(bitBuf >> bitCount);
+    }
+    if (bitCount > 0) {
+        output[outIdx++] = (unsigned char)(bitBuf << (8 - bitCount));
+    }
+
+    return outIdx;
+}
+
+// 코드와 길이로 룩업 테이블을 채운다. 접두어 코드이기만 하면 되므로
+// 정규 코드와 이전 형식의 트리 코드 모두 같은 방식으로 처리된다.
+void buildDecodeTable(const uint64_t codes[], const unsigned char lengths[], int symbolCount, struct HuffDecodeEntry* table, struct HuffLongCodes* longCodes) {
+    memset(table, 0, (1u << HUFF_TABLE_BITS) * sizeof(struct HuffDecodeEntry));
+    longCodes->count = 0;
+    for (int i = 0; i < symbolCount; i++) {
+        int len = lengths[i];
+        if (len == 0) continue;
+        if (len > HUFF_TABLE_BITS) {
+            longCodes->code[longCodes->count] = codes[i];
+            longCodes->length[longCodes->count] = (unsigned char)len;
+            longCodes->symbol[longCodes->count] = (uint16_t)i;
+            longCodes->count++;
+            continue;
+        }
+        // 코드 뒤에 올 수 있는 모든 비트 조합을 같은 심볼로 채움
+        int shift = HUFF_TABLE_BITS - len;
+        unsigned first = (unsigned)codes[i] << shift;
+        for (unsigned j = 0; j < (1u << shift); j++) {
+            table[first + j].symbol = (uint16_t)i;
+            table[first + j].length = (unsigned char)len;
+        }
+    }
+}
+
+// 하프만 압축 해제 함수 (테이블 기반 다중 비트 디코딩)
+// 64비트 버퍼에 비트를 모아 두고 상위 HUFF_TABLE_BITS 비트로 심볼을 한 번에 찾는다.
+// 비트가 끝나거나 output이 가득 찰 때까지 디코딩하고 복원한 바이트 수를 돌려준다.
+// 크기를 모르는 이전 형식에서는 마지막 바이트의 패딩 비트도 코드가 완성되면 심볼로 해석된다.
+size_t huffmanDecode(const unsigned char* encodedData, size_t encodedSize, const uint64_t codes[], const unsigned char lengths[], unsigned char* output, size_t outputCapacity) {
+    struct HuffDecoder decoder;
+    buildDecodeTable(codes, lengths, 256, decoder.table, &decoder.longCodes);
+    return huffmanDecodeWith(&decoder, encodedData, encodedSize, output, outputCapacity);
+}
+
+// 미리 만든 테이블로 푸는 huffmanDecode (사전처럼 같은 코드를 여러 번 쓸 때)
+size_t huffmanDecodeWith(const struct HuffDecoder* decoder, const unsigned char* encodedData, size_t encodedSize, unsigned char* output, size_t outputCapacity) {
+    const struct HuffDecodeEntry* table = decoder->table;
+    const struct HuffLongCodes* longCodes = &decoder->longCodes;
+    size_t outIdx = 0;
+    uint64_t bitBuf = 0; // 상위 비트부터 채워지는 비트 버퍼
+    int bitCount = 0;
+    size_t inPos = 0;
+
+    while (outIdx < outputCapacity) {
+        while (bitCount <= 56 && inPos < encodedSize) {
+            bitBuf |= (uint64_t)encodedData[inPos++] << (56 - bitCount);
+            bitCount += 8;
+        }
+        if (bitCount == 0) break;
+
+        const struct HuffDecodeEntry* entry = &table[bitBuf >> (64 - HUFF_TABLE_BITS)];
+        int len = entry->length;
+        unsigned char symbol = (unsigned char)entry->symbol;
+        if (len == 0) {
+            // 긴 코드: 남은 비트 안에서 일치하는 코드를 찾는다
+            unsigned k;
+            for (k = 0; k < longCodes->count; k++) {
+                int longLen = longCodes->length[k];
+                if (longLen <= bitCount && (bitBuf >> (64 - longLen)) == longCodes->code[k]) break;
+            }
+            if (k == longCodes->count) break; // 코드 도중에 데이터가 끝남
+            len = longCodes->length[k];
+            symbol = (unsigned char)longCodes->symbol[k];
+        } else if (len > bitCount) {
+            break; // 남은 비트는 패딩
+        }
+        output[outIdx++] = symbol;
+        bitBuf <<= len;
+        bitCount -= len;
+    }
+
+    return outIdx;
+}
+
+void putBits(struct BitWriter* w, uint32_t value, int length) {
+    w->buf = (w->buf << length) | value;
+    w->count += length;
+    if (w->count >= 32) {
+        w->count -= 32;
+        uint32_t word = (uint32_t)(w->buf >> w->count);
+        w->out[w->pos++] = (unsigned char)(word >> 24);
+        w->out[w->pos++] = (unsigned char)(word >> 16);
+        w->out[w->pos++] = (unsigned char)(word >> 8);
+        w->out[w->pos++] = (unsigned char)word;
+    }
+}
+
+void flushBits(struct BitWriter* w) {
+    while (w->count >= 8) {
+        w->count -= 8;
+        w->out[w->pos++] = (unsigned char)(w->buf >> w->count);
+    }
+    if (w->count > 0) {
+        w->out[w->pos++] = (unsigned char)(w->buf << (8 - w->count));
+        w->count = 0;
+    }
+}
+
+void refillBits(struct BitReader* r) {
+    while (r->count <= 56) {
+        uint64_t byte = r->pos < r->size ? r->in[r->pos] : 0;
+        r->pos++;
+        r->buf |= byte << (56 - r->count);
+        r->count += 8;
+    }
+}
+
+uint32_t getBits(struct BitReader* r, int length) {
+    if (length == 0) return 0;
+    if (r->count < length) refillBits(r);
+    uint32_t value = (uint32_t)(r->buf >> (64 - length));
+    r->buf <<= length;
+    r->count -= length;
+    return value;
+}
+
+int bitReaderOverrun(const struct BitReader* r) {
+    return (uint64_t)r->pos * 8 - (uint64_t)r->count > (uint64_t)r->size * 8;
+}
+
+// 테이블로 심볼 하나를 읽는다 (길이표에 없는 비트열이면 -1)
+int decodeSymbol(struct BitReader* r, const struct HuffDecodeEntry* table, const struct HuffLongCodes* longCodes) {
+    if (r->count < MAX_CODE_LEN) refillBits(r);
+    const struct HuffDecodeEntry* entry = &table[r->buf >> (64 - HUFF_TABLE_BITS)];
+    int length = entry->length;
+    int symbol = entry->symbol;
+    if (length == 0) {
+        unsigned k;
+        for (k = 0; k < longCodes->count; k++) {
+            int longLength = longCodes->length[k];
+            if ((r->buf >> (64 - longLength)) == longCodes->code[k]) break;
+        }
+        if (k == longCodes->count) return -1;
+        length = longCodes->length[k];
+        symbol = longCodes->symbol[k];
+    }
+    r->buf <<= length;
+    r->count -= length;
+    return symbol;
+}
+
+// 압축된 코드 길이표 (v3): deflate와 같이 길이 0~15와 반복 부호 16(앞 길이 3~6번),
+// 17(0을 3~10번), 18(0을 11~138번)로 줄인 뒤 그 19개 심볼을 다시 하프만으로 부호화한다.
+// [4비트 길이 부호 수 - 4][길이 부호의 길이 3비트씩 (packedOrder 순서)][부호화된 길이들]
+const unsigned char packedOrder[PACKED_CODE_SYMBOLS] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+const unsigned char packedExtraBits[3] = { 2, 3, 7 };
+const unsigned char packedRunBase[3] = { 3, 3, 11 };
+
+// lengths[0..count)를 반복 부호로 바꾼다. 심볼 수를 돌려주고 extra에는 반복 횟수 - 기준값을 둔다.
+int runLengthCodeLengths(const unsigned char lengths[], int count, unsigned char symbols[], unsigned char extra[]) {
+    int n = 0;
+    for (int i = 0; i < count;) {
+        int value = lengths[i];
+        int run = 1;
+        while (i + run < count && lengths[i + run] == value) run++;
+        i += run;
+        if (value == 0) {
+            while (run >= 11) {
+                int take = run < 138 ? run : 138;
+                symbols[n] = 18;
+                extra[n++] = (unsigned char)(take - 11);
+                run -= take;
+            }
+            if (run >= 3) {
+                symbols[n] = 17;
+                extra[n++] = (unsigned char)(run - 3);
+                run = 0;
+            }
+        } else {
+            symbols[n] = (unsigned char)value;
+            extra[n++] = 0;
+            run--;
+            while (run >= 3) {
+                int take = run < 6 ? run : 6;
+                symbols[n] = 16;
+                extra[n++] = (unsigned char)(take - 3);
+                run -= take;
+            }
+        }
+        while (run-- > 0) {
+            symbols[n] = (unsigned char)value;
+            extra[n++] = 0;
+        }
+    }
+    return n;
+}
+
+// 압축된 코드 길이표를 기록하고 바이트 수를 돌려준다 (바이트 경계로 패딩)
+size_t writePackedLengths(const unsigned char lengths[], int count, unsigned char* out) {
+    unsigned char symbols[ADV_PACKED_LENGTHS_COUNT_MAX];
+    unsigned char extra[ADV_PACKED_LENGTHS_COUNT_MAX];
+    int n = runLengthCodeLengths(lengths, count, symbols, extra);
+
+    unsigned freq[PACKED_CODE_SYMBOLS] = {0};
+    for (int i = 0; i < n; i++) freq[symbols[i]]++;
+    unsigned char codeLengths[PACKED_CODE_SYMBOLS];
+    uint64_t codes[PACKED_CODE_SYMBOLS];
+    buildCodeLengths(freq, PACKED_CODE_SYMBOLS, codeLengths, PACKED_CODE_MAX_LENGTH);
+    // 심볼이 하나뿐이면 길이 0 대신 1비트 코드를 준다
+    for (int s = 0; s < PACKED_CODE_SYMBOLS; s++) {
+        if (freq[s] && codeLengths[s] == 0) codeLengths[s] = 1;
+    }
+    assignCanonicalCodes(codeLengths, PACKED_CODE_SYMBOLS, codes);
+
+    int stored = PACKED_CODE_SYMBOLS;
+    while (stored > 4 && codeLengths[packedOrder[stored - 1]] == 0) stored--;
+    struct BitWriter writer = { out, 0, 0, 0 };
+    putBits(&writer, (uint32_t)(stored - 4), 4);
+    for (int i = 0; i < stored; i++) putBits(&writer, codeLengths[packedOrder[i]], 3);
+    for (int i = 0; i < n; i++) {
+        int s = symbols[i];
+        putBits(&writer, (uint32_t)codes[s], codeLengths[s]);
+        if (s >= 16) putBits(&writer, extra[i], packedExtraBits[s - 16]);
+    }
+    flushBits(&writer);
+    return writer.pos;
+}
+
+// 압축된 코드 길이표를 읽어 lengths[0..count)를 채우고 읽은 바이트 수를 돌려준다 (오류 시 0)
+size_t readPackedLengths(const unsigned char* in, size_t avail, unsigned char lengths[], int count) {
+    struct BitReader reader = { in, avail, 0, 0, 0 };
+    unsigned char codeLengths[PACKED_CODE_SYMBOLS] = {0};
+    uint64_t codes[PACKED_CODE_SYMBOLS];
+    int stored = (int)getBits(&reader, 4) + 4;
+    for (int i = 0; i < stored; i++) codeLengths[packedOrder[i]] = (unsigned char)getBits(&reader, 3);
+    if (!validateCodeLengths(codeLengths, PACKED_CODE_SYMBOLS)) return 0;
+    assignCanonicalCodes(codeLengths, PACKED_CODE_SYMBOLS, codes);
+    struct HuffDecodeEntry table[1u << HUFF_TABLE_BITS];
+    struct HuffLongCodes longCodes;
+    buildDecodeTable(codes, codeLengths, PACKED_CODE_SYMBOLS, table, &longCodes);
+
+    for (int i = 0; i < count;) {
+        int s = decodeSymbol(&reader, table, &longCodes);
+        if (s < 0) return 0;
+        if (s < 16) {
+            lengths[i++] = (unsigned char)s;
+            continue;
+        }
+        if (s == 16 && i == 0) return 0; // 반복할 앞 길이가 없음
+        int run = packedRunBase[s - 16] + (int)getBits(&reader, packedExtraBits[s - 16]);
+        if (run > count - i) return 0;
+        unsigned char value = s == 16 ? lengths[i - 1] : 0;
+        memset(&lengths[i], value, (size_t)run);
+        i += run;
+    }
+    if (bitReaderOverrun(&reader)) return 0;
+    return (size_t)(((uint64_t)reader.pos * 8 - (uint64_t)reader.count + 7) / 8);
+}
+
+// 블록을 ADV_HUFF_STREAMS개의 연속 구간으로 나눈 구간 k의 시작 위치
+size_t streamStart(size_t size, int k) {
+    size_t segment = (size + ADV_HUFF_STREAMS - 1) / ADV_HUFF_STREAMS;
+    size_t start = segment * (size_t)k;
+    return start < size ? start : size;
+}
+
+// 다중 스트림 하프만 압축: 구간마다 따로 huffmanEncode하고 앞에 점프 테이블
+// (마지막을 뺀 스트림들의 바이트 수, 4바이트씩)을 붙인다.
+// output은 최소 size * 9 / 8 + ADV_HUFF_JUMP_SIZE + 8 * ADV_HUFF_STREAMS 바이트여야 한다.
+size_t huffmanEncodeStreams(const unsigned char* input, size_t size, unsigned char* output, const uint64_t codes[], const unsigned char lengths[]) {
+    size_t outIdx = ADV_HUFF_JUMP_SIZE;
+    for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+        size_t start = streamStart(size, k);
+        size_t streamSize = huffmanEncode(&input[start], streamStart(size, k + 1) - start, &output[outIdx], codes, lengths);
+        if (k < ADV_HUFF_STREAMS - 1) putLE32(&output[4 * k], (uint32_t)streamSize);
+        outIdx += streamSize;
+    }
+    return outIdx;
+}
+
+uint64_t loadBE64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+// 스트림 끝 근처에서 쓰는 읽기: 끝을 넘는 바이트는 0으로 본다
+uint64_t loadBE64Tail(const unsigned char* p, const unsigned char* end) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | (p + i < end ? p[i] : 0);
+    return v;
+}
+
+// 스트림의 남은 심볼을 하나씩 푼다. 긴 코드도 처리한다. 실패하면 0을 돌려준다.
+int decodeStreamTail(struct HuffStream* s, const struct HuffDecodeEntry* table, const struct HuffLongCodes* longCodes) {
+    while (s->out < s->outEnd) {
+        s->ptr += s->consumed >> 3;
+        s->consumed &= 7;
+        if (s->ptr >= s->end) return 0;
+        uint64_t bits = loadBE64Tail(s->ptr, s->end) << s->consumed;
+        const struct HuffDecodeEntry* entry = &table[bits >> (64 - HUFF_TABLE_BITS)];
+        unsigned len = entry->length;
+        unsigned char symbol = (unsigned char)entry->symbol;
+        if (len == 0) {
+            unsigned k;
+            for (k = 0; k < longCodes->count; k++) {
+                int longLen = longCodes->length[k];
+                if ((bits >> (64 - longLen)) == longCodes->code[k]) break;
+            }
+            if (k == longCodes->count) return 0;
+            len = longCodes->length[k];
+            symbol = (unsigned char)longCodes->symbol[k];
+        }
+        *s->out++ = symbol;
+        s->consumed += len;
+    }
+    // 스트림 길이를 넘어 읽었으면 손상된 데이터
+    return (size_t)(s->end - s->ptr) * 8 >= s->consumed;
+}
+
+// 다중 스트림 하프만 해제. output에 정확히 size 바이트를 복원한다.
+// 스트림끼리는 의존성이 없으므로 네 스트림에서 번갈아 심볼을 꺼내면 한 코어에서도
+// 여러 테이블 조회가 동시에 진행된다. 모든 코드가 테이블 안에 들면 한 번 읽은 64비트로
+// 스트림마다 심볼 다섯 개(최대 55비트)를 풀고, 끝 부분과 긴 코드는 하나씩 푼다.
+int huffmanDecodeStreams(const unsigned char* encoded, size_t encodedSize, const uint64_t codes[], const unsigned char lengths[], unsigned char* output, size_t size) {
+    struct HuffDecoder decoder;
+    buildDecodeTable(codes, lengths, 256, decoder.table, &decoder.longCodes);
+    return huffmanDecodeStreamsWith(&decoder, encoded, encodedSize, output, size);
+}
+
+// 점프 테이블을 읽어 스트림마다 입력 구간과 출력 구간을 정한다 (점프 테이블이 맞지 않으면 0)
+int openHuffStreams(const unsigned char* encoded, size_t encodedSize, unsigned char* output, size_t size, struct HuffStream streams[]) {
+    if (encodedSize < ADV_HUFF_JUMP_SIZE) return 0;
+    size_t pos = ADV_HUFF_JUMP_SIZE;
+    for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+        size_t streamSize = k < ADV_HUFF_STREAMS - 1 ? getLE32(&encoded[4 * k]) : encodedSize - pos;
+        if (streamSize > encodedSize - pos) return 0;
+        streams[k].ptr = &encoded[pos];
+        streams[k].end = &encoded[pos + streamSize];
+        streams[k].consumed = 0;
+        streams[k].out = &output[streamStart(size, k)];
+        streams[k].outEnd = &output[streamStart(size, k + 1)];
+        pos += streamSize;
+    }
+    return 1;
+}
+
+int huffmanDecodeStreamsWith(const struct HuffDecoder* decoder, const unsigned char* encoded, size_t encodedSize, unsigned char* output, size_t size) {
+    const struct HuffDecodeEntry* table = decoder->table;
+    const struct HuffLongCodes* longCodes = &decoder->longCodes;
+    struct HuffStream streams[ADV_HUFF_STREAMS];
+    if (!openHuffStreams(encoded, encodedSize, output, size, streams)) return ADV_ERR_FORMAT;
+
+    if (longCodes->count == 0) {
+        // 각 스트림에 8바이트 읽기와 심볼 다섯 개 분량이 남아 있는 동안
+        unsigned bad = 0;
+        for (;;) {
+            int ready = 1;
+            for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+                struct HuffStream* s = &streams[k];
+                s->ptr += s->consumed >> 3;
+                s->consumed &= 7;
+                if (s->end - s->ptr < 8 || s->outEnd - s->out < 5) ready = 0;
+            }
+            if (!ready) break;
+            uint64_t bits[ADV_HUFF_STREAMS];
+            for (int k = 0; k < ADV_HUFF_STREAMS; k++) bits[k] = loadBE64(streams[k].ptr) << streams[k].consumed;
+            for (int n = 0; n < 5; n++) {
+                for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+                    const struct HuffDecodeEntry* entry = &table[bits[k] >> (64 - HUFF_TABLE_BITS)];
+                    unsigned len = entry->length;
+                    *streams[k].out++ = (unsigned char)entry->symbol;
+                    bits[k] <<= len;
+                    streams[k].consumed += len;
+                    bad |= len == 0; // 길이표에 없는 비트열
+                }
+            }
+        }
+        if (bad) return ADV_ERR_FORMAT;
+    }
+
+    for (int k = 0; k < ADV_HUFF_STREAMS; k++) {
+        if (!decodeStreamTail(&streams[k], table, longCodes)) return ADV_ERR_FORMAT;
+    }
+    return ADV_OK;
+}
+
+// 빈도 계산용 보조 히스토그램 수. 같은 바이트가 이어져도 증가 연산이
+// 서로 다른 카운터에 나뉘어 저장-적재 의존성이 한 줄로 길어지지 않는다.
+#define HIST_LANES 4
+#define HIST_SLICE (CHUNK * 4) // CRC와 빈도를 번갈아 구하는 단위 (L2 캐시에 머무는 크기)
+
+// 8바이트씩 읽어 보조 히스토그램에 번갈아 센다 (words개 워드)
+void countWords(unsigned sub[HIST_LANES][256], const unsigned char* input, size_t words) {
+    for (size_t w = 0; w < words; w++) {
+        uint64_t v;
+        memcpy(&v, input + w * 8, 8);
+        sub[0][v & 0xFF]++;
+        sub[1][(v >> 8) & 0xFF]++;
+        sub[2][(v >> 16) & 0xFF]++;
+        sub[3][(v >> 24) & 0xFF]++;
+        sub[0][(v >> 32) & 0xFF]++;
+        sub[1][(v >> 40) & 0xFF]++;
+        sub[2][(v >> 48) & 0xFF]++;
+        sub[3][v >> 56]++;
+    }
+}
+
+// 구간 전체를 보조 히스토그램에 더한다 (8바이트 워드 뒤의 꼬리 바이트 포함)
+void countBytesScalar(unsigned sub[HIST_LANES][256], const unsigned char* input, size_t size) {
+    size_t words = size / 8;
+    countWords(sub, input, words);
+    for (size_t i = words * 8; i < size; i++) sub[0][input[i]]++;
+}
+
+// 빈도 계산과 함께 checksum(NULL이 아니면)에 원본의 CRC32C를 이어서 계산한다.
+// HIST_SLICE 단위로 CRC와 빈도를 번갈아 구하므로 두 번째 읽기는 캐시에서 이루어지고
+// 메모리에서는 데이터를 한 번만 가져온다. 바이트 히스토그램은 흩어진 카운터 증가라서 SIMD로 나눠
+// 세어도 다시 합치는 비용이 더 커, 모든 CPU에서 스칼라 다중 히스토그램 하나를 쓴다.
+void calculateFrequencyChecksum(const unsigned char* input, size_t size, unsigned freq[], uint32_t* checksum) {
+    unsigned sub[HIST_LANES][256];
+    memset(sub, 0, sizeof(sub));
+    for (size_t pos = 0; pos < size; pos += HIST_SLICE) {
+        size_t n = size - pos < HIST_SLICE ? size - pos : HIST_SLICE;
+        if (checksum) *checksum = crc32cUpdate(*checksum, input + pos, n);
+        countBytesScalar(sub, input + pos, n);
+    }
+    for (int c = 0; c < 256; c++) {
+        freq[c] = sub[0][c] + sub[1][c] + sub[2][c] + sub[3][c];
+    }
+}
+
+// 하프만 압축을 위한 빈도 계산
+void calculateFrequency(const unsigned char* input, size_t size, unsigned freq[]) {
+    calculateFrequencyChecksum(input, size, freq, NULL);
+}
@@ -0,0 +1,338 @@
+#ifndef ADV_INTERNAL_H
+#define ADV_INTERNAL_H
+
+// 코덱 라이브러리 내부 공용 정의: 형식 상수, 하프만 단계 함수, 워커 풀
+// 라이브러리 소스끼리만 공유하며 GUI와 명령행 도구는 adv_codec.h만 사용한다.
+
+#include <stdint.h>
+#include "adv_codec.h"
+
+#define CHUNK 16384
+#define MAX_CODE_LEN 57 // 64비트 비트 버퍼로 한 번에 다룰 수 있는 최대 코드 길이 (이전 형식 해제용)
+#define HUFF_TABLE_BITS 11
+#define ADV_MAX_SYMBOLS 288 // 하프만 알파벳의 최대 크기 (LZ 리터럴/길이 알파벳 포함)
+
+// .adv 파일 헤더: [매직 4][버전][플래그]
+// 매직이 없는 파일은 빈도표를 그대로 담던 이전 형식(v0)으로 본다.
+// v1은 파일 전체가 하나의 정규 하프만 블록, v2부터는 블록 단위 프레임이 이어진다.
+// v3은 프레임 구조는 v2와 같고 하프만/LZ 블록의 코드 길이표를 압축해 저장한다.
+// v4는 프레임 페이로드 끝에 원본 블록의 CRC32C를, 끝 프레임 뒤에 원본 전체의 CRC32C를 둔다.
+#define ADV_MAGIC "ADV\x1a"
+#define ADV_MAGIC_SIZE 4
+#define ADV_FORMAT_VERSION 4
+#define ADV_FORMAT_FRAMED 2   // 블록 프레임을 쓰는 첫 버전
+#define ADV_FORMAT_CHECKSUM 4 // 블록과 파일 체크섬을 쓰는 첫 버전
+#define ADV_FILE_HEADER_SIZE (ADV_MAGIC_SIZE + 2)
+
+// v2 블록 프레임: [블록 종류][원본 크기 4][페이로드 크기 4][페이로드]
+// 블록은 서로 독립적이라 블록 하나 분량의 메모리만으로 스트리밍 처리된다.
+#define ADV_BLOCK_SIZE (CHUNK * 64)
+#define ADV_BLOCK_HEADER_SIZE 9
+#define ADV_CODE_TABLE_MAX (2 + 256 * 2)
+#define ADV_CHECKSUM_SIZE 4
+#define ADV_BLOCK_BOUND(n) (ADV_BLOCK_HEADER_SIZE + ADV_CODE_TABLE_MAX + (n) + (n) / 8 + 8 + ADV_CHECKSUM_SIZE)
+#define ADV_END_FRAME_SIZE (1 + ADV_CHECKSUM_SIZE) // v4 끝 프레임: [0][원본 전체의 CRC32C] (아카이브는 [0]만)
+#define ADV_BLOCKS_PER_WORKER 2 // 스트리밍 처리 시 워커당 한 번에 맡길 블록 수
+
+// 파일 헤더 플래그
+#define ADV_FLAG_INDEX 0x01   // 끝 프레임 뒤에 블록 인덱스가 있음
+#define ADV_FLAG_ARCHIVE 0x02 // 여러 항목을 담은 아카이브 (끝 프레임 뒤에 중앙 디렉터리가 있음)
+
+// 블록 인덱스: [프레임 오프셋 8][원본 크기 4] x 블록 수, 이어서
+// [인덱스 시작 오프셋 8][블록 수 4][인덱스 매직 4] 트레일러가 파일 끝에 온다.
+#define ADV_INDEX_MAGIC "ADVI"
+#define ADV_INDEX_ENTRY_SIZE 12
+#define ADV_INDEX_TRAILER_SIZE 16
+
+// 아카이브 중앙 디렉터리: 항목마다 [이름 길이 2][이름][원본 크기 8][첫 프레임 오프셋 8]
+// [프레임 크기 합 8][블록 수 4][CRC32C 4], 이어서 [디렉터리 시작 오프셋 8][항목 수 4]
+// [디렉터리 매직 4] 트레일러가 파일 끝에 온다. 항목의 프레임은 끝 프레임 없이 바로 이어진다.
+#define ADV_DIR_MAGIC "ADVD"
+#define ADV_DIR_ENTRY_FIXED 34
+#define ADV_DIR_TRAILER_SIZE 16
+#define ADV_DIR_NAME_MAX 4096
+
+enum {
+    ADV_BLOCK_END = 0,     // 스트림 끝 (원본/페이로드 크기 없음)
+    ADV_BLOCK_HUFFMAN = 1, // [코드 길이표][인코딩된 비트]
+    ADV_BLOCK_LZ = 2,      // [리터럴/길이 코드 길이][거리 코드 길이][인코딩된 토큰] (adv_lz.c)
+    ADV_BLOCK_STORED = 3,  // [원본 바이트] (줄어들지 않는 블록)
+    ADV_BLOCK_RUN = 4,     // [바이트 1] (한 바이트가 원본 크기만큼 반복)
+    ADV_BLOCK_HUFFMAN4 = 5, // [코드 길이표][점프 테이블][인코딩된 비트 x ADV_HUFF_STREAMS]
+    ADV_BLOCK_ANS = 6,     // [정규화 빈도표][tANS 비트스트림] (adv_ans.c)
+    ADV_BLOCK_DICT = 7,    // [사전 ID 4][사전 코드로 인코딩된 비트] (adv_dictionary.c)
+    ADV_BLOCK_CONTEXT = 8, // [코드표 수][문맥 지도][코드 길이표 x 코드표 수][점프 테이블][인코딩된 비트 x ADV_HUFF_STREAMS] (adv_context.c)
+    ADV_BLOCK_BWT = 9      // [끝 문자 행 4][심볼 수 4][코드표 수][코드 길이표 x 코드표 수][선택자와 인코딩된 비트] (adv_bwt.c)
+};
+
+// tANS 블록: 빈도를 합이 2^tableLog인 값으로 정규화한다. 해제는 두 상태가 번갈아
+// 한 번 읽은 64비트에서 심볼 네 개를 풀므로 tableLog는 12 이하여야 한다.
+#define ADV_ANS_TABLE_LOG 11
+#define ADV_ANS_MIN_TABLE_LOG 5
+#define ADV_ANS_MAX_TABLE_LOG 12
+
+// 다중 스트림 하프만 블록: 블록을 같은 크기의 연속 구간으로 나눠 구간마다 따로 인코딩한다.
+// 점프 테이블은 마지막을 뺀 스트림들의 바이트 수 (4바이트씩)이다.
+#define ADV_HUFF_STREAMS 4
+#define ADV_HUFF_JUMP_SIZE (4 * (ADV_HUFF_STREAMS - 1))
+#define ADV_HUFF_STREAMS_MIN 1024 // 이보다 작은 블록은 단일 스트림으로 충분하다
+
+// 문맥 하프만 블록: 앞 바이트 256개를 다음 바이트 분포가 비슷한 것끼리 묶어 묶음마다 코드표를 둔다.
+// 문맥 지도(앞 바이트마다 묶음 번호)는 코드 길이표와 같은 방식으로 압축해 저장한다.
+// 스트림은 다중 스트림 하프만 블록과 같이 나누며, 스트림마다 문맥 0에서 시작한다.
+#define ADV_CONTEXT_TABLES 8        // 코드표 수 상한 (2 이상)
+#define ADV_CONTEXT_MIN_SIZE 4096   // 이보다 작은 블록은 코드표 비용이 이득보다 크다
+
+// 블록 정렬 블록: MTF 순위 1~255는 심볼 2~256, 0의 연속은 RUNA/RUNB의 전단사 2진수로 적는다.
+// 해제할 때 행 번호를 24비트에 담으므로 블록은 ADV_BWT_MAX_SIZE보다 작아야 한다.
+#define ADV_BWT_SYMBOLS 257
+#define ADV_BWT_RUNA 0
+#define ADV_BWT_RUNB 1
+#define ADV_BWT_MIN_SIZE 4096
+#define ADV_BWT_GROUP 50 // 이 심볼 수마다 코드표를 새로 고른다
+#define ADV_BWT_TABLES 6 // 코드표 수 상한
+#define ADV_BWT_MAX_SIZE (1u << 24)
+
+// 하프만 블록이 원본보다 1/ADV_STORE_MIN_SAVING 이상 작지 않으면 그대로 저장한다
+#define ADV_STORE_MIN_SAVING 32
+
+// LZ 블록: deflate와 같은 길이/거리 부호를 쓰되 거리는 블록 크기(1 MiB)까지 확장한다.
+// 일치는 블록 안에서만 찾으므로 블록끼리는 계속 독립적이다.
+#define ADV_LZ_MIN_MATCH 3
+#define ADV_LZ_MAX_MATCH 258
+#define ADV_LZ_LITERALS 256
+#define ADV_LZ_LENGTH_CODES 29
+#define ADV_LZ_LITLEN_SYMBOLS (ADV_LZ_LITERALS + ADV_LZ_LENGTH_CODES)
+#define ADV_LZ_DIST_SYMBOLS 40
+// v2 LZ 블록은 코드 길이를 심볼당 4비트로 저장했다 (v3부터는 압축된 길이표)
+#define ADV_LZ_NIBBLE_TABLE_SIZE ((ADV_LZ_LITLEN_SYMBOLS + 1) / 2 + (ADV_LZ_DIST_SYMBOLS + 1) / 2)
+
+// 사전 파일: [매직 4][사전 형식 버전][사전 ID 4][압축된 코드 길이표]
+#define ADV_DICT_MAGIC "ADVT"
+#define ADV_DICT_VERSION 1
+#define ADV_DICT_HEADER_SIZE (ADV_MAGIC_SIZE + 5)
+
+// 하프만 트리 노드 정의 (빈도표를 담은 이전 형식 v0의 코드를 복원할 때만 쓴다)
+struct MinHeapNode {
+    unsigned char data;
+    unsigned freq;
+    struct MinHeapNode *left, *right;
+};
+
+// 하프만 힙 정의
+struct MinHeap {
+    unsigned size;
+    unsigned capacity;
+    struct MinHeapNode **array;
+};
+
+// 테이블 디코딩 엔트리: HUFF_TABLE_BITS 이하 코드의 심볼과 길이 (길이 0이면 긴 코드)
+struct HuffDecodeEntry {
+    uint16_t symbol;
+    unsigned char length;
+};
+
+// HUFF_TABLE_BITS보다 긴 코드 목록 (드물게 나오므로 순차 비교)
+struct HuffLongCodes {
+    unsigned count;
+    uint64_t code[ADV_MAX_SYMBOLS];
+    unsigned char length[ADV_MAX_SYMBOLS];
+    uint16_t symbol[ADV_MAX_SYMBOLS];
+};
+
+// 디코딩 테이블 한 벌. 사전처럼 같은 코드를 여러 블록에 쓰면 한 번 만들어 두고 다시 쓴다.
+struct HuffDecoder {
+    struct HuffDecodeEntry table[1u << HUFF_TABLE_BITS];
+    struct HuffLongCodes longCodes;
+};
+
+// MSB 우선 비트 기록기 (huffmanEncode와 같은 32비트 워드 단위 방출)
+struct BitWriter {
+    unsigned char* out;
+    size_t pos;
+    uint64_t buf;
+    int count;
+};
+
+// MSB 우선 비트 판독기. 입력 끝을 넘으면 0 비트를 채우고, 다 읽은 뒤 overrun으로 확인한다.
+struct BitReader {
+    const unsigned char* in;
+    size_t size;
+    size_t pos;
+    uint64_t buf;
+    int count;
+};
+
+// 다중 스트림 하프만 블록의 스트림 하나의 판독 상태. ptr부터 64비트를 읽어 상위 consumed 비트는 이미 쓴 것으로 본다.
+struct HuffStream {
+    const unsigned char* ptr;
+    const unsigned char* end;
+    unsigned consumed;
+    unsigned char* out;
+    unsigned char* outEnd;
+};
+
+// 압축된 코드 길이표의 반복 부호 알파벳과 그 코드의 길이 상한 (3비트로 저장)
+#define PACKED_CODE_SYMBOLS 19
+#define PACKED_CODE_MAX_LENGTH 7
+// count개 길이의 압축된 표가 차지할 수 있는 최대 바이트 수 (심볼마다 코드 7비트 + 반복 7비트)
+#define ADV_PACKED_LENGTHS_COUNT_MAX (ADV_LZ_LITLEN_SYMBOLS + ADV_LZ_DIST_SYMBOLS)
+#define ADV_PACKED_LENGTHS_MAX(count) ((4 + 3 * PACKED_CODE_SYMBOLS + 14 * (count) + 7) / 8)
+
+// 하프만 단계 (adv_huffman.c)
+struct MinHeapNode* buildHuffmanTree(unsigned char data[], unsigned freq[], int size);
+void freeHuffmanTree(struct MinHeapNode* root);
+void computeCodeLengthsInPlace(unsigned A[], int n);
+void packageMerge(const unsigned weights[], int n, int maxLength, unsigned lengths[]);
+void buildCodeLengths(const unsigned freq[], int symbolCount, unsigned char lengths[], int maxLength);
+int validateCodeLengths(const unsigned char lengths[], int symbolCount);
+void assignCanonicalCodes(const unsigned char lengths[], int symbolCount, uint64_t codes[]);
+void collectTreeCodes(struct MinHeapNode* root, uint64_t code, int depth, uint64_t codes[], unsigned char lengths[]);
+size_t huffmanEncode(const unsigned char* input, size_t size, unsigned char* output, const uint64_t codes[], const unsigned char lengths[]);
+void buildDecodeTable(const uint64_t codes[], const unsigned char lengths[], int symbolCount, struct HuffDecodeEntry* table, struct HuffLongCodes* longCodes);
+size_t huffmanDecode(const unsigned char* encodedData, size_t encodedSize, const uint64_t codes[], const unsigned char lengths[], unsigned char* output, size_t outputCapacity);
+size_t huffmanEncodeStreams(const unsigned char* input, size_t size, unsigned char* output, const uint64_t codes[], const unsigned char lengths[]);
+int huffmanDecodeStreams(const unsigned char* encoded, size_t encodedSize, const uint64_t codes[], const unsigned char lengths[], unsigned char* output, size_t size);
+size_t huffmanDecodeWith(const struct HuffDecoder* decoder, const unsigned char* encodedData, size_t encodedSize, unsigned char* output, size_t outputCapacity);
+int huffmanDecodeStreamsWith(const struct HuffDecoder* decoder, const unsigned char* encoded, size_t encodedSize, unsigned char* output, size_t size);
+size_t streamStart(size_t size, int k);
+int openHuffStreams(const unsigned char* encoded, size_t encodedSize, unsigned char* output, size_t size, struct HuffStream streams[]);
+uint64_t loadBE64(const unsigned char* p);
+uint64_t loadBE64Tail(const unsigned char* p, const unsigned char* end);
+void calculateFrequency(const unsigned char* input, size_t size, unsigned freq[]);
+void calculateFrequencyChecksum(const unsigned char* input, size_t size, unsigned freq[], uint32_t* checksum);
+void putBits(struct BitWriter* w, uint32_t value, int length);
+void flushBits(struct BitWriter* w);
+uint32_t getBits(struct BitReader* r, int length);
+int bitReaderOverrun(const struct BitReader* r);
+int decodeSymbol(struct BitReader* r, const struct HuffDecodeEntry* table, const struct HuffLongCodes* longCodes);
+size_t writePackedLengths(const unsigned char lengths[], int count, unsigned char* out);
+size_t readPackedLengths(const unsigned char* in, size_t avail, unsigned char lengths[], int count);
+
+// LZ 블록 (adv_lz.c)
+int highestBit(uint32_t v);
+size_t compressLzBlock(const unsigned char* data, size_t size, unsigned char* out, const struct AdvOptions* options, size_t limit);
+int decompressLzBlock(int version, const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize);
+
+// tANS 블록 (adv_ans.c)
+uint32_t log2Fixed(uint32_t x);
+size_t estimateAnsBlock(const unsigned freq[], size_t size, uint16_t norm[]);
+size_t compressAnsBlock(const unsigned char* data, size_t size, const uint16_t norm[], unsigned char* out);
+int decompressAnsBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize);
+
+// 블록 정렬 블록 (adv_bwt.c)
+int saisSort(const void* text, int wide, int32_t* sa, int32_t n, int32_t alphabet);
+size_t compressBwtBlock(const unsigned char* data, size_t size, unsigned char* out, const struct AdvOptions* options, size_t limit);
+int decompressBwtBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize);
+
+// 문맥 하프만 블록 (adv_context.c)
+struct ContextModel {
+    int tableCount;
+    unsigned char map[256]; // 앞 바이트마다 코드표 번호
+    unsigned char lengths[ADV_CONTEXT_TABLES][256];
+};
+
+size_t estimateContextBlock(const unsigned char* data, size_t size, int maxLength, struct ContextModel* model);
+size_t compressContextBlock(const unsigned char* data, size_t size, const struct ContextModel* model, unsigned char* out);
+int decompressContextBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize);
+
+// 사전 (adv_dictionary.c). 코드와 디코딩 테이블은 사전을 만들 때 한 번 채운다.
+struct AdvDictionary {
+    unsigned int id;
+    unsigned char lengths[256];
+    uint64_t codes[256];
+    struct HuffDecoder decoder;
+    struct AdvDictionary* next; // 캐시 목록
+};
+
+const struct AdvDictionary* findDictionary(unsigned int id);
+uint64_t dictionaryBits(const struct AdvDictionary* dict, const unsigned freq[]);
+size_t writeDictionaryPayload(const struct AdvDictionary* dict, const unsigned char* data, size_t size, unsigned char* out);
+int decompressDictionaryBlock(const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize);
+
+// CRC32C (Castagnoli) (adv_checksum.c). crc는 0에서 시작해 이어서 갱신한다.
+// crc32cCombine은 두 구간의 CRC로 이어 붙인 구간의 CRC를 구한다 (데이터를 다시 읽지 않음).
+uint32_t crc32cUpdate(uint32_t crc, const unsigned char* data, size_t size);
+uint32_t crc32cCombine(uint32_t first, uint32_t second, uint64_t secondSize);
+
+// 블록 단위 압축/해제 (adv_codec.c)
+void putLE32(unsigned char* p, uint32_t v);
+uint32_t getLE32(const unsigned char* p);
+void putLE64(unsigned char* p, uint64_t v);
+uint64_t getLE64(const unsigned char* p);
+void resolveOptions(const struct AdvOptions* options, struct AdvOptions* resolved);
+size_t compressBlock(const unsigned char* data, size_t size, unsigned char* out, const struct AdvOptions* options, uint32_t* checksum);
+int decompressBlock(int version, int blockType, const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize);
+int decodeBlock(int version, int blockType, const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize, uint32_t* checksum);
+int isFramedVersion(int version);
+void writeFileHeader(unsigned char* out);
+int readBlockIndex(int version, FILE* source, size_t* blockCount, uint64_t** frameOffset, uint32_t** rawSize, uint32_t* fileChecksum);
+
+// 스트리밍 인코더: 워커 풀과 배치 버퍼, 지금까지 기록한 프레임의 블록 인덱스
+struct FrameEncoder {
+    struct WorkerPool* pool;
+    size_t batchSize;
+    const unsigned char** input;
+    unsigned char** output;
+    size_t* inputSize;
+    size_t* outputSize;
+    uint32_t* checksum; // 배치 블록별 원본 CRC32C
+    struct AdvOptions options;
+    uint64_t* frameOffset;
+    uint32_t* rawSize;
+    size_t blockCount;
+    size_t indexCapacity;
+    uint64_t written; // dest에 기록한 바이트 수 (파일 헤더 포함)
+};
+
+struct ProgressMeter;
+int frameEncoderInit(struct FrameEncoder* enc, const struct AdvOptions* options);
+void frameEncoderFree(struct FrameEncoder* enc);
+int encodeFrames(struct FrameEncoder* enc, FILE* source, FILE* dest, long* processed, struct ProgressMeter* meter, uint32_t* checksum);
+int decodeSequential(int version, FILE* source, FILE* dest, size_t blockLimit, uint64_t readLimit, long* processed, struct ProgressMeter* meter, uint32_t* checksum);
+
+// 진행 보고 (adv_progress.c)
+// 작업 루프가 단계를 바꾸거나 처리량을 더할 때마다 부르며, 콜백은 간격이 지났을 때만 호출된다.
+struct ProgressMeter {
+    struct AdvProgress state;
+    AdvProgressFn fn;
+    void* userData;
+    double interval;
+    double startTime;
+    double lastReport;
+    double stageStart;
+    int stage;
+    const volatile int* cancel; // AdvOptions.cancel
+};
+
+void progressStart(struct ProgressMeter* meter, const struct AdvOptions* options, long long totalBytes);
+void progressStage(struct ProgressMeter* meter, int stage);
+void progressAdvance(struct ProgressMeter* meter, long long inputBytes, long long outputBytes, long long blocks);
+void progressFinish(struct ProgressMeter* meter);
+int progressCancelled(const struct ProgressMeter* meter);
+long long sourceSize(FILE* source);
+
+// 읽기/코덱/쓰기 파이프라인 (adv_pipeline.c)
+// 입력과 출력 버퍼를 두 벌씩 돌려 코덱이 한 버퍼를 처리하는 동안 다음 입력을 읽고 앞선 출력을 쓴다.
+// 일반 파일은 io_uring으로, 파이프나 io_uring이 없는 환경은 읽기/쓰기 스레드로 처리한다.
+// 입력은 버퍼 두 벌까지 미리 읽으므로, 닫은 뒤 source를 이어 읽으려면 readLimit로 읽을 양을 한정한다.
+// 파이프 입력은 FILE을 거치지 않고 기술자에서 읽으므로, 그 전에 읽을 부분은 readSourceHead로 읽는다.
+#define ADV_PIPELINE_BUFFERS 2
+struct IoPipeline;
+struct IoPipeline* pipelineCreate(FILE* source, size_t inputSize, uint64_t readLimit, FILE* dest, size_t outputSize, int overlap, int partial);
+int pipelineRead(struct IoPipeline* p, const unsigned char** data, size_t* size);
+int pipelineOutput(struct IoPipeline* p, unsigned char** data);
+int pipelineWrite(struct IoPipeline* p, size_t size);
+int pipelineClose(struct IoPipeline* p, int result);
+int readSourceHead(FILE* source, unsigned char* data, size_t size, size_t* got);
+int fitsInBuffer(FILE* source, uint64_t limit);
+
+// 워커 풀 (adv_pool.c)
+struct WorkerPool;
+int getCpuCount(void);
+double getMonotonicTime(void);
+struct WorkerPool *createWorkerPool(int threadCount);
+void destroyWorkerPool(struct WorkerPool *pool);
+void runParallel(struct WorkerPool *pool, size_t count, void (*taskFn)(void *ctx, size_t index), void *ctx);
+
+#endif
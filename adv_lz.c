@@ -0,0 +1,336 @@
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+// LZ77 앞단: 해시 체인으로 블록 안의 반복 문자열을 찾아 (길이, 거리) 토큰으로 바꾸고
+// 리터럴/길이와 거리 두 알파벳을 기존 하프만 함수로 부호화한다.
+
+#define LZ_HASH_BITS 16
+#define LZ_HASH_SIZE (1u << LZ_HASH_BITS)
+#define LZ_TOKEN_DIST_BITS 20 // 토큰 하위 비트에 (거리 - 1), 상위 비트에 길이를 담는다
+#define LZ_FAR_SHORT_MATCH 4096 // 이보다 먼 최소 길이 일치는 쓰지 않는다
+
+// 길이 코드 257+i: lzLengthBase[i]부터 lzLengthExtra[i]비트만큼 (deflate와 같음)
+const uint16_t lzLengthBase[ADV_LZ_LENGTH_CODES] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const unsigned char lzLengthExtra[ADV_LZ_LENGTH_CODES] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+
+// 거리 코드: deflate의 30개 코드에 32 KiB ~ 1 MiB 구간 10개를 같은 규칙으로 덧붙였다
+const uint32_t lzDistBase[ADV_LZ_DIST_SYMBOLS] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577,
+    32769, 49153, 65537, 98305, 131073, 196609, 262145, 393217, 524289, 786433
+};
+const unsigned char lzDistExtra[ADV_LZ_DIST_SYMBOLS] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13,
+    14, 14, 15, 15, 16, 16, 17, 17, 18, 18
+};
+
+// 압축 강도별 탐색 설정: 체인을 따라갈 최대 후보 수, 이 길이 이상이면 탐색 중단, 지연 일치 여부,
+// 후보를 찾을 최대 거리. 먼 후보는 거의 매번 캐시 미스라서 낮은 강도일수록 창을 좁힌다.
+struct LzLevel {
+    int maxChain;
+    int niceLength;
+    int lazy;
+    uint32_t window;
+};
+
+const struct LzLevel lzLevels[ADV_LEVEL_MAX + 1] = {
+    { 0, 0, 0, 0 },               // 0: LZ 사용 안 함
+    { 4, 16, 0, 1u << 16 },
+    { 8, 32, 0, 1u << 16 },
+    { 16, 32, 0, 1u << 17 },
+    { 16, 32, 1, 1u << 17 },
+    { 32, 64, 1, 1u << 18 },
+    { 64, 128, 1, 1u << 19 },
+    { 128, 258, 1, 1u << 20 },
+    { 512, 258, 1, 1u << 20 },
+    { 4096, 258, 1, 1u << 20 }
+};
+
+int highestBit(uint32_t v) {
+    int bit = 0;
+    while (v >>= 1) bit++;
+    return bit;
+}
+
+// 일치 길이(3~258)에 대한 길이 코드 번호 (0~28)
+int lzLengthCode(int length) {
+    if (length == ADV_LZ_MAX_MATCH) return ADV_LZ_LENGTH_CODES - 1;
+    int v = length - ADV_LZ_MIN_MATCH;
+    if (v < 8) return v;
+    int bit = highestBit((uint32_t)v);
+    return 4 * (bit - 1) + ((v >> (bit - 2)) & 3);
+}
+
+// 거리(1~2^20)에 대한 거리 코드 번호 (0~39)
+int lzDistCode(uint32_t distance) {
+    uint32_t v = distance - 1;
+    if (v < 4) return (int)v;
+    int bit = highestBit(v);
+    return 2 * bit + (int)((v >> (bit - 1)) & 1);
+}
+
+uint32_t lzHash(const unsigned char* p) {
+    uint32_t v = (uint32_t)p[0] << 16 | (uint32_t)p[1] << 8 | p[2];
+    return (v * 2654435761u) >> (32 - LZ_HASH_BITS);
+}
+
+// 위치 pos를 해시 체인 맨 앞에 넣는다. head/prev에는 위치 + 1을 저장한다 (0은 비어 있음).
+void lzInsert(const unsigned char* data, size_t pos, uint32_t* head, uint32_t* prev) {
+    uint32_t h = lzHash(&data[pos]);
+    prev[pos] = head[h];
+    head[h] = (uint32_t)pos + 1;
+}
+
+// pos에서 시작하는 가장 긴 일치를 체인의 후보 중에서 찾는다 (없으면 0)
+int lzFindMatch(const unsigned char* data, size_t size, size_t pos, const uint32_t* prev, const struct LzLevel* level, uint32_t* distance) {
+    int maxLength = size - pos < ADV_LZ_MAX_MATCH ? (int)(size - pos) : ADV_LZ_MAX_MATCH;
+    int bestLength = ADV_LZ_MIN_MATCH - 1;
+    const unsigned char* target = &data[pos];
+    // 체인은 가까운 후보부터 이어지므로 창 밖으로 나가면 더 볼 필요가 없다
+    size_t limit = pos > level->window ? pos - level->window : 0;
+    uint32_t candidate = prev[pos];
+    for (int chain = level->maxChain; candidate > limit && chain > 0; chain--) {
+        const unsigned char* match = &data[candidate - 1];
+        // 지금까지의 최장 길이 위치부터 비교하면 짧은 후보를 빨리 거른다
+        if (match[bestLength] == target[bestLength] && match[0] == target[0] && match[1] == target[1]) {
+            int length = 2;
+            while (length < maxLength && match[length] == target[length]) length++;
+            if (length > bestLength) {
+                bestLength = length;
+                *distance = (uint32_t)(pos - (candidate - 1));
+                if (length >= level->niceLength || length >= maxLength) break;
+            }
+        }
+        candidate = prev[candidate - 1];
+    }
+    // 먼 거리의 3바이트 일치는 거리 비트 때문에 리터럴 세 개보다 비싸기 쉽다
+    if (bestLength == ADV_LZ_MIN_MATCH && *distance > LZ_FAR_SHORT_MATCH) return 0;
+    return bestLength >= ADV_LZ_MIN_MATCH ? bestLength : 0;
+}
+
+uint32_t lzMatchToken(int length, uint32_t distance) {
+    return ((uint32_t)length << LZ_TOKEN_DIST_BITS) | (distance - 1);
+}
+
+// 블록을 리터럴(토큰 < 256)과 일치 토큰으로 나눈다. 토큰 수를 돌려준다.
+// head는 LZ_HASH_SIZE개, prev와 tokens는 size개 이상이어야 한다.
+size_t lzParse(const unsigned char* data, size_t size, int levelNumber, uint32_t* head, uint32_t* prev, uint32_t* tokens) {
+    const struct LzLevel* level = &lzLevels[levelNumber];
+    size_t count = 0;
+    size_t pos = 0;
+    memset(head, 0, LZ_HASH_SIZE * sizeof(uint32_t));
+
+    if (!level->lazy) {
+        while (pos < size) {
+            uint32_t distance = 0;
+            int length = 0;
+            if (pos + ADV_LZ_MIN_MATCH <= size) {
+                lzInsert(data, pos, head, prev);
+                length = lzFindMatch(data, size, pos, prev, level, &distance);
+            }
+            if (length == 0) {
+                tokens[count++] = data[pos++];
+                continue;
+            }
+            tokens[count++] = lzMatchToken(length, distance);
+            for (size_t k = pos + 1; k < pos + length && k + ADV_LZ_MIN_MATCH <= size; k++) {
+                lzInsert(data, k, head, prev);
+            }
+            pos += length;
+        }
+        return count;
+    }
+
+    // 지연 일치: 바로 다음 위치에서 더 긴 일치가 나오면 현재 바이트는 리터럴로 보낸다
+    int pending = 0; // pos - 1에서 찾은 일치(또는 리터럴)를 아직 내보내지 않음
+    int pendingLength = 0;
+    uint32_t pendingDistance = 0;
+    while (pos < size) {
+        uint32_t distance = 0;
+        int length = 0;
+        if (pos + ADV_LZ_MIN_MATCH <= size) {
+            lzInsert(data, pos, head, prev);
+            if (!pending || pendingLength < level->niceLength) {
+                length = lzFindMatch(data, size, pos, prev, level, &distance);
+            }
+        }
+        if (pending) {
+            if (pendingLength >= ADV_LZ_MIN_MATCH && pendingLength >= length) {
+                tokens[count++] = lzMatchToken(pendingLength, pendingDistance);
+                size_t end = pos - 1 + pendingLength;
+                for (size_t k = pos + 1; k < end && k + ADV_LZ_MIN_MATCH <= size; k++) {
+                    lzInsert(data, k, head, prev);
+                }
+                pos = end;
+                pending = 0;
+                continue;
+            }
+            tokens[count++] = data[pos - 1];
+        }
+        pending = 1;
+        pendingLength = length;
+        pendingDistance = distance;
+        pos++;
+    }
+    if (pending) {
+        tokens[count++] = pendingLength >= ADV_LZ_MIN_MATCH ? lzMatchToken(pendingLength, pendingDistance) : data[pos - 1];
+    }
+    return count;
+}
+
+// v2 LZ 블록의 코드 길이표: 길이를 4비트씩 앞(상위 니블)부터 채워 저장했다
+size_t readNibbleLengths(const unsigned char* in, int symbolCount, unsigned char lengths[]) {
+    for (int i = 0; i < symbolCount; i++) {
+        lengths[i] = (in[i / 2] >> ((i & 1) ? 0 : 4)) & 0x0F;
+    }
+    return (size_t)(symbolCount + 1) / 2;
+}
+
+// 블록을 LZ 프레임으로 기록한다. 프레임이 limit 바이트 이상이 될 것 같으면
+// (하프만 블록보다 작지 않으면) 아무것도 쓰지 않고 0을 돌려준다. 메모리가 부족해도 0이다.
+size_t compressLzBlock(const unsigned char* data, size_t size, unsigned char* out, const struct AdvOptions* options, size_t limit) {
+    if (options->level <= 0 || size < ADV_LZ_MIN_MATCH) return 0;
+    int levelNumber = options->level > ADV_LEVEL_MAX ? ADV_LEVEL_MAX : options->level;
+
+    // 해시 머리, 체인, 토큰을 한 번에 할당한다
+    uint32_t* work = (uint32_t*)malloc((LZ_HASH_SIZE + 2 * size) * sizeof(uint32_t));
+    if (!work) return 0;
+    uint32_t* head = work;
+    uint32_t* prev = head + LZ_HASH_SIZE;
+    uint32_t* tokens = prev + size;
+    size_t tokenCount = lzParse(data, size, levelNumber, head, prev, tokens);
+
+    // 토큰 빈도로 두 알파벳의 코드를 만들고 정확한 출력 크기를 계산한다
+    unsigned litLenFreq[ADV_LZ_LITLEN_SYMBOLS] = {0};
+    unsigned distFreq[ADV_LZ_DIST_SYMBOLS] = {0};
+    uint64_t extraBits = 0;
+    for (size_t i = 0; i < tokenCount; i++) {
+        uint32_t token = tokens[i];
+        if (token < ADV_LZ_LITERALS) {
+            litLenFreq[token]++;
+            continue;
+        }
+        int lengthCode = lzLengthCode((int)(token >> LZ_TOKEN_DIST_BITS));
+        int distCode = lzDistCode((token & ((1u << LZ_TOKEN_DIST_BITS) - 1)) + 1);
+        litLenFreq[ADV_LZ_LITERALS + lengthCode]++;
+        distFreq[distCode]++;
+        extraBits += lzLengthExtra[lengthCode] + lzDistExtra[distCode];
+    }
+    // 두 알파벳의 길이는 이어 붙여 한 번에 압축된 길이표로 저장한다
+    unsigned char lengths[ADV_LZ_LITLEN_SYMBOLS + ADV_LZ_DIST_SYMBOLS];
+    unsigned char* litLenLengths = lengths;
+    unsigned char* distLengths = &lengths[ADV_LZ_LITLEN_SYMBOLS];
+    uint64_t litLenCodes[ADV_LZ_LITLEN_SYMBOLS];
+    uint64_t distCodes[ADV_LZ_DIST_SYMBOLS];
+    buildCodeLengths(litLenFreq, ADV_LZ_LITLEN_SYMBOLS, litLenLengths, options->maxCodeLength);
+    buildCodeLengths(distFreq, ADV_LZ_DIST_SYMBOLS, distLengths, options->maxCodeLength);
+    unsigned char table[ADV_PACKED_LENGTHS_MAX(ADV_LZ_LITLEN_SYMBOLS + ADV_LZ_DIST_SYMBOLS)];
+    size_t tableSize = writePackedLengths(lengths, ADV_LZ_LITLEN_SYMBOLS + ADV_LZ_DIST_SYMBOLS, table);
+
+    uint64_t totalBits = extraBits;
+    for (int i = 0; i < ADV_LZ_LITLEN_SYMBOLS; i++) totalBits += (uint64_t)litLenFreq[i] * litLenLengths[i];
+    for (int i = 0; i < ADV_LZ_DIST_SYMBOLS; i++) totalBits += (uint64_t)distFreq[i] * distLengths[i];
+    size_t frameSize = ADV_BLOCK_HEADER_SIZE + tableSize + (size_t)((totalBits + 7) / 8);
+    if (frameSize >= limit) {
+        free(work);
+        return 0;
+    }
+    assignCanonicalCodes(litLenLengths, ADV_LZ_LITLEN_SYMBOLS, litLenCodes);
+    assignCanonicalCodes(distLengths, ADV_LZ_DIST_SYMBOLS, distCodes);
+
+    out[0] = ADV_BLOCK_LZ;
+    putLE32(&out[1], (uint32_t)size);
+    size_t idx = ADV_BLOCK_HEADER_SIZE;
+    memcpy(&out[idx], table, tableSize);
+    idx += tableSize;
+
+    struct BitWriter writer = { out, idx, 0, 0 };
+    for (size_t i = 0; i < tokenCount; i++) {
+        uint32_t token = tokens[i];
+        if (token < ADV_LZ_LITERALS) {
+            putBits(&writer, (uint32_t)litLenCodes[token], litLenLengths[token]);
+            continue;
+        }
+        int length = (int)(token >> LZ_TOKEN_DIST_BITS);
+        uint32_t distance = (token & ((1u << LZ_TOKEN_DIST_BITS) - 1)) + 1;
+        int lengthCode = lzLengthCode(length);
+        int distCode = lzDistCode(distance);
+        int symbol = ADV_LZ_LITERALS + lengthCode;
+        putBits(&writer, (uint32_t)litLenCodes[symbol], litLenLengths[symbol]);
+        putBits(&writer, (uint32_t)(length - lzLengthBase[lengthCode]), lzLengthExtra[lengthCode]);
+        putBits(&writer, (uint32_t)distCodes[distCode], distLengths[distCode]);
+        putBits(&writer, distance - lzDistBase[distCode], lzDistExtra[distCode]);
+    }
+    flushBits(&writer);
+    free(work);
+
+    putLE32(&out[5], (uint32_t)(writer.pos - ADV_BLOCK_HEADER_SIZE));
+    return writer.pos;
+}
+
+// LZ 블록 페이로드를 정확히 rawSize 바이트로 복원한다 (version은 파일 형식 버전)
+int decompressLzBlock(int version, const unsigned char* payload, size_t payloadSize, unsigned char* out, size_t rawSize) {
+    unsigned char lengths[ADV_LZ_LITLEN_SYMBOLS + ADV_LZ_DIST_SYMBOLS];
+    unsigned char* litLenLengths = lengths;
+    unsigned char* distLengths = &lengths[ADV_LZ_LITLEN_SYMBOLS];
+    size_t idx;
+    if (version == ADV_FORMAT_FRAMED) {
+        if (payloadSize < ADV_LZ_NIBBLE_TABLE_SIZE) return ADV_ERR_FORMAT;
+        idx = readNibbleLengths(payload, ADV_LZ_LITLEN_SYMBOLS, litLenLengths);
+        idx += readNibbleLengths(&payload[idx], ADV_LZ_DIST_SYMBOLS, distLengths);
+    } else {
+        idx = readPackedLengths(payload, payloadSize, lengths, ADV_LZ_LITLEN_SYMBOLS + ADV_LZ_DIST_SYMBOLS);
+        if (idx == 0) return ADV_ERR_FORMAT;
+    }
+    if (!validateCodeLengths(litLenLengths, ADV_LZ_LITLEN_SYMBOLS) || !validateCodeLengths(distLengths, ADV_LZ_DIST_SYMBOLS)) {
+        return ADV_ERR_FORMAT;
+    }
+
+    uint64_t litLenCodes[ADV_LZ_LITLEN_SYMBOLS];
+    uint64_t distCodes[ADV_LZ_DIST_SYMBOLS];
+    struct HuffDecodeEntry litLenTable[1u << HUFF_TABLE_BITS];
+    struct HuffDecodeEntry distTable[1u << HUFF_TABLE_BITS];
+    struct HuffLongCodes litLenLong;
+    struct HuffLongCodes distLong;
+    assignCanonicalCodes(litLenLengths, ADV_LZ_LITLEN_SYMBOLS, litLenCodes);
+    assignCanonicalCodes(distLengths, ADV_LZ_DIST_SYMBOLS, distCodes);
+    buildDecodeTable(litLenCodes, litLenLengths, ADV_LZ_LITLEN_SYMBOLS, litLenTable, &litLenLong);
+    buildDecodeTable(distCodes, distLengths, ADV_LZ_DIST_SYMBOLS, distTable, &distLong);
+
+    struct BitReader reader = { &payload[idx], payloadSize - idx, 0, 0, 0 };
+    size_t outPos = 0;
+    while (outPos < rawSize) {
+        int symbol = decodeSymbol(&reader, litLenTable, &litLenLong);
+        if (symbol < 0) return ADV_ERR_FORMAT;
+        if (symbol < ADV_LZ_LITERALS) {
+            out[outPos++] = (unsigned char)symbol;
+            continue;
+        }
+        int lengthCode = symbol - ADV_LZ_LITERALS;
+        size_t length = lzLengthBase[lengthCode] + getBits(&reader, lzLengthExtra[lengthCode]);
+        int distCode = decodeSymbol(&reader, distTable, &distLong);
+        if (distCode < 0) return ADV_ERR_FORMAT;
+        size_t distance = lzDistBase[distCode] + getBits(&reader, lzDistExtra[distCode]);
+        if (distance > outPos || length > rawSize - outPos) return ADV_ERR_FORMAT;
+
+        // 겹치는 복사(거리 < 길이)는 앞에서부터 한 바이트씩 복사해야 반복이 이어진다
+        const unsigned char* from = &out[outPos - distance];
+        unsigned char* to = &out[outPos];
+        if (distance >= length) {
+            memcpy(to, from, length);
+        } else {
+            for (size_t k = 0; k < length; k++) to[k] = from[k];
+        }
+        outPos += length;
+    }
+    if (bitReaderOverrun(&reader)) return ADV_ERR_FORMAT;
+    return ADV_OK;
+}
@@ -0,0 +1,714 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "adv_internal.h"
+
+// 리눅스에서 커널 헤더가 있으면 io_uring 경로를 함께 컴파일한다 (liburing 없이 시스템 호출로 직접 다룬다).
+// 실행 중에 링을 만들 수 없으면(오래된 커널, 컨테이너의 seccomp 등) 스레드 경로를 쓴다.
+#if defined(__linux__) && defined(__has_include) && !defined(ADV_NO_IO_URING)
+#if __has_include(<linux/io_uring.h>)
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+#define ADV_HAVE_IO_URING 1
+#endif
+#endif
+
+#ifndef _WIN32
+#include <errno.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+// 읽기/코덱/쓰기 파이프라인
+// 입력과 출력 버퍼를 각각 ADV_PIPELINE_BUFFERS개씩 돌려 가며, 코덱이 버퍼 하나를 처리하는 동안
+// 다음 입력을 미리 읽고 앞서 만든 출력을 기록한다. 벽시계 시간이 I/O와 계산의 합이 아니라
+// 둘 중 큰 쪽에 가까워진다. 코덱 단계는 호출한 스레드에서 돌고 I/O는 백엔드가 맡는다.
+//   - io_uring: 양쪽이 일반 파일이면 호출 스레드가 읽기/쓰기를 비동기로 제출하고 기다릴 때 완료를 거둔다
+//   - 스레드: 읽기 스레드와 쓰기 스레드가 블로킹 I/O를 한다 (파이프, Windows). 파이프는 FILE이 아니라
+//     기술자에서 poll과 read로 읽어, 도착한 만큼 코덱에 넘기고 닫을 때 깨우기 파이프로 읽기를 끊는다
+//   - 직접: 입력이 버퍼 하나에 다 들어가 겹칠 단계가 없으면 호출 스레드가 그 자리에서 읽고 쓴다
+
+enum {
+    PIPE_FREE = 0, // 비어 있음 (읽기를 기다리거나 코덱이 채울 수 있음)
+    PIPE_BUSY,     // I/O 진행 중
+    PIPE_READY     // 입력은 코덱이, 출력은 쓰기가 가져갈 수 있음
+};
+
+enum {
+    PIPE_DIRECT = 0,
+    PIPE_THREADS,
+    PIPE_RING
+};
+
+struct PipeBuffer {
+    unsigned char* data;
+    size_t size; // 채운 (출력이면 쓸) 바이트 수
+    int state;
+};
+
+#ifdef ADV_HAVE_IO_URING
+// io_uring 제출/완료 링. 제출 큐의 꼬리와 완료 큐의 머리는 이 프로세스만 움직인다.
+struct IoRing {
+    int fd;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_sqe* sqes;
+    struct io_uring_cqe* cqes;
+    void* ringMap;
+    size_t ringMapSize;
+    size_t sqeMapSize;
+};
+
+#define RING_ENTRIES 4 // 읽기와 쓰기가 하나씩만 진행되므로 작게 잡는다
+#define RING_TAG_READ 1
+#define RING_TAG_WRITE 2
+#endif
+
+struct IoPipeline {
+    int backend;
+    FILE* source;
+    FILE* dest;
+    int result; // 처음 난 오류
+    int stop;   // 오류나 중단으로 I/O를 멈춤
+    int closing; // 코덱이 끝나 쓰기만 남음
+
+    struct PipeBuffer input[ADV_PIPELINE_BUFFERS];
+    size_t inputCapacity;
+    size_t readNext;    // 다음에 채울 입력 번호 (버퍼는 번호 % ADV_PIPELINE_BUFFERS)
+    size_t consumeNext; // 코덱이 다음에 가져갈 입력 번호
+    int holding;        // 코덱이 consumeNext - 1번 입력을 아직 쓰고 있음
+    int readEof;        // 입력 끝이나 읽기 한도에 도달함
+    int partial;        // 버퍼를 다 채우지 못해도 읽은 만큼 코덱에 넘김 (파이프 입력만)
+    uint64_t readLimit;
+
+    struct PipeBuffer output[ADV_PIPELINE_BUFFERS];
+    size_t outputCapacity;
+    size_t fillNext;  // 코덱이 다음에 채울 출력 번호
+    size_t writeNext; // 다음에 기록할 출력 번호
+
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+    pthread_t reader;
+    pthread_t writer;
+    int readerStarted;
+    int writerStarted;
+#ifndef _WIN32
+    int pollSource; // 입력을 기술자에서 poll과 read로 읽음 (파이프 등 일반 파일이 아닌 입력)
+    int wake[2];    // 닫을 때 poll에서 기다리는 읽기 스레드를 깨우는 파이프
+#endif
+
+#ifdef ADV_HAVE_IO_URING
+    struct IoRing ring;
+    int sourceFd;
+    int destFd;
+    uint64_t readOffset;
+    uint64_t writeOffset;
+    int readBusy;
+    int writeBusy;
+    size_t writeDone; // 기록 중인 출력 버퍼에서 이미 쓴 바이트
+    struct iovec readVec;
+    struct iovec writeVec;
+#endif
+};
+
+void pipelineFail(struct IoPipeline* p, int result) {
+    if (p->result == ADV_OK) p->result = result;
+    p->stop = 1;
+}
+
+#ifdef ADV_HAVE_IO_URING
+int ringInit(struct IoRing* ring, unsigned entries) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+    int fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+    if (fd < 0) return -1;
+    // 제출 큐와 완료 큐를 한 번에 매핑하는 커널(5.4 이상)만 쓴다
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP)) {
+        close(fd);
+        return -1;
+    }
+    size_t sqSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cqSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->ringMapSize = sqSize > cqSize ? sqSize : cqSize;
+    ring->sqeMapSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    unsigned char* map = (unsigned char*)mmap(NULL, ring->ringMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    void* sqes = mmap(NULL, ring->sqeMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+        munmap(map, ring->ringMapSize);
+        close(fd);
+        return -1;
+    }
+    ring->fd = fd;
+    ring->ringMap = map;
+    ring->sqTail = (unsigned*)(map + params.sq_off.tail);
+    ring->sqMask = (unsigned*)(map + params.sq_off.ring_mask);
+    ring->sqArray = (unsigned*)(map + params.sq_off.array);
+    ring->cqHead = (unsigned*)(map + params.cq_off.head);
+    ring->cqTail = (unsigned*)(map + params.cq_off.tail);
+    ring->cqMask = (unsigned*)(map + params.cq_off.ring_mask);
+    ring->cqes = (struct io_uring_cqe*)(map + params.cq_off.cqes);
+    ring->sqes = (struct io_uring_sqe*)sqes;
+    return 0;
+}
+
+void ringFree(struct IoRing* ring) {
+    munmap(ring->sqes, ring->sqeMapSize);
+    munmap(ring->ringMap, ring->ringMapSize);
+    close(ring->fd);
+}
+
+// 벡터 하나짜리 읽기/쓰기를 제출 큐에 넣고 커널에 넘긴다 (READV/WRITEV는 5.1부터 있다)
+int ringSubmit(struct IoRing* ring, int opcode, int fd, const struct iovec* vec, uint64_t offset, uint64_t tag) {
+    unsigned tail = *ring->sqTail;
+    unsigned index = tail & *ring->sqMask;
+    struct io_uring_sqe* sqe = &ring->sqes[index];
+    memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = (unsigned char)opcode;
+    sqe->fd = fd;
+    sqe->addr = (uint64_t)(uintptr_t)vec;
+    sqe->len = 1;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    ring->sqArray[index] = index;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    for (;;) {
+        long n = syscall(__NR_io_uring_enter, ring->fd, 1, 0, 0, NULL, 0);
+        if (n >= 0) return n == 1 ? 0 : -1;
+        if (errno != EINTR) return -1;
+    }
+}
+
+// 완료 하나를 꺼낸다. 없으면 올 때까지 기다린다.
+int ringWait(struct IoRing* ring, uint64_t* tag, int* res) {
+    for (;;) {
+        unsigned head = *ring->cqHead;
+        if (head != __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE)) {
+            const struct io_uring_cqe* cqe = &ring->cqes[head & *ring->cqMask];
+            *tag = cqe->user_data;
+            *res = cqe->res;
+            __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+            return 0;
+        }
+        if (syscall(__NR_io_uring_enter, ring->fd, 0, 1, IORING_ENTER_GETEVENTS, NULL, 0) < 0 && errno != EINTR) return -1;
+    }
+}
+
+// FILE의 버퍼를 거치지 않고 fd로 바로 읽고 써도 되는 일반 파일인지 확인하고 현재 위치를 구한다.
+// fflush는 쓰기 버퍼를 내보내고, 읽기 스트림이면 미리 읽어 둔 만큼 fd 위치를 되돌린다.
+int directFilePosition(FILE* f, uint64_t* offset) {
+    struct stat st;
+    if (fflush(f) != 0 || fstat(fileno(f), &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    long position = ftell(f);
+    if (position < 0) return 0;
+    *offset = (uint64_t)position;
+    return 1;
+}
+
+void ringQueueRead(struct IoPipeline* p) {
+    struct PipeBuffer* buf = &p->input[p->readNext % ADV_PIPELINE_BUFFERS];
+    size_t want = p->inputCapacity - buf->size;
+    if (want > p->readLimit) want = (size_t)p->readLimit;
+    p->readVec.iov_base = buf->data + buf->size;
+    p->readVec.iov_len = want;
+    p->readBusy = 1;
+    if (ringSubmit(&p->ring, IORING_OP_READV, p->sourceFd, &p->readVec, p->readOffset, RING_TAG_READ) != 0) {
+        p->readBusy = 0;
+        pipelineFail(p, ADV_ERR_READ);
+    }
+}
+
+void ringQueueWrite(struct IoPipeline* p) {
+    struct PipeBuffer* buf = &p->output[p->writeNext % ADV_PIPELINE_BUFFERS];
+    p->writeVec.iov_base = buf->data + p->writeDone;
+    p->writeVec.iov_len = buf->size - p->writeDone;
+    p->writeBusy = 1;
+    if (ringSubmit(&p->ring, IORING_OP_WRITEV, p->destFd, &p->writeVec, p->writeOffset, RING_TAG_WRITE) != 0) {
+        p->writeBusy = 0;
+        pipelineFail(p, ADV_ERR_WRITE);
+    }
+}
+
+// 비어 있는 다음 입력 버퍼에 읽기를, 채워진 다음 출력 버퍼에 쓰기를 제출한다 (각각 하나씩만 진행)
+void ringSubmitPending(struct IoPipeline* p) {
+    if (p->stop) return;
+    struct PipeBuffer* in = &p->input[p->readNext % ADV_PIPELINE_BUFFERS];
+    if (p->source && !p->readBusy && !p->readEof && !p->closing && in->state == PIPE_FREE) {
+        in->size = 0;
+        in->state = PIPE_BUSY;
+        ringQueueRead(p);
+    }
+    struct PipeBuffer* out = &p->output[p->writeNext % ADV_PIPELINE_BUFFERS];
+    if (p->dest && !p->writeBusy && out->state == PIPE_READY) {
+        out->state = PIPE_BUSY;
+        p->writeDone = 0;
+        ringQueueWrite(p);
+    }
+}
+
+// 진행 중인 읽기나 쓰기 하나가 끝나기를 기다려 처리한다. 짧게 끝나면 나머지를 다시 제출한다.
+void ringComplete(struct IoPipeline* p) {
+    uint64_t tag;
+    int res;
+    if (ringWait(&p->ring, &tag, &res) != 0) {
+        p->readBusy = 0;
+        p->writeBusy = 0;
+        pipelineFail(p, ADV_ERR_READ);
+        return;
+    }
+    if (tag == RING_TAG_READ) {
+        struct PipeBuffer* buf = &p->input[p->readNext % ADV_PIPELINE_BUFFERS];
+        p->readBusy = 0;
+        if (res == -EINTR || res == -EAGAIN) {
+            if (!p->stop) ringQueueRead(p);
+            return;
+        }
+        if (res < 0) {
+            pipelineFail(p, ADV_ERR_READ);
+            return;
+        }
+        buf->size += (size_t)res;
+        p->readOffset += (uint64_t)res;
+        p->readLimit -= (uint64_t)res;
+        if (res == 0 || p->readLimit == 0) p->readEof = 1;
+        if (!p->readEof && buf->size < p->inputCapacity) {
+            if (!p->stop) ringQueueRead(p);
+            return;
+        }
+        if (buf->size > 0) {
+            buf->state = PIPE_READY;
+            p->readNext++;
+        } else {
+            buf->state = PIPE_FREE;
+        }
+    } else {
+        struct PipeBuffer* buf = &p->output[p->writeNext % ADV_PIPELINE_BUFFERS];
+        p->writeBusy = 0;
+        if (res == -EINTR || res == -EAGAIN) {
+            if (!p->stop) ringQueueWrite(p);
+            return;
+        }
+        if (res <= 0) {
+            pipelineFail(p, ADV_ERR_WRITE);
+            return;
+        }
+        p->writeDone += (size_t)res;
+        p->writeOffset += (uint64_t)res;
+        if (p->writeDone < buf->size) {
+            if (!p->stop) ringQueueWrite(p);
+            return;
+        }
+        buf->state = PIPE_FREE;
+        p->writeNext++;
+    }
+}
+#endif
+
+#ifndef _WIN32
+// 일반 파일이 아닌 입력(파이프, 터미널, 소켓)인지. 이런 입력은 도착한 만큼만 읽을 수 있다.
+int isStreamSource(FILE* source) {
+    struct stat st;
+    return fstat(fileno(source), &st) == 0 && !S_ISREG(st.st_mode);
+}
+
+// 입력 기술자를 poll로 기다렸다가 read로 읽는다. want 바이트를 채우거나 입력이 끝나면 돌아오고,
+// partial이면 처음 읽은 만큼만 바로 돌려준다. 깨우기 파이프에 신호가 오면 읽은 것까지만 돌려준다.
+size_t pollRead(struct IoPipeline* p, unsigned char* data, size_t want, int* end, int* failed) {
+    size_t n = 0;
+    while (n < want) {
+        struct pollfd fds[2];
+        fds[0].fd = fileno(p->source);
+        fds[0].events = POLLIN;
+        fds[1].fd = p->wake[0];
+        fds[1].events = POLLIN;
+        if (poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) continue;
+            *failed = 1;
+            break;
+        }
+        if (fds[1].revents) break;
+        ssize_t got = read(fds[0].fd, &data[n], want - n);
+        if (got < 0) {
+            if (errno == EINTR || errno == EAGAIN) continue;
+            *failed = 1;
+            break;
+        }
+        if (got == 0) {
+            *end = 1;
+            break;
+        }
+        n += (size_t)got;
+        if (p->partial) break;
+    }
+    return n;
+}
+#endif
+
+// 입력 한 덩어리를 읽는다. 입력이 끝났으면 *end를 1로 한다.
+size_t pipelineFill(struct IoPipeline* p, unsigned char* data, size_t want, int* end, int* failed) {
+#ifndef _WIN32
+    if (p->pollSource) return pollRead(p, data, want, end, failed);
+#endif
+    size_t n = fread(data, 1, want, p->source);
+    *failed = ferror(p->source);
+    *end = n < want;
+    return n;
+}
+
+// 읽기 스레드: 빈 입력 버퍼를 차례로 채운다. 입력 끝이나 한도에 닿으면 끝난다.
+void* pipelineReaderMain(void* arg) {
+    struct IoPipeline* p = (struct IoPipeline*)arg;
+    pthread_mutex_lock(&p->lock);
+    while (!p->readEof) {
+        struct PipeBuffer* buf = &p->input[p->readNext % ADV_PIPELINE_BUFFERS];
+        while (!p->stop && buf->state != PIPE_FREE) pthread_cond_wait(&p->changed, &p->lock);
+        if (p->stop) break;
+        size_t want = p->inputCapacity;
+        if (want > p->readLimit) want = (size_t)p->readLimit;
+        buf->state = PIPE_BUSY;
+        pthread_mutex_unlock(&p->lock);
+
+        int end = 0;
+        int failed = 0;
+        size_t n = pipelineFill(p, buf->data, want, &end, &failed);
+
+        pthread_mutex_lock(&p->lock);
+        if (failed) {
+            buf->state = PIPE_FREE;
+            pipelineFail(p, ADV_ERR_READ);
+            pthread_cond_broadcast(&p->changed);
+            break;
+        }
+        p->readLimit -= n;
+        if (end || p->readLimit == 0) p->readEof = 1;
+        buf->size = n;
+        buf->state = n > 0 ? PIPE_READY : PIPE_FREE;
+        if (n > 0) p->readNext++;
+        pthread_cond_broadcast(&p->changed);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+// 쓰기 스레드: 채워진 출력 버퍼를 순서대로 기록한다. 코덱이 끝나고 남은 출력을 다 쓰면 끝난다.
+void* pipelineWriterMain(void* arg) {
+    struct IoPipeline* p = (struct IoPipeline*)arg;
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        struct PipeBuffer* buf = &p->output[p->writeNext % ADV_PIPELINE_BUFFERS];
+        while (!p->stop && !p->closing && buf->state != PIPE_READY) pthread_cond_wait(&p->changed, &p->lock);
+        if (p->stop || buf->state != PIPE_READY) break;
+        buf->state = PIPE_BUSY;
+        pthread_mutex_unlock(&p->lock);
+
+        int failed = fwrite(buf->data, 1, buf->size, p->dest) != buf->size;
+
+        pthread_mutex_lock(&p->lock);
+        buf->state = PIPE_FREE;
+        p->writeNext++;
+        if (failed) pipelineFail(p, ADV_ERR_WRITE);
+        pthread_cond_broadcast(&p->changed);
+    }
+    pthread_mutex_unlock(&p->lock);
+    return NULL;
+}
+
+#ifndef _WIN32
+// 깨우기 파이프의 쓰는 쪽을 닫으면 poll이 읽는 쪽의 끝을 알려 읽기 스레드가 깨어난다
+void wakeReader(struct IoPipeline* p) {
+    if (p->pollSource && p->wake[1] >= 0) {
+        close(p->wake[1]);
+        p->wake[1] = -1;
+    }
+}
+
+void closeWakePipe(struct IoPipeline* p) {
+    wakeReader(p);
+    if (p->pollSource) close(p->wake[0]);
+    p->pollSource = 0;
+}
+#endif
+
+void freePipelineBuffers(struct IoPipeline* p) {
+    for (int i = 0; i < ADV_PIPELINE_BUFFERS; i++) {
+        free(p->input[i].data);
+        free(p->output[i].data);
+    }
+}
+
+// source에서 inputSize 바이트씩(많아야 readLimit 바이트) 읽고, 출력은 outputSize 바이트까지 담아 dest에 쓴다.
+// source나 dest가 NULL이면 그쪽 단계는 없다 (dest가 NULL이면 출력은 버린다).
+// overlap이 0이면 스레드나 링 없이 호출 스레드에서 바로 읽고 쓴다.
+// partial이면 파이프 입력을 버퍼가 다 차기 전에도 도착한 만큼 넘긴다 (프레임을 모아 쓰는 해제 쪽).
+// 압축은 블록을 꽉 채워야 하므로 0으로 두고, 일반 파일은 언제나 버퍼를 채워 넘긴다.
+struct IoPipeline* pipelineCreate(FILE* source, size_t inputSize, uint64_t readLimit, FILE* dest, size_t outputSize, int overlap, int partial) {
+    struct IoPipeline* p = (struct IoPipeline*)calloc(1, sizeof(struct IoPipeline));
+    if (!p) return NULL;
+    p->source = source;
+    p->dest = dest;
+    p->inputCapacity = inputSize;
+    p->outputCapacity = outputSize;
+    p->readLimit = readLimit;
+    p->partial = partial;
+    p->backend = overlap ? PIPE_THREADS : PIPE_DIRECT;
+
+    // 직접 경로는 버퍼를 하나씩만 쓴다
+    int bufferCount = overlap ? ADV_PIPELINE_BUFFERS : 1;
+    int failed = 0;
+    for (int i = 0; i < bufferCount; i++) {
+        if (source) failed |= (p->input[i].data = (unsigned char*)malloc(inputSize + 1)) == NULL;
+        failed |= (p->output[i].data = (unsigned char*)malloc(outputSize + 1)) == NULL;
+    }
+    if (failed) {
+        freePipelineBuffers(p);
+        free(p);
+        return NULL;
+    }
+
+#ifdef ADV_HAVE_IO_URING
+    if (overlap && (!source || directFilePosition(source, &p->readOffset)) &&
+        (!dest || directFilePosition(dest, &p->writeOffset)) && ringInit(&p->ring, RING_ENTRIES) == 0) {
+        p->backend = PIPE_RING;
+        p->sourceFd = source ? fileno(source) : -1;
+        p->destFd = dest ? fileno(dest) : -1;
+        ringSubmitPending(p);
+        return p;
+    }
+#endif
+
+    if (p->backend == PIPE_THREADS) {
+        pthread_mutex_init(&p->lock, NULL);
+        pthread_cond_init(&p->changed, NULL);
+#ifndef _WIN32
+        // 파이프 입력은 기술자에서 읽는다 (깨우기 파이프를 만들 수 없으면 FILE로 읽는다)
+        p->pollSource = source && isStreamSource(source) && pipe(p->wake) == 0;
+#endif
+        // 스레드를 만들 수 없으면 직접 경로로 처리한다
+        p->readerStarted = source && pthread_create(&p->reader, NULL, pipelineReaderMain, p) == 0;
+        p->writerStarted = dest && pthread_create(&p->writer, NULL, pipelineWriterMain, p) == 0;
+        if ((source && !p->readerStarted) || (dest && !p->writerStarted)) {
+            pthread_mutex_lock(&p->lock);
+            p->stop = 1;
+            pthread_cond_broadcast(&p->changed);
+            pthread_mutex_unlock(&p->lock);
+            if (p->readerStarted) pthread_join(p->reader, NULL);
+            if (p->writerStarted) pthread_join(p->writer, NULL);
+            pthread_mutex_destroy(&p->lock);
+            pthread_cond_destroy(&p->changed);
+#ifndef _WIN32
+            closeWakePipe(p);
+#endif
+            p->readerStarted = p->writerStarted = 0;
+            p->stop = 0;
+            p->readEof = 0;
+            p->readLimit = readLimit;
+            p->readNext = 0;
+            p->backend = PIPE_DIRECT;
+        }
+    }
+    return p;
+}
+
+// 다음 입력 버퍼를 받는다. 앞서 받은 버퍼는 이때 돌려주므로 그 내용은 더 쓰지 않는다.
+// 입력이 끝나면 *size가 0이다.
+int pipelineRead(struct IoPipeline* p, const unsigned char** data, size_t* size) {
+    *data = NULL;
+    *size = 0;
+    if (p->backend == PIPE_DIRECT) {
+        size_t want = p->inputCapacity;
+        if (want > p->readLimit) want = (size_t)p->readLimit;
+        size_t n = want > 0 ? fread(p->input[0].data, 1, want, p->source) : 0;
+        if (ferror(p->source)) return ADV_ERR_READ;
+        p->readLimit -= n;
+        *data = p->input[0].data;
+        *size = n;
+        return ADV_OK;
+    }
+
+    struct PipeBuffer* held = &p->input[(p->consumeNext + ADV_PIPELINE_BUFFERS - 1) % ADV_PIPELINE_BUFFERS];
+    struct PipeBuffer* buf = &p->input[p->consumeNext % ADV_PIPELINE_BUFFERS];
+#ifdef ADV_HAVE_IO_URING
+    if (p->backend == PIPE_RING) {
+        if (p->holding) held->state = PIPE_FREE;
+        p->holding = 0;
+        for (;;) {
+            ringSubmitPending(p);
+            if (p->stop) return p->result;
+            if (buf->state == PIPE_READY) break;
+            if (p->readEof && p->consumeNext == p->readNext) return ADV_OK;
+            ringComplete(p);
+        }
+        p->holding = 1;
+        p->consumeNext++;
+        *data = buf->data;
+        *size = buf->size;
+        return ADV_OK;
+    }
+#endif
+
+    pthread_mutex_lock(&p->lock);
+    if (p->holding) {
+        held->state = PIPE_FREE;
+        pthread_cond_broadcast(&p->changed);
+    }
+    p->holding = 0;
+    while (!p->stop && buf->state != PIPE_READY && !(p->readEof && p->consumeNext == p->readNext)) {
+        pthread_cond_wait(&p->changed, &p->lock);
+    }
+    int result = p->result;
+    if (!p->stop && buf->state == PIPE_READY) {
+        p->holding = 1;
+        p->consumeNext++;
+        *data = buf->data;
+        *size = buf->size;
+    }
+    pthread_mutex_unlock(&p->lock);
+    return result;
+}
+
+// 코덱이 채울 빈 출력 버퍼를 받는다. 앞선 출력이 기록되어 버퍼가 빌 때까지 기다린다.
+int pipelineOutput(struct IoPipeline* p, unsigned char** data) {
+    struct PipeBuffer* buf = &p->output[p->fillNext % ADV_PIPELINE_BUFFERS];
+    *data = NULL;
+    if (p->backend == PIPE_DIRECT) {
+        *data = p->output[0].data;
+        return ADV_OK;
+    }
+#ifdef ADV_HAVE_IO_URING
+    if (p->backend == PIPE_RING) {
+        for (;;) {
+            ringSubmitPending(p);
+            if (p->stop) return p->result;
+            if (buf->state == PIPE_FREE) break;
+            ringComplete(p);
+        }
+        *data = buf->data;
+        return ADV_OK;
+    }
+#endif
+    pthread_mutex_lock(&p->lock);
+    while (!p->stop && buf->state != PIPE_FREE) pthread_cond_wait(&p->changed, &p->lock);
+    int result = p->result;
+    if (!p->stop) *data = buf->data;
+    pthread_mutex_unlock(&p->lock);
+    return result;
+}
+
+// pipelineOutput으로 받은 버퍼의 앞 size 바이트를 기록하도록 넘긴다
+int pipelineWrite(struct IoPipeline* p, size_t size) {
+    if (p->backend == PIPE_DIRECT) {
+        if (p->dest && size > 0 && fwrite(p->output[0].data, 1, size, p->dest) != size) return ADV_ERR_WRITE;
+        return ADV_OK;
+    }
+    struct PipeBuffer* buf = &p->output[p->fillNext % ADV_PIPELINE_BUFFERS];
+    // 쓸 곳이 없으면(검사만 할 때) 버퍼를 바로 비운다
+    if (!p->dest || size == 0) return p->result;
+#ifdef ADV_HAVE_IO_URING
+    if (p->backend == PIPE_RING) {
+        buf->size = size;
+        buf->state = PIPE_READY;
+        p->fillNext++;
+        ringSubmitPending(p);
+        return p->result;
+    }
+#endif
+    pthread_mutex_lock(&p->lock);
+    buf->size = size;
+    buf->state = PIPE_READY;
+    p->fillNext++;
+    pthread_cond_broadcast(&p->changed);
+    int result = p->result;
+    pthread_mutex_unlock(&p->lock);
+    return result;
+}
+
+// 남은 출력을 모두 기록하고(result가 ADV_OK일 때만) 파이프라인을 해제한다.
+// 처음 난 오류를 돌려주며, 끝나면 source와 dest의 FILE 위치는 실제로 읽고 쓴 곳 뒤에 있다.
+// 읽기는 코덱보다 버퍼 ADV_PIPELINE_BUFFERS개까지 앞서므로 source는 코덱이 쓴 입력보다 더 나가 있을 수 있다.
+// 같은 스트림을 이어서 읽을 호출자는 readLimit로 읽을 양을 정확히 정해야 한다 (파이프는 되돌릴 수 없다).
+int pipelineClose(struct IoPipeline* p, int result) {
+    if (p->backend == PIPE_THREADS) {
+        pthread_mutex_lock(&p->lock);
+        if (result != ADV_OK) p->stop = 1;
+        p->closing = 1;
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+        if (p->writerStarted) pthread_join(p->writer, NULL);
+        // 코덱이 끝났으니 남은 입력은 필요 없다. 파이프 입력을 poll에서 기다리는 읽기 스레드는
+        // 깨우기 파이프로 깨워 쓰는 쪽이 열려 있어도 기다리지 않는다 (FILE로 읽는 중이면 그 읽기를 마친다).
+        pthread_mutex_lock(&p->lock);
+        p->stop = 1;
+        pthread_cond_broadcast(&p->changed);
+        pthread_mutex_unlock(&p->lock);
+#ifndef _WIN32
+        wakeReader(p);
+#endif
+        if (p->readerStarted) pthread_join(p->reader, NULL);
+        pthread_mutex_destroy(&p->lock);
+        pthread_cond_destroy(&p->changed);
+#ifndef _WIN32
+        closeWakePipe(p);
+#endif
+    }
+#ifdef ADV_HAVE_IO_URING
+    if (p->backend == PIPE_RING) {
+        if (result != ADV_OK) p->stop = 1;
+        p->closing = 1;
+        while (!p->stop && p->writeNext != p->fillNext) {
+            ringSubmitPending(p);
+            ringComplete(p);
+        }
+        // 커널이 버퍼를 쓰는 동안에는 해제할 수 없으므로 진행 중인 I/O가 끝나기를 기다린다
+        p->stop = 1;
+        while (p->readBusy || p->writeBusy) ringComplete(p);
+        ringFree(&p->ring);
+        if (p->source) fseek(p->source, (long)p->readOffset, SEEK_SET);
+        if (p->dest) fseek(p->dest, (long)p->writeOffset, SEEK_SET);
+    }
+#endif
+    if (result == ADV_OK) result = p->result;
+    freePipelineBuffers(p);
+    free(p);
+    return result;
+}
+
+// 파이프라인을 만들기 전에 입력의 앞부분을 읽는다. 파이프 입력은 파이프라인이 기술자에서 직접 읽으므로
+// 여기서도 read로 필요한 만큼만 읽어 FILE 버퍼에 입력이 남지 않게 한다.
+int readSourceHead(FILE* source, unsigned char* data, size_t size, size_t* got) {
+    *got = 0;
+#ifndef _WIN32
+    if (isStreamSource(source)) {
+        while (*got < size) {
+            ssize_t n = read(fileno(source), &data[*got], size - *got);
+            if (n < 0 && errno == EINTR) continue;
+            if (n < 0) return ADV_ERR_READ;
+            if (n == 0) break;
+            *got += (size_t)n;
+        }
+        return ADV_OK;
+    }
+#endif
+    *got = fread(data, 1, size, source);
+    return ferror(source) ? ADV_ERR_READ : ADV_OK;
+}
+
+// 남은 입력이 limit 바이트 이하인 일반 파일인지 (파이프라인을 겹쳐 돌릴 필요가 없는 입력)
+int fitsInBuffer(FILE* source, uint64_t limit) {
+    long long size = sourceSize(source);
+    if (size > 0) return (uint64_t)size <= limit;
+    struct stat st;
+    return fstat(fileno(source), &st) == 0 && S_ISREG(st.st_mode);
+}
@@ -0,0 +1,131 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include "adv_internal.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <time.h>
+#endif
+
+// 블록 작업을 여러 코어에 나눠 처리하는 워커 풀
+// runParallel이 배치 하나를 넘기면 워커들이 작업 번호를 하나씩 가져가 처리한다.
+struct WorkerPool {
+    pthread_t *threads;
+    int threadCount;
+    pthread_mutex_t lock;
+    pthread_cond_t workReady;
+    pthread_cond_t workDone;
+    void (*taskFn)(void *ctx, size_t index);
+    void *taskCtx;
+    size_t taskCount;
+    size_t nextTask;
+    size_t doneTasks;
+    int shutdown;
+};
+
+// 사용 가능한 CPU 코어 수
+int getCpuCount(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ? (int)info.dwNumberOfProcessors : 1;
+#else
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (int)n : 1;
+#endif
+}
+
+// 단조 증가하는 벽시계 시간(초). clock()과 달리 여러 스레드의 CPU 시간이 합산되지 않는다.
+double getMonotonicTime(void) {
+#ifdef _WIN32
+    LARGE_INTEGER freq, now;
+    QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (double)now.QuadPart / (double)freq.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+#endif
+}
+
+void *workerPoolMain(void *arg) {
+    struct WorkerPool *pool = (struct WorkerPool *)arg;
+    pthread_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->shutdown && pool->nextTask >= pool->taskCount) {
+            pthread_cond_wait(&pool->workReady, &pool->lock);
+        }
+        if (pool->shutdown) break;
+        size_t index = pool->nextTask++;
+        pthread_mutex_unlock(&pool->lock);
+
+        pool->taskFn(pool->taskCtx, index);
+
+        pthread_mutex_lock(&pool->lock);
+        if (++pool->doneTasks == pool->taskCount) {
+            pthread_cond_signal(&pool->workDone);
+        }
+    }
+    pthread_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+struct WorkerPool *createWorkerPool(int threadCount) {
+    struct WorkerPool *pool = (struct WorkerPool *)calloc(1, sizeof(struct WorkerPool));
+    if (!pool) return NULL;
+    pool->threads = (pthread_t *)malloc(threadCount * sizeof(pthread_t));
+    if (!pool->threads) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->workReady, NULL);
+    pthread_cond_init(&pool->workDone, NULL);
+    for (int i = 0; i < threadCount; i++) {
+        if (pthread_create(&pool->threads[i], NULL, workerPoolMain, pool) != 0) break;
+        pool->threadCount++;
+    }
+    if (pool->threadCount == 0) {
+        free(pool->threads);
+        free(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+void destroyWorkerPool(struct WorkerPool *pool) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->shutdown = 1;
+    pthread_cond_broadcast(&pool->workReady);
+    pthread_mutex_unlock(&pool->lock);
+    for (int i = 0; i < pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->workReady);
+    pthread_cond_destroy(&pool->workDone);
+    free(pool->threads);
+    free(pool);
+}
+
+// taskFn(ctx, 0..count-1)을 풀에서 병렬로 실행하고 모두 끝날 때까지 기다린다
+void runParallel(struct WorkerPool *pool, size_t count, void (*taskFn)(void *ctx, size_t index), void *ctx) {
+    if (count == 0) return;
+    pthread_mutex_lock(&pool->lock);
+    pool->taskFn = taskFn;
+    pool->taskCtx = ctx;
+    pool->taskCount = count;
+    pool->nextTask = 0;
+    pool->doneTasks = 0;
+    pthread_cond_broadcast(&pool->workReady);
+    while (pool->doneTasks < pool->taskCount) {
+        pthread_cond_wait(&pool->workDone, &pool->lock);
+    }
+    pool->taskCount = 0;
+    pool->nextTask = 0;
+    pthread_mutex_unlock(&pool->lock);
+}
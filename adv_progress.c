@@ -0,0 +1,65 @@
+#include <string.h>
+#include <sys/stat.h>
+#include "adv_internal.h"
+
+// 작업 루프의 진행 보고
+// 카운터와 단계별 시간은 작업 스레드에서만 갱신하고, 콜백은 간격마다 한 번 불러
+// 보고 비용이 블록 수와 무관하게 작게 유지되도록 한다.
+
+void progressStart(struct ProgressMeter* meter, const struct AdvOptions* options, long long totalBytes) {
+    memset(meter, 0, sizeof(*meter));
+    meter->state.totalBytes = totalBytes;
+    if (options != NULL) {
+        meter->fn = options->progress;
+        meter->userData = options->progressData;
+        meter->interval = options->progressInterval;
+        meter->cancel = options->cancel;
+    }
+    if (meter->interval <= 0) meter->interval = ADV_PROGRESS_INTERVAL;
+    meter->startTime = getMonotonicTime();
+    meter->lastReport = meter->startTime;
+    meter->stageStart = meter->startTime;
+    meter->stage = ADV_STAGE_READ;
+}
+
+// 지금까지 머문 시간을 현재 단계에 더하고 다음 단계로 넘어간다
+void progressStage(struct ProgressMeter* meter, int stage) {
+    double now = getMonotonicTime();
+    meter->state.stageTime[meter->stage] += now - meter->stageStart;
+    meter->stageStart = now;
+    meter->stage = stage;
+}
+
+void progressAdvance(struct ProgressMeter* meter, long long inputBytes, long long outputBytes, long long blocks) {
+    meter->state.inputBytes += inputBytes;
+    meter->state.outputBytes += outputBytes;
+    meter->state.blocks += blocks;
+    if (meter->fn == NULL) return;
+    double now = getMonotonicTime();
+    if (now - meter->lastReport < meter->interval) return;
+    meter->lastReport = now;
+    meter->state.elapsed = now - meter->startTime;
+    meter->fn(&meter->state, meter->userData);
+}
+
+// 마지막 보고는 간격과 관계없이 보낸다
+void progressFinish(struct ProgressMeter* meter) {
+    progressStage(meter, meter->stage);
+    meter->state.elapsed = meter->stageStart - meter->startTime;
+    meter->state.finished = 1;
+    if (meter->fn != NULL) meter->fn(&meter->state, meter->userData);
+}
+
+// 호출자가 취소를 요청했는지 (작업 루프가 배치 사이에서 확인한다)
+int progressCancelled(const struct ProgressMeter* meter) {
+    return meter->cancel != NULL && *meter->cancel != 0;
+}
+
+// 일반 파일이면 남은 입력 크기를, 파이프처럼 알 수 없으면 0을 돌려준다
+long long sourceSize(FILE* source) {
+    struct stat st;
+    if (fstat(fileno(source), &st) != 0 || !S_ISREG(st.st_mode)) return 0;
+    long position = ftell(source);
+    if (position < 0 || position > st.st_size) return 0;
+    return (long long)st.st_size - position;
+}
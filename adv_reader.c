@@ -0,0 +1,256 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "adv_internal.h"
+
+// 임의 위치 읽기
+// 블록은 서로 독립적이고 블록 인덱스가 블록마다 프레임 위치와 원본 크기를 담고 있으므로,
+// 원본의 (offset, length) 구간은 그 구간이 걸친 블록만 풀면 읽을 수 있다. 인덱스가 블록마다
+// 재시작 지점이라 형식은 바꾸지 않는다. 푼 블록은 작은 LRU 캐시에 두어 가까운 곳을 다시 읽을 때 재사용한다.
+
+// 캐시 슬롯 하나: 푼 블록 하나
+struct ReaderSlot {
+    size_t block;     // 담긴 블록 번호 (SIZE_MAX면 비어 있음)
+    uint64_t lastUse; // 마지막으로 쓴 시각 (reader의 사용 카운터)
+    unsigned char* data;
+};
+
+struct AdvReader {
+    FILE* source;
+    int version;
+    size_t blockCount;
+    uint64_t* frameOffset; // 블록마다 프레임의 파일 내 위치
+    uint64_t* rawOffset;   // 블록마다 원본에서의 시작 위치 (blockCount번째는 원본 전체 크기)
+    unsigned char* frame;  // 프레임을 읽어 들이는 버퍼
+    struct ReaderSlot* slots;
+    size_t slotCount;
+    uint64_t useCounter;
+    struct AdvReaderStats stats;
+};
+
+void advReaderClose(struct AdvReader* reader) {
+    if (reader == NULL) return;
+    for (size_t i = 0; i < reader->slotCount; i++) free(reader->slots[i].data);
+    free(reader->slots);
+    free(reader->frameOffset);
+    free(reader->rawOffset);
+    free(reader->frame);
+    free(reader);
+}
+
+// 인덱스가 없는 파일은 프레임 헤더만 차례로 읽고 페이로드는 건너뛰어 같은 표를 만든다.
+// start부터 끝 프레임을 만나거나 blockLimit개를 지날 때까지 훑는다.
+int scanFrameHeaders(FILE* source, uint64_t start, size_t blockLimit, size_t* blockCount, uint64_t** frameOffset, uint32_t** rawSize) {
+    size_t count = 0;
+    size_t capacity = 64;
+    uint64_t* offsets = (uint64_t*)malloc(capacity * sizeof(uint64_t));
+    uint32_t* sizes = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    int result = offsets && sizes ? ADV_OK : ADV_ERR_NOMEM;
+    uint64_t pos = start;
+    while (result == ADV_OK && count < blockLimit) {
+        unsigned char header[ADV_BLOCK_HEADER_SIZE];
+        if (fseek(source, (long)pos, SEEK_SET) != 0 || fread(header, 1, 1, source) != 1) {
+            result = ferror(source) ? ADV_ERR_READ : ADV_ERR_FORMAT;
+            break;
+        }
+        if (header[0] == ADV_BLOCK_END) {
+            if (blockLimit != SIZE_MAX) result = ADV_ERR_FORMAT;
+            break;
+        }
+        if (fread(&header[1], 1, ADV_BLOCK_HEADER_SIZE - 1, source) != ADV_BLOCK_HEADER_SIZE - 1) {
+            result = ferror(source) ? ADV_ERR_READ : ADV_ERR_FORMAT;
+            break;
+        }
+        uint32_t raw = getLE32(&header[1]);
+        uint32_t payloadSize = getLE32(&header[5]);
+        if (raw > ADV_BLOCK_SIZE || payloadSize > ADV_BLOCK_BOUND(ADV_BLOCK_SIZE) - ADV_BLOCK_HEADER_SIZE) {
+            result = ADV_ERR_FORMAT;
+            break;
+        }
+        if (count == capacity) {
+            capacity *= 2;
+            uint64_t* newOffsets = (uint64_t*)realloc(offsets, capacity * sizeof(uint64_t));
+            if (newOffsets) offsets = newOffsets;
+            uint32_t* newSizes = (uint32_t*)realloc(sizes, capacity * sizeof(uint32_t));
+            if (newSizes) sizes = newSizes;
+            if (!newOffsets || !newSizes) {
+                result = ADV_ERR_NOMEM;
+                break;
+            }
+        }
+        offsets[count] = pos;
+        sizes[count] = raw;
+        count++;
+        pos += ADV_BLOCK_HEADER_SIZE + payloadSize;
+    }
+    if (result != ADV_OK) {
+        free(offsets);
+        free(sizes);
+        return result;
+    }
+    *blockCount = count;
+    *frameOffset = offsets;
+    *rawSize = sizes;
+    return ADV_OK;
+}
+
+// 블록 표를 받아 reader를 만든다 (frameOffset의 소유권이 넘어온다)
+int createReader(FILE* source, int version, size_t blockCount, uint64_t* frameOffset, const uint32_t* rawSize, size_t cacheBlocks, struct AdvReader** reader) {
+    struct AdvReader* r = (struct AdvReader*)calloc(1, sizeof(struct AdvReader));
+    if (!r) {
+        free(frameOffset);
+        return ADV_ERR_NOMEM;
+    }
+    r->source = source;
+    r->version = version;
+    r->blockCount = blockCount;
+    r->frameOffset = frameOffset;
+    r->rawOffset = (uint64_t*)malloc((blockCount + 1) * sizeof(uint64_t));
+    r->frame = (unsigned char*)malloc(ADV_BLOCK_BOUND(ADV_BLOCK_SIZE));
+    r->slotCount = cacheBlocks > 0 ? cacheBlocks : 1;
+    r->slots = (struct ReaderSlot*)calloc(r->slotCount, sizeof(struct ReaderSlot));
+    if (!r->rawOffset || !r->frame || !r->slots) {
+        if (!r->slots) r->slotCount = 0;
+        advReaderClose(r);
+        return ADV_ERR_NOMEM;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < blockCount; i++) {
+        r->rawOffset[i] = total;
+        total += rawSize[i];
+    }
+    r->rawOffset[blockCount] = total;
+    // 슬롯 버퍼는 처음 쓸 때 잡는다 (작은 파일은 블록 수보다 많이 잡지 않는다)
+    for (size_t i = 0; i < r->slotCount; i++) r->slots[i].block = SIZE_MAX;
+    *reader = r;
+    return ADV_OK;
+}
+
+int advReaderOpen(FILE* source, size_t cacheBlocks, struct AdvReader** reader) {
+    *reader = NULL;
+    unsigned char header[ADV_FILE_HEADER_SIZE];
+    if (fseek(source, 0, SEEK_SET) != 0) return ADV_ERR_READ;
+    if (fread(header, 1, sizeof(header), source) != sizeof(header)) return ferror(source) ? ADV_ERR_READ : ADV_ERR_FORMAT;
+    if (memcmp(header, ADV_MAGIC, ADV_MAGIC_SIZE) != 0) return ADV_ERR_UNSUPPORTED; // v0: 블록 경계가 없다
+    int version = header[ADV_MAGIC_SIZE];
+    if (!isFramedVersion(version)) return version == 1 ? ADV_ERR_UNSUPPORTED : ADV_ERR_FORMAT;
+    if (header[ADV_MAGIC_SIZE + 1] & ADV_FLAG_ARCHIVE) return ADV_ERR_ARCHIVE;
+
+    size_t blockCount;
+    uint64_t* frameOffset = NULL;
+    uint32_t* rawSize = NULL;
+    uint32_t fileChecksum;
+    int result = ADV_ERR_FORMAT;
+    if (header[ADV_MAGIC_SIZE + 1] & ADV_FLAG_INDEX) {
+        result = readBlockIndex(version, source, &blockCount, &frameOffset, &rawSize, &fileChecksum);
+    }
+    if (result == ADV_ERR_FORMAT) result = scanFrameHeaders(source, ADV_FILE_HEADER_SIZE, SIZE_MAX, &blockCount, &frameOffset, &rawSize);
+    if (result != ADV_OK) return result;
+    result = createReader(source, version, blockCount, frameOffset, rawSize, cacheBlocks, reader);
+    free(rawSize);
+    return result;
+}
+
+int advReaderOpenEntry(FILE* source, const struct AdvArchive* archive, size_t index, size_t cacheBlocks, struct AdvReader** reader) {
+    *reader = NULL;
+    if (index >= archive->count) return ADV_ERR_UNSUPPORTED;
+    const struct AdvArchiveEntry* entry = &archive->entries[index];
+    size_t blockCount;
+    uint64_t* frameOffset;
+    uint32_t* rawSize;
+    int result = scanFrameHeaders(source, entry->offset, entry->blockCount, &blockCount, &frameOffset, &rawSize);
+    if (result != ADV_OK) return result;
+    uint64_t total = 0;
+    for (size_t i = 0; i < blockCount; i++) total += rawSize[i];
+    // 항목의 프레임이 디렉터리에 기록된 범위와 크기에 맞아야 한다
+    if (total != entry->size ||
+        (blockCount > 0 && frameOffset[blockCount - 1] + ADV_BLOCK_HEADER_SIZE > entry->offset + entry->packedSize)) {
+        free(frameOffset);
+        free(rawSize);
+        return ADV_ERR_FORMAT;
+    }
+    result = createReader(source, archive->version, blockCount, frameOffset, rawSize, cacheBlocks, reader);
+    free(rawSize);
+    return result;
+}
+
+unsigned long long advReaderSize(const struct AdvReader* reader) {
+    return reader->rawOffset[reader->blockCount];
+}
+
+void advReaderGetStats(const struct AdvReader* reader, struct AdvReaderStats* stats) {
+    *stats = reader->stats;
+}
+
+// 블록 하나를 캐시에서 찾고, 없으면 가장 오래 쓰지 않은 슬롯에 풀어 넣는다
+int readerBlock(struct AdvReader* r, size_t block, const unsigned char** data) {
+    struct ReaderSlot* victim = &r->slots[0];
+    for (size_t i = 0; i < r->slotCount; i++) {
+        struct ReaderSlot* slot = &r->slots[i];
+        if (slot->block == block) {
+            slot->lastUse = ++r->useCounter;
+            r->stats.cacheHits++;
+            *data = slot->data;
+            return ADV_OK;
+        }
+        if (slot->lastUse < victim->lastUse) victim = slot;
+    }
+
+    if (!victim->data) {
+        victim->data = (unsigned char*)malloc(ADV_BLOCK_SIZE);
+        if (!victim->data) return ADV_ERR_NOMEM;
+    }
+    victim->block = SIZE_MAX;
+    size_t rawSize = (size_t)(r->rawOffset[block + 1] - r->rawOffset[block]);
+    unsigned char* frame = r->frame;
+    if (fseek(r->source, (long)r->frameOffset[block], SEEK_SET) != 0 ||
+        fread(frame, 1, ADV_BLOCK_HEADER_SIZE, r->source) != ADV_BLOCK_HEADER_SIZE) {
+        return ferror(r->source) ? ADV_ERR_READ : ADV_ERR_FORMAT;
+    }
+    size_t payloadSize = getLE32(&frame[5]);
+    if (frame[0] == ADV_BLOCK_END || getLE32(&frame[1]) != rawSize ||
+        payloadSize > ADV_BLOCK_BOUND(ADV_BLOCK_SIZE) - ADV_BLOCK_HEADER_SIZE) {
+        return ADV_ERR_FORMAT;
+    }
+    if (fread(&frame[ADV_BLOCK_HEADER_SIZE], 1, payloadSize, r->source) != payloadSize) {
+        return ferror(r->source) ? ADV_ERR_READ : ADV_ERR_FORMAT;
+    }
+    // v4는 블록 CRC32C를 검사한다 (파일 전체의 CRC32C는 일부만 읽으므로 검사할 수 없다)
+    int result = decodeBlock(r->version, frame[0], &frame[ADV_BLOCK_HEADER_SIZE], payloadSize, victim->data, rawSize, NULL);
+    if (result != ADV_OK) return result;
+    victim->block = block;
+    victim->lastUse = ++r->useCounter;
+    r->stats.blocksDecoded++;
+    r->stats.bytesRead += ADV_BLOCK_HEADER_SIZE + payloadSize;
+    *data = victim->data;
+    return ADV_OK;
+}
+
+// offset부터 length 바이트를 buffer에 읽는다. 구간이 걸친 블록만 풀며, 원본 끝을 넘는 부분은 읽지 않는다.
+int advReaderRead(struct AdvReader* reader, unsigned long long offset, void* buffer, size_t length, size_t* got) {
+    *got = 0;
+    uint64_t total = reader->rawOffset[reader->blockCount];
+    if (offset >= total || length == 0) return ADV_OK;
+    if (length > total - offset) length = (size_t)(total - offset);
+
+    // offset을 담은 블록: rawOffset[block] <= offset < rawOffset[block + 1]
+    size_t lo = 0, hi = reader->blockCount;
+    while (hi - lo > 1) {
+        size_t mid = lo + (hi - lo) / 2;
+        if (reader->rawOffset[mid] <= offset) lo = mid;
+        else hi = mid;
+    }
+
+    unsigned char* out = (unsigned char*)buffer;
+    for (size_t block = lo; *got < length; block++) {
+        const unsigned char* data;
+        int result = readerBlock(reader, block, &data);
+        if (result != ADV_OK) return result;
+        size_t start = (size_t)(offset + *got - reader->rawOffset[block]);
+        size_t n = (size_t)(reader->rawOffset[block + 1] - reader->rawOffset[block]) - start;
+        if (n > length - *got) n = length - *got;
+        memcpy(&out[*got], &data[start], n);
+        *got += n;
+    }
+    return ADV_OK;
+}
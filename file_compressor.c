@@ -3,364 +3,77 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
-#include <time.h>
 #include <sys/stat.h>
+#include "adv_codec.h"
 
 #ifdef _WIN32
 #include <windows.h>
 #include <commdlg.h>
 #endif
 
-#define CHUNK 16384
-#define MAX_TREE_HT 100
+#define PROGRESS_UPDATE_MS 100 // 진행 바와 작업 목록 갱신 간격
+#define JOB_QUEUE_CAPACITY 256 // 처리를 기다릴 수 있는 최대 작업 수
+#define JOB_WORKERS_MAX 4      // 동시에 처리하는 최대 파일 수 (작업 하나도 블록을 모든 코어에 나눈다)
+
+// 작업 목록 열
+enum {
+    JOB_COL_FILE = 0,
+    JOB_COL_MODE,
+    JOB_COL_STATE,
+    JOB_COL_PERCENT,
+    JOB_COL_RESULT,
+    JOB_COL_COUNT
+};
 
+// 파일 하나의 작업. 작업 스레드가 처리하고 UI 스레드가 완료 처리 후 해제한다.
 typedef struct {
     char *inputFile;
     char *outputFile;
+    gboolean isCompress;
+    long fileSize;        // 등록할 때 잰 입력 크기
+    long totalProcessed;
+    long outputSize;
+    const char *error;    // 실패했을 때의 메시지 (성공이면 NULL)
+    volatile int cancel;  // UI 스레드가 설정하면 코덱이 다음 배치 전에 멈춘다
+    gboolean cancelled;   // 취소되어 끝남 (작업 스레드가 설정)
+    GtkTreeIter row;      // 작업 목록의 행 (UI 스레드에서만 사용)
+    GMutex progressLock;  // 작업 스레드가 쓰고 UI 타이머가 읽는 progress 보호
+    struct AdvProgress progress;
+} ThreadData;
+
+// 작업 스케줄러: 고정된 수의 작업 스레드가 크기가 제한된 대기열에서 작업을 꺼내 처리한다.
+// 여러 파일을 한꺼번에 넣어도 동시에 도는 작업 수와 메모리가 일정하게 유지된다.
+typedef struct {
+    ThreadData *queue[JOB_QUEUE_CAPACITY];
+    size_t head;
+    size_t count;
+    GMutex lock;
+    GCond jobReady;
+    int workerCount;
+
+    // 이하는 UI 스레드에서만 사용
+    GList *activeJobs;     // 대기 중이거나 처리 중인 작업
+    long long batchBytes;  // 지금 묶음에 들어온 작업의 입력 크기 합
+    long long doneBytes;   // 그중 끝난 작업의 입력 크기 합
+    long long outputBytes; // 끝난 작업의 출력 크기 합
+    int doneJobs;
+    int failedJobs;
+    int cancelledJobs;
     GtkWidget *progressBar;
     GtkWidget *statusLabel;
     GtkWidget *logView;
     GtkWidget *fileInfoLabel;
     GtkWidget *speedLabel;
-    gboolean isCompress;
-    long fileSize;
-    long totalProcessed;
-    clock_t startTime;
-} ThreadData;
-
-// 하프만 트리 노드 정의
-struct MinHeapNode {
-    unsigned char data;
-    unsigned freq;
-    struct MinHeapNode *left, *right;
-};
-
-// 하프만 힙 정의
-struct MinHeap {
-    unsigned size;
-    unsigned capacity;
-    struct MinHeapNode **array;
-};
-
-// 하프만 코딩과 관련된 함수들
-struct MinHeapNode* newNode(unsigned char data, unsigned freq) {
-    struct MinHeapNode* temp = (struct MinHeapNode*) malloc(sizeof(struct MinHeapNode));
-    temp->left = temp->right = NULL;
-    temp->data = data;
-    temp->freq = freq;
-    return temp;
-}
-
-struct MinHeap* createMinHeap(unsigned capacity) {
-    struct MinHeap* minHeap = (struct MinHeap*) malloc(sizeof(struct MinHeap));
-    minHeap->size = 0;
-    minHeap->capacity = capacity;
-    minHeap->array = (struct MinHeapNode**) malloc(minHeap->capacity * sizeof(struct MinHeapNode*));
-    return minHeap;
-}
-
-void swapMinHeapNode(struct MinHeapNode** a, struct MinHeapNode** b) {
-    struct MinHeapNode* t = *a;
-    *a = *b;
-    *b = t;
-}
-
-void minHeapify(struct MinHeap* minHeap, int idx) {
-    int smallest = idx;
-    int left = 2 * idx + 1;
-    int right = 2 * idx + 2;
-
-    if (left < minHeap->size && minHeap->array[left]->freq < minHeap->array[smallest]->freq)
-        smallest = left;
-
-    if (right < minHeap->size && minHeap->array[right]->freq < minHeap->array[smallest]->freq)
-        smallest = right;
-
-    if (smallest != idx) {
-        swapMinHeapNode(&minHeap->array[smallest], &minHeap->array[idx]);
-        minHeapify(minHeap, smallest);
-    }
-}
-
-struct MinHeapNode* extractMin(struct MinHeap* minHeap) {
-    struct MinHeapNode* temp = minHeap->array[0];
-    minHeap->array[0] = minHeap->array[minHeap->size - 1];
-    --minHeap->size;
-    minHeapify(minHeap, 0);
-    return temp;
-}
-
-void insertMinHeap(struct MinHeap* minHeap, struct MinHeapNode* minHeapNode) {
-    ++minHeap->size;
-    int i = minHeap->size - 1;
-    while (i && minHeapNode->freq < minHeap->array[(i - 1) / 2]->freq) {
-        minHeap->array[i] = minHeap->array[(i - 1) / 2];
-        i = (i - 1) / 2;
-    }
-    minHeap->array[i] = minHeapNode;
-}
-
-void buildMinHeap(struct MinHeap* minHeap) {
-    int n = minHeap->size - 1;
-    for (int i = (n - 1) / 2; i >= 0; --i)
-        minHeapify(minHeap, i);
-}
-
-struct MinHeap* createAndBuildMinHeap(unsigned char data[], unsigned freq[], int size) {
-    struct MinHeap* minHeap = createMinHeap(size);
-    for (int i = 0; i < size; ++i)
-        minHeap->array[i] = newNode(data[i], freq[i]);
-    minHeap->size = size;
-    buildMinHeap(minHeap);
-    return minHeap;
-}
-
-struct MinHeapNode* buildHuffmanTree(unsigned char data[], unsigned freq[], int size) {
-    struct MinHeapNode *left, *right, *top;
-    struct MinHeap* minHeap = createAndBuildMinHeap(data, freq, size);
-    while (minHeap->size != 1) {
-        left = extractMin(minHeap);
-        right = extractMin(minHeap);
-        top = newNode('$', left->freq + right->freq);
-        top->left = left;
-        top->right = right;
-        insertMinHeap(minHeap, top);
-    }
-    struct MinHeapNode* root = extractMin(minHeap);
-    free(minHeap->array);
-    free(minHeap);
-    return root;
-}
-
-void printCodes(struct MinHeapNode* root, char **codes, char arr[], int top) {
-    if (root->left) {
-        arr[top] = '0';
-        printCodes(root->left, codes, arr, top + 1);
-    }
-    if (root->right) {
-        arr[top] = '1';
-        printCodes(root->right, codes, arr, top + 1);
-    }
-    if (!(root->left) && !(root->right)) {
-        arr[top] = '\0';
-        codes[root->data] = strdup(arr);
-    }
-}
-
-char** generateHuffmanCodes(struct MinHeapNode* root) {
-    char** codes = (char**) malloc(256 * sizeof(char*));
-    for(int i = 0; i < 256; i++) codes[i] = NULL;
-    char arr[MAX_TREE_HT];
-    printCodes(root, codes, arr, 0);
-    return codes;
-}
-
-void freeHuffmanTree(struct MinHeapNode* root) {
-    if (root == NULL) return;
-    freeHuffmanTree(root->left);
-    freeHuffmanTree(root->right);
-    free(root);
-}
-
-// 하프만 압축 함수 (비트 패킹 적용)
-size_t huffmanEncode(const unsigned char* input, size_t size, unsigned char* output, char** codes) {
-    size_t outIdx = 0;
-    unsigned char currentByte = 0;
-    int bitPos = 7; // 현재 바이트의 비트 위치 (7부터 0까지)
-
-    for (size_t i = 0; i < size; i++) {
-        char* code = codes[input[i]];
-        if (code == NULL) continue; // 빈도수가 0인 경우
-        size_t codeLen = strlen(code);
-        for (size_t j = 0; j < codeLen; j++) {
-            if (code[j] == '1') {
-                currentByte |= (1 << bitPos);
-            }
-            bitPos--;
-            if (bitPos < 0) {
-                output[outIdx++] = currentByte;
-                currentByte = 0;
-                bitPos = 7;
-            }
-        }
-    }
-
-    // 마지막에 남은 비트가 있으면 패딩하여 저장
-    if (bitPos != 7) {
-        output[outIdx++] = currentByte;
-    }
-
-    return outIdx;
-}
-
-// 하프만 압축 해제 함수 (비트 언패킹 적용)
-unsigned char* huffmanDecode(const unsigned char* encodedData, size_t encodedSize, struct MinHeapNode* root, size_t* decodedSize) {
-    unsigned char* decoded = (unsigned char*)malloc(encodedSize * 8); // 임시 버퍼
-    if (!decoded) {
-        fprintf(stderr, "메모리 할당 실패 (Huffman Decode)\n");
-        exit(1);
-    }
-
-    size_t outIdx = 0;
-    struct MinHeapNode* current = root;
-
-    for (size_t i = 0; i < encodedSize; i++) {
-        unsigned char byte = encodedData[i];
-        for (int bit = 7; bit >= 0; bit--) {
-            int bitValue = (byte >> bit) & 1;
-            if (bitValue == 0) {
-                current = current->left;
-            } else {
-                current = current->right;
-            }
-
-            if (!current->left && !current->right) {
-                decoded[outIdx++] = current->data;
-                current = root;
-            }
-        }
-    }
-
-    *decodedSize = outIdx;
-    return decoded;
-}
-
-// 하프만 압축을 위한 빈도 계산
-void calculateFrequency(const unsigned char* input, size_t size, unsigned freq[]) {
-    memset(freq, 0, 256 * sizeof(unsigned));
-    for (size_t i = 0; i < size; i++) {
-        freq[input[i]]++;
-    }
-}
-
-// 새로운 압축 알고리즘 정의 (RLE 제거 및 하프만 코딩 적용)
-void advancedCompression(unsigned char* data, size_t size, unsigned char** compressedData, size_t* compressedSize) {
-    // 하프만 코딩만 적용하여 모든 파일에 대해 일관된 압축 수행
-    // 1. 하프만 코딩을 위한 빈도 계산
-    unsigned freq[256];
-    calculateFrequency(data, size, freq);
-
-    // 2. 하프만 트리 구축
-    unsigned unique = 0;
-    unsigned char uniqueChars[256];
-    unsigned uniqueFreqArr[256];
-    for(int i = 0; i < 256; i++) {
-        if(freq[i] > 0){
-            uniqueChars[unique] = i;
-            uniqueFreqArr[unique] = freq[i];
-            unique++;
-        }
-    }
-
-    if(unique == 0){
-        *compressedData = NULL;
-        *compressedSize = 0;
-        return;
-    }
-
-    struct MinHeapNode* root = buildHuffmanTree(uniqueChars, uniqueFreqArr, unique);
-
-    // 3. 하프만 코드 생성
-    char** codes = generateHuffmanCodes(root);
-
-    // 4. 하프만 인코딩 (비트 패킹 적용)
-    unsigned char* huffmanBuffer = (unsigned char*)malloc(size); // 최대 size 바이트
-    if (!huffmanBuffer) {
-        fprintf(stderr, "메모리 할당 실패 (Huffman)\n");
-        freeHuffmanTree(root);
-        exit(1);
-    }
-
-    size_t huffmanSize = huffmanEncode(data, size, huffmanBuffer, codes);
-
-    // 5. 압축 데이터 저장
-    // 압축된 데이터는 다음과 같은 형식으로 저장됩니다:
-    // [고유 문자 수][문자][빈도]... [인코딩된 비트]
-    size_t headerSize = 1 + unique * (1 + sizeof(unsigned));
-    unsigned char* finalBuffer = (unsigned char*)malloc(headerSize + huffmanSize);
-    if (!finalBuffer) {
-        fprintf(stderr, "메모리 할당 실패 (Final Buffer)\n");
-        free(huffmanBuffer);
-        freeHuffmanTree(root);
-        for(int i = 0; i < 256; i++) if(codes[i]) free(codes[i]);
-        free(codes);
-        exit(1);
-    }
-
-    // 고유 문자 수 저장
-    finalBuffer[0] = (unsigned char)unique;
-    size_t idx = 1;
-    for(unsigned i = 0; i < unique; i++) {
-        finalBuffer[idx++] = uniqueChars[i];
-        unsigned freqVal = uniqueFreqArr[i];
-        memcpy(&finalBuffer[idx], &freqVal, sizeof(unsigned));
-        idx += sizeof(unsigned);
-    }
-
-    // 인코딩된 데이터 저장
-    memcpy(&finalBuffer[idx], huffmanBuffer, huffmanSize);
-    idx += huffmanSize;
-
-    *compressedData = finalBuffer;
-    *compressedSize = idx;
-
-    // 메모리 해제
-    free(huffmanBuffer);
-    freeHuffmanTree(root);
-    for(int i = 0; i < 256; i++) if(codes[i]) free(codes[i]);
-    free(codes);
-}
-
-// 하프만 압축 해제 함수 (비트 언패킹 적용)
-void advancedDecompression(unsigned char* compressed_data, size_t compressed_size, unsigned char** decompressedData, size_t* decompressedSize) {
-    if (compressed_size < 1) {
-        *decompressedData = NULL;
-        *decompressedSize = 0;
-        return;
-    }
+    GtkListStore *jobStore;
+} JobScheduler;
 
-    // 1. 고유 문자 수 읽기
-    unsigned unique = compressed_data[0];
-    size_t idx = 1;
+JobScheduler scheduler;
 
-    if (compressed_size < 1 + unique * (1 + sizeof(unsigned))) {
-        // 유효하지 않은 압축 데이터
-        *decompressedData = NULL;
-        *decompressedSize = 0;
-        return;
-    }
-
-    unsigned char uniqueChars[256];
-    unsigned uniqueFreqArr[256];
-    for(unsigned i = 0; i < unique; i++) {
-        uniqueChars[i] = compressed_data[idx++];
-        memcpy(&uniqueFreqArr[i], &compressed_data[idx], sizeof(unsigned));
-        idx += sizeof(unsigned);
-    }
-
-    // 2. 하프만 트리 재구축
-    struct MinHeapNode* root = buildHuffmanTree(uniqueChars, uniqueFreqArr, unique);
-
-    // 3. 인코딩된 데이터 읽기
-    size_t encodedDataSize = compressed_size - idx;
-    unsigned char* encodedData = (unsigned char*)malloc(encodedDataSize);
-    if (!encodedData) {
-        fprintf(stderr, "메모리 할당 실패 (Encoded Data)\n");
-        freeHuffmanTree(root);
-        exit(1);
-    }
-    memcpy(encodedData, &compressed_data[idx], encodedDataSize);
-
-    // 4. 하프만 디코딩 (비트 언패킹 적용)
-    size_t decodedSizeHuffman = 0;
-    unsigned char* huffmanDecoded = huffmanDecode(encodedData, encodedDataSize, root, &decodedSizeHuffman);
-    free(encodedData);
-    freeHuffmanTree(root);
-
-    // 5. 원본 데이터 복원
-    *decompressedData = huffmanDecoded;
-    *decompressedSize = decodedSizeHuffman;
-}
+// 다른 스레드에서 UI로 보내는 메시지. 메시지마다 내용을 따로 들고 가므로 서로 덮어쓰지 않는다.
+typedef struct {
+    GtkWidget *widget;
+    gchar *text;
+} UiMessage;
 
 // CSS 스타일 정의
 const char *css_style = "\
@@ -401,19 +114,45 @@ const char *css_style = "\
     }\
 ";
 
-// 진행률 업데이트 함수
-gboolean update_progress(gpointer data) {
-    ThreadData *threadData = (ThreadData *)data;
-    double progress = (double)threadData->totalProcessed / threadData->fileSize;
-    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(threadData->progressBar), progress);
+// 코덱 진행 콜백 (작업 스레드에서 호출): 최근 진행 상황만 복사해 둔다
+void on_codec_progress(const struct AdvProgress *progress, void *userData) {
+    ThreadData *job = (ThreadData *)userData;
+    g_mutex_lock(&job->progressLock);
+    job->progress = *progress;
+    g_mutex_unlock(&job->progressLock);
+}
 
-    clock_t currentTime = clock();
-    double elapsedTime = (double)(currentTime - threadData->startTime) / CLOCKS_PER_SEC;
-    double speed = elapsedTime > 0 ? threadData->totalProcessed / elapsedTime : 0;
+// 진행률 업데이트 함수 (UI 타이머에서 호출): 작업별 진행률과 묶음 전체의 진행률, 처리 속도를 갱신한다
+gboolean update_progress(gpointer data) {
+    if (scheduler.activeJobs == NULL) return TRUE;
+
+    long long activeBytes = 0;
+    double speed = 0;
+    int running = 0;
+    for (GList *node = scheduler.activeJobs; node != NULL; node = node->next) {
+        ThreadData *job = (ThreadData *)node->data;
+        g_mutex_lock(&job->progressLock);
+        struct AdvProgress progress = job->progress;
+        g_mutex_unlock(&job->progressLock);
+        if (progress.elapsed <= 0) continue;
+
+        // 속도는 단조 시계로 잰 경과 시간 기준이라 여러 워커가 돌아도 실제 처리 속도를 보여 준다
+        running++;
+        activeBytes += progress.inputBytes;
+        speed += progress.inputBytes / progress.elapsed;
+        if (progress.totalBytes > 0) {
+            gtk_list_store_set(scheduler.jobStore, &job->row,
+                               JOB_COL_PERCENT, (int)(100 * progress.inputBytes / progress.totalBytes), -1);
+        }
+    }
 
+    if (scheduler.batchBytes > 0) {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(scheduler.progressBar),
+                                      (double)(scheduler.doneBytes + activeBytes) / scheduler.batchBytes);
+    }
     char speedInfo[256];
-    snprintf(speedInfo, sizeof(speedInfo), "처리 속도: %.2f 바이트/초", speed);
-    gtk_label_set_text(GTK_LABEL(threadData->speedLabel), speedInfo);
+    snprintf(speedInfo, sizeof(speedInfo), "처리 속도: %.2f MB/초 (처리 중 %d개)", speed / 1e6, running);
+    gtk_label_set_text(GTK_LABEL(scheduler.speedLabel), speedInfo);
 
     // 계속해서 업데이트하기 위해 TRUE 반환
     return TRUE;
@@ -421,182 +160,280 @@ gboolean update_progress(gpointer data) {
 
 // 레이블 및 로그 업데이트 함수
 gboolean update_label(gpointer data) {
-    GtkLabel *label = GTK_LABEL(data);
-    const gchar *message = g_object_get_data(G_OBJECT(label), "message");
-    if (message) {
-        gtk_label_set_text(label, message);
-        g_object_set_data(G_OBJECT(label), "message", NULL);
-    }
+    UiMessage *message = (UiMessage *)data;
+    gtk_label_set_text(GTK_LABEL(message->widget), message->text);
+    g_free(message->text);
+    g_free(message);
     return FALSE;
 }
 
 gboolean update_log(gpointer data) {
-    GtkTextView *logView = GTK_TEXT_VIEW(data);
-    GtkTextBuffer *buffer = gtk_text_view_get_buffer(logView);
-    const gchar *message = g_object_get_data(G_OBJECT(logView), "message");
-    if (message) {
-        GtkTextIter iter;
-        gtk_text_buffer_get_end_iter(buffer, &iter);
-        gtk_text_buffer_insert(buffer, &iter, message, -1);
-        gtk_text_buffer_insert(buffer, &iter, "\n", -1);
-        g_object_set_data(G_OBJECT(logView), "message", NULL);
-    }
+    UiMessage *message = (UiMessage *)data;
+    GtkTextBuffer *buffer = gtk_text_view_get_buffer(GTK_TEXT_VIEW(message->widget));
+    GtkTextIter iter;
+    gtk_text_buffer_get_end_iter(buffer, &iter);
+    gtk_text_buffer_insert(buffer, &iter, message->text, -1);
+    gtk_text_buffer_insert(buffer, &iter, "\n", -1);
+    g_free(message->text);
+    g_free(message);
     return FALSE;
 }
 
-// 로그에 메시지 추가 함수
-void append_log(GtkWidget *logView, const char *message) {
-    g_object_set_data_full(G_OBJECT(logView), "message", g_strdup(message), g_free);
-    g_idle_add(update_log, logView);
+// 어느 스레드에서든 레이블 내용을 바꾼다
+void set_label_text(GtkWidget *label, const char *text) {
+    UiMessage *message = g_new(UiMessage, 1);
+    message->widget = label;
+    message->text = g_strdup(text);
+    g_idle_add(update_label, message);
 }
 
-// 작업 완료 시 호출되는 함수
-gboolean on_process_complete(gpointer data) {
-    ThreadData *threadData = (ThreadData *)data;
-
-    // 진행 바를 100%로 업데이트
-    gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(threadData->progressBar), 1.0);
-
-    // 로그에 "작업 완료!" 추가
-    append_log(threadData->logView, "작업 완료!");
+// 로그에 메시지 추가 함수 (어느 스레드에서든 호출 가능)
+void append_log(GtkWidget *logView, const char *text) {
+    UiMessage *message = g_new(UiMessage, 1);
+    message->widget = logView;
+    message->text = g_strdup(text);
+    g_idle_add(update_log, message);
+}
 
-    // 압축률 계산 및 표시
-    struct stat st;
-    if (stat(threadData->outputFile, &st) == 0) {
-        long outputFileSize = st.st_size;
-        double compressionRatio = 100.0 * (1.0 - ((double)outputFileSize / threadData->fileSize));
-        char sizeInfo[256];
-        snprintf(sizeInfo, sizeof(sizeInfo), "원본 크기: %ld 바이트\n출력 크기: %ld 바이트\n압축률: %.2f%%",
-                 threadData->fileSize, outputFileSize, compressionRatio);
-        gtk_label_set_text(GTK_LABEL(threadData->speedLabel), sizeInfo);
+// 대기 중인 작업 수와 끝난 작업 수를 상태 레이블에 보여 준다
+void update_status(void) {
+    char status[256];
+    int active = (int)g_list_length(scheduler.activeJobs);
+    if (active > 0) {
+        snprintf(status, sizeof(status), "작업 중: 남은 파일 %d개 (완료 %d, 실패 %d, 취소 %d)",
+                 active, scheduler.doneJobs, scheduler.failedJobs, scheduler.cancelledJobs);
+    } else {
+        snprintf(status, sizeof(status), "작업이 완료되었습니다. (완료 %d, 실패 %d, 취소 %d)",
+                 scheduler.doneJobs, scheduler.failedJobs, scheduler.cancelledJobs);
     }
-
-    // 상태 레이블 업데이트
-    gtk_label_set_text(GTK_LABEL(threadData->statusLabel), "작업이 완료되었습니다.");
-
-    // 메모리 해제
-    g_free(threadData->inputFile);
-    g_free(threadData->outputFile);
-    g_free(threadData);
-
-    return FALSE;
+    gtk_label_set_text(GTK_LABEL(scheduler.statusLabel), status);
 }
 
-// 파일 처리 스레드 함수
-void *processFileThread(void *arg) {
-    ThreadData *threadData = (ThreadData *)arg;
-    FILE *source = fopen(threadData->inputFile, "rb");
-    if (source == NULL) {
-        append_log(threadData->logView, "파일을 열 수 없습니다.");
-        g_idle_add(on_process_complete, threadData);
-        return NULL;
-    }
+void free_job(ThreadData *job) {
+    g_mutex_clear(&job->progressLock);
+    g_free(job->inputFile);
+    g_free(job->outputFile);
+    g_free(job);
+}
 
-    fseek(source, 0, SEEK_END);
-    threadData->fileSize = ftell(source);
-    fseek(source, 0, SEEK_SET);
+// 작업 스레드가 작업을 꺼냈을 때 호출되는 함수
+gboolean on_process_started(gpointer data) {
+    ThreadData *job = (ThreadData *)data;
+    gtk_list_store_set(scheduler.jobStore, &job->row, JOB_COL_STATE, "처리 중", -1);
 
     char fileInfo[512];
     snprintf(fileInfo, sizeof(fileInfo), "파일명: %s\n출력 파일명: %s\n파일 크기: %ld 바이트\n",
-             threadData->inputFile, threadData->outputFile, threadData->fileSize);
-    g_object_set_data_full(G_OBJECT(threadData->fileInfoLabel), "message", g_strdup(fileInfo), g_free);
-    g_idle_add(update_label, threadData->fileInfoLabel);
+             job->inputFile, job->outputFile, job->fileSize);
+    gtk_label_set_text(GTK_LABEL(scheduler.fileInfoLabel), fileInfo);
+    return FALSE;
+}
 
-    threadData->totalProcessed = 0;
-    threadData->startTime = clock();
+// 작업 완료 시 호출되는 함수
+gboolean on_process_complete(gpointer data) {
+    ThreadData *job = (ThreadData *)data;
+    char result[256];
+    char logLine[1024];
+    if (job->error == NULL) {
+        // 압축률 계산 및 표시
+        double compressionRatio = job->fileSize > 0 ? 100.0 * (1.0 - ((double)job->outputSize / job->fileSize)) : 0.0;
+        snprintf(result, sizeof(result), "%ld -> %ld 바이트 (압축률 %.2f%%, %.2f초)",
+                 job->fileSize, job->outputSize, compressionRatio, job->progress.elapsed);
+        snprintf(logLine, sizeof(logLine), "%s: 작업 완료!", job->inputFile);
+        scheduler.doneJobs++;
+        scheduler.outputBytes += job->outputSize;
+    } else {
+        snprintf(result, sizeof(result), "%s", job->error);
+        snprintf(logLine, sizeof(logLine), "%s: %s", job->inputFile, job->error);
+        if (job->cancelled) scheduler.cancelledJobs++;
+        else scheduler.failedJobs++;
+    }
+    gtk_list_store_set(scheduler.jobStore, &job->row,
+                       JOB_COL_STATE, job->error == NULL ? "완료" : job->cancelled ? "취소" : "실패",
+                       JOB_COL_PERCENT, 100,
+                       JOB_COL_RESULT, result, -1);
+    append_log(scheduler.logView, logLine);
+
+    scheduler.doneBytes += job->fileSize;
+    scheduler.activeJobs = g_list_remove(scheduler.activeJobs, job);
+    free_job(job);
+
+    // 묶음의 마지막 작업이면 전체 결과를 보여 주고 다음 묶음을 위해 합계를 비운다
+    if (scheduler.activeJobs == NULL) {
+        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(scheduler.progressBar), 1.0);
+        char sizeInfo[256];
+        snprintf(sizeInfo, sizeof(sizeInfo), "전체 입력: %lld 바이트\n전체 출력: %lld 바이트",
+                 scheduler.batchBytes, scheduler.outputBytes);
+        gtk_label_set_text(GTK_LABEL(scheduler.speedLabel), sizeInfo);
+        scheduler.batchBytes = 0;
+        scheduler.doneBytes = 0;
+        scheduler.outputBytes = 0;
+    }
+    update_status();
+    return FALSE;
+}
 
-    // 파일 전체를 메모리에 로드
-    unsigned char *inBuf = (unsigned char *)malloc(threadData->fileSize);
-    if (inBuf == NULL) {
-        append_log(threadData->logView, "메모리 할당 실패");
-        fclose(source);
-        g_idle_add(on_process_complete, threadData);
-        return NULL;
+// 파일 하나를 처리한다 (작업 스레드)
+void processJob(ThreadData *job) {
+    // 대기열에 있는 동안 취소된 작업은 파일을 열지 않는다
+    if (job->cancel) {
+        job->cancelled = TRUE;
+        job->error = advErrorMessage(ADV_ERR_CANCELLED);
+        return;
+    }
+    FILE *source = fopen(job->inputFile, "rb");
+    if (source == NULL) {
+        job->error = "파일을 열 수 없습니다.";
+        return;
     }
 
-    if (fread(inBuf, 1, threadData->fileSize, source) != threadData->fileSize) {
-        append_log(threadData->logView, "파일 읽기 오류");
+    // 해제 결과를 출력 파일 매핑에 바로 쓸 수 있도록 읽기/쓰기로 연다
+    FILE *dest = fopen(job->outputFile, "wb+");
+    if (dest == NULL) {
+        job->error = "출력 파일을 열 수 없습니다.";
         fclose(source);
-        free(inBuf);
-        g_idle_add(on_process_complete, threadData);
-        return NULL;
+        return;
     }
+
+    // 형식 판별과 처리 경로 선택은 코덱 라이브러리가 맡는다
+    struct AdvOptions options;
+    advDefaultOptions(&options);
+    options.progress = on_codec_progress;
+    options.progressData = job;
+    options.cancel = &job->cancel;
+    int result = job->isCompress
+        ? compressFile(source, dest, &job->totalProcessed, &options)
+        : decompressFile(source, dest, &job->totalProcessed, &options);
     fclose(source);
+    fseek(dest, 0, SEEK_END);
+    job->outputSize = ftell(dest);
+    if (fclose(dest) != 0 && result == ADV_OK) result = ADV_ERR_WRITE;
+    if (result != ADV_OK) job->error = advErrorMessage(result);
+    // 취소된 작업의 출력은 중간까지만 기록되어 있으므로 지운다
+    if (result == ADV_ERR_CANCELLED) {
+        job->cancelled = TRUE;
+        remove(job->outputFile);
+    }
+}
 
-    unsigned char *compressedData = NULL;
-    size_t compressedSize = 0;
-    unsigned char *decompressedData = NULL;
-    size_t decompressedSize = 0;
+// 작업 스레드: 대기열에서 작업을 하나씩 꺼내 처리한다
+void *jobWorkerMain(void *arg) {
+    (void)arg;
+    for (;;) {
+        g_mutex_lock(&scheduler.lock);
+        while (scheduler.count == 0) {
+            g_cond_wait(&scheduler.jobReady, &scheduler.lock);
+        }
+        ThreadData *job = scheduler.queue[scheduler.head];
+        scheduler.head = (scheduler.head + 1) % JOB_QUEUE_CAPACITY;
+        scheduler.count--;
+        g_mutex_unlock(&scheduler.lock);
 
-    // 압축 또는 해제
-    if (threadData->isCompress) {
-        advancedCompression(inBuf, threadData->fileSize, &compressedData, &compressedSize);
-        free(inBuf); // 원본 버퍼 해제
-        threadData->totalProcessed = threadData->fileSize; // 압축 처리 완료
-    } else {
-        advancedDecompression(inBuf, threadData->fileSize, &decompressedData, &decompressedSize);
-        free(inBuf); // 압축된 데이터 해제
-        threadData->totalProcessed = threadData->fileSize; // 해제 처리 완료
+        g_idle_add(on_process_started, job);
+        processJob(job);
+        g_idle_add(on_process_complete, job);
     }
+    return NULL;
+}
 
-    // 출력 파일 열기
-    FILE *dest = fopen(threadData->outputFile, "wb");
-    if (dest == NULL) {
-        append_log(threadData->logView, "출력 파일을 열 수 없습니다.");
-        if (threadData->isCompress && compressedData) free(compressedData);
-        if (!threadData->isCompress && decompressedData) free(decompressedData);
-        g_idle_add(on_process_complete, threadData);
-        return NULL;
+// 작업 스레드를 시작한다. 작업 하나도 블록을 모든 코어에 나누므로 동시 작업 수는
+// 작은 파일이 많을 때 코어를 채울 만큼만 두고, 메모리가 작업 수에 비례해 늘지 않게 제한한다.
+void start_scheduler(void) {
+    g_mutex_init(&scheduler.lock);
+    g_cond_init(&scheduler.jobReady);
+    int cpuCount = (int)g_get_num_processors();
+    scheduler.workerCount = cpuCount < JOB_WORKERS_MAX ? cpuCount : JOB_WORKERS_MAX;
+    for (int i = 0; i < scheduler.workerCount; i++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, jobWorkerMain, NULL);
+        pthread_detach(thread);
     }
+    g_timeout_add(PROGRESS_UPDATE_MS, update_progress, NULL);
+}
 
-    // 압축된 데이터 쓰기
-    if (threadData->isCompress) {
-        if (compressedData && compressedSize > 0) {
-            if (fwrite(compressedData, 1, compressedSize, dest) != compressedSize) {
-                append_log(threadData->logView, "파일 쓰기 오류");
-                fclose(dest);
-                free(compressedData);
-                g_idle_add(on_process_complete, threadData);
-                return NULL;
-            }
-            free(compressedData);
+// 작업을 대기열에 넣는다. 대기열이 가득 차면 FALSE를 돌려준다 (UI 스레드).
+gboolean enqueue_job(ThreadData *job) {
+    g_mutex_lock(&scheduler.lock);
+    gboolean accepted = scheduler.count < JOB_QUEUE_CAPACITY;
+    if (accepted) {
+        scheduler.queue[(scheduler.head + scheduler.count) % JOB_QUEUE_CAPACITY] = job;
+        scheduler.count++;
+        g_cond_signal(&scheduler.jobReady);
+    }
+    g_mutex_unlock(&scheduler.lock);
+    return accepted;
+}
+
+// 선택한 파일들을 작업으로 만들어 대기열에 넣는다
+void add_jobs(GSList *files, gboolean isCompress) {
+    for (GSList *node = files; node != NULL; node = node->next) {
+        const char *inputFile = (const char *)node->data;
+        char *outputFile;
+        if (isCompress) {
+            outputFile = g_strdup_printf("%s.adv", inputFile);
         } else {
-            append_log(threadData->logView, "압축된 데이터가 없습니다.");
-        }
-    } else {
-        if (decompressedData && decompressedSize > 0) {
-            if (fwrite(decompressedData, 1, decompressedSize, dest) != decompressedSize) {
-                append_log(threadData->logView, "파일 쓰기 오류");
-                fclose(dest);
-                free(decompressedData);
-                g_idle_add(on_process_complete, threadData);
-                return NULL;
+            // ".adv" 확장자가 있는지 확인하고, 확장자를 제거하여 원본 파일명 생성
+            size_t len = strlen(inputFile);
+            if (len < 5 || strcmp(&inputFile[len - 4], ".adv") != 0) {
+                char message[1024];
+                snprintf(message, sizeof(message), "%s: 유효한 압축 파일(.adv)이 아닙니다.", inputFile);
+                append_log(scheduler.logView, message);
+                continue;
             }
-            free(decompressedData);
-        } else {
-            append_log(threadData->logView, "해제된 데이터가 없습니다.");
+            outputFile = g_strdup_printf("%.*s", (int)(len - 4), inputFile);
         }
-    }
 
-    fclose(dest);
-    g_idle_add(on_process_complete, threadData);
-    return NULL;
+        ThreadData *job = g_new0(ThreadData, 1);
+        job->inputFile = g_strdup(inputFile);
+        job->outputFile = outputFile;
+        job->isCompress = isCompress;
+        struct stat st;
+        job->fileSize = stat(inputFile, &st) == 0 ? (long)st.st_size : 0;
+        g_mutex_init(&job->progressLock);
+
+        gtk_list_store_append(scheduler.jobStore, &job->row);
+        gtk_list_store_set(scheduler.jobStore, &job->row,
+                           JOB_COL_FILE, inputFile,
+                           JOB_COL_MODE, isCompress ? "압축" : "해제",
+                           JOB_COL_STATE, "대기",
+                           JOB_COL_PERCENT, 0,
+                           JOB_COL_RESULT, "", -1);
+        if (!enqueue_job(job)) {
+            gtk_list_store_set(scheduler.jobStore, &job->row, JOB_COL_STATE, "거부", JOB_COL_RESULT, "대기열이 가득 찼습니다.", -1);
+            append_log(scheduler.logView, "대기열이 가득 차서 나머지 파일은 추가하지 않았습니다.");
+            free_job(job);
+            break;
+        }
+        if (scheduler.activeJobs == NULL) {
+            gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(scheduler.progressBar), 0.0);
+        }
+        scheduler.activeJobs = g_list_append(scheduler.activeJobs, job);
+        scheduler.batchBytes += job->fileSize;
+    }
+    update_status();
 }
 
-// 파일 선택 함수 (Windows와 다른 OS 구분)
-char *chooseFile(GtkWindow *parent) {
+// 파일 선택 함수 (Windows와 다른 OS 구분). 여러 파일을 고를 수 있으며 목록은 호출자가 해제한다.
+GSList *chooseFiles(GtkWindow *parent) {
+    GSList *files = NULL;
 #ifdef _WIN32
     OPENFILENAME ofn;
-    char szFile[MAX_PATH] = "";
+    static char szFile[32768];
+    szFile[0] = '\0';
     ZeroMemory(&ofn, sizeof(ofn));
     ofn.lStructSize = sizeof(ofn);
     ofn.lpstrFile = szFile;
     ofn.nMaxFile = sizeof(szFile);
-    ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST;
+    ofn.Flags = OFN_PATHMUSTEXIST | OFN_FILEMUSTEXIST | OFN_ALLOWMULTISELECT | OFN_EXPLORER;
     if (GetOpenFileName(&ofn)) {
-        return g_strdup(szFile);
-    } else {
-        return NULL;
+        // 여러 개를 고르면 "폴더\0파일1\0파일2\0\0", 하나면 전체 경로 하나가 온다
+        const char *dir = szFile;
+        const char *name = dir + strlen(dir) + 1;
+        if (*name == '\0') {
+            files = g_slist_append(files, g_strdup(dir));
+        }
+        for (; *name != '\0'; name += strlen(name) + 1) {
+            files = g_slist_append(files, g_build_filename(dir, name, NULL));
+        }
     }
 #else
     GtkWidget *dialog;
@@ -606,88 +443,55 @@ char *chooseFile(GtkWindow *parent) {
                                          "_취소", GTK_RESPONSE_CANCEL,
                                          "_열기", GTK_RESPONSE_ACCEPT,
                                          NULL);
+    gtk_file_chooser_set_select_multiple(GTK_FILE_CHOOSER(dialog), TRUE);
 
-    char *filename = NULL;
     if (gtk_dialog_run(GTK_DIALOG(dialog)) == GTK_RESPONSE_ACCEPT) {
         GtkFileChooser *chooser = GTK_FILE_CHOOSER(dialog);
-        filename = gtk_file_chooser_get_filename(chooser);
+        files = gtk_file_chooser_get_filenames(chooser);
     }
     gtk_widget_destroy(dialog);
-    return filename;
 #endif
+    return files;
 }
 
 // 압축 버튼 클릭 시 호출되는 함수
 void on_compress_clicked(GtkWidget *widget, gpointer data) {
-    GtkWidget *window = GTK_WIDGET(data);
-    GtkWidget *progressBar = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "progress_bar"));
-    GtkWidget *statusLabel = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "status_label"));
-    GtkWidget *logView = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "log_view"));
-    GtkWidget *fileInfoLabel = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "file_info_label"));
-    GtkWidget *speedLabel = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "speed_label"));
-
-    char *inputFile = chooseFile(GTK_WINDOW(window));
-    if (inputFile != NULL) {
-        char *outputFile = g_strdup_printf("%s.adv", inputFile);
-
-        gtk_label_set_text(GTK_LABEL(statusLabel), "압축 중...");
-        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progressBar), 0.0);
-
-        ThreadData *threadData = g_new(ThreadData, 1);
-        threadData->inputFile = inputFile;
-        threadData->outputFile = outputFile;
-        threadData->progressBar = progressBar;
-        threadData->statusLabel = statusLabel;
-        threadData->logView = logView;
-        threadData->fileInfoLabel = fileInfoLabel;
-        threadData->speedLabel = speedLabel;
-        threadData->isCompress = TRUE;
-
-        pthread_t thread;
-        pthread_create(&thread, NULL, processFileThread, threadData);
-        pthread_detach(thread);
-    }
+    GSList *files = chooseFiles(GTK_WINDOW(data));
+    add_jobs(files, TRUE);
+    g_slist_free_full(files, g_free);
 }
 
 // 해제 버튼 클릭 시 호출되는 함수
 void on_decompress_clicked(GtkWidget *widget, gpointer data) {
-    GtkWidget *window = GTK_WIDGET(data);
-    GtkWidget *progressBar = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "progress_bar"));
-    GtkWidget *statusLabel = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "status_label"));
-    GtkWidget *logView = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "log_view"));
-    GtkWidget *fileInfoLabel = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "file_info_label"));
-    GtkWidget *speedLabel = GTK_WIDGET(g_object_get_data(G_OBJECT(window), "speed_label"));
-
-    char *inputFile = chooseFile(GTK_WINDOW(window));
-    if (inputFile != NULL) {
-        // ".adv" 확장자가 있는지 확인
-        size_t len = strlen(inputFile);
-        if (len < 5 || strcmp(&inputFile[len - 4], ".adv") != 0) {
-            append_log(logView, "유효한 압축 파일(.adv)이 아닙니다.");
-            g_free(inputFile);
-            return;
-        }
-
-        // ".adv" 확장자를 제거하여 원본 파일명 생성
-        char *outputFile = g_strdup_printf("%.*s", (int)(len - 4), inputFile);
-
-        gtk_label_set_text(GTK_LABEL(statusLabel), "압축 해제 중...");
-        gtk_progress_bar_set_fraction(GTK_PROGRESS_BAR(progressBar), 0.0);
-
-        ThreadData *threadData = g_new(ThreadData, 1);
-        threadData->inputFile = inputFile;
-        threadData->outputFile = outputFile;
-        threadData->progressBar = progressBar;
-        threadData->statusLabel = statusLabel;
-        threadData->logView = logView;
-        threadData->fileInfoLabel = fileInfoLabel;
-        threadData->speedLabel = speedLabel;
-        threadData->isCompress = FALSE;
+    GSList *files = chooseFiles(GTK_WINDOW(data));
+    add_jobs(files, FALSE);
+    g_slist_free_full(files, g_free);
+}
 
-        pthread_t thread;
-        pthread_create(&thread, NULL, processFileThread, threadData);
-        pthread_detach(thread);
+// 취소 버튼 클릭 시 호출되는 함수: 대기 중인 작업과 처리 중인 작업을 모두 멈춘다.
+// 처리 중인 작업은 코덱이 지금 배치를 마친 뒤 멈추고, 완료 처리는 평소처럼 UI 스레드에서 한다.
+void on_cancel_clicked(GtkWidget *widget, gpointer data) {
+    if (scheduler.activeJobs == NULL) return;
+    for (GList *node = scheduler.activeJobs; node != NULL; node = node->next) {
+        ((ThreadData *)node->data)->cancel = 1;
     }
+    append_log(scheduler.logView, "남은 작업을 취소합니다.");
+}
+
+// 작업 목록 뷰 생성: 파일마다 상태, 진행률, 결과를 한 줄로 보여 준다
+GtkWidget *create_job_view(GtkListStore *store) {
+    GtkWidget *view = gtk_tree_view_new_with_model(GTK_TREE_MODEL(store));
+    gtk_tree_view_append_column(GTK_TREE_VIEW(view),
+        gtk_tree_view_column_new_with_attributes("파일", gtk_cell_renderer_text_new(), "text", JOB_COL_FILE, NULL));
+    gtk_tree_view_append_column(GTK_TREE_VIEW(view),
+        gtk_tree_view_column_new_with_attributes("작업", gtk_cell_renderer_text_new(), "text", JOB_COL_MODE, NULL));
+    gtk_tree_view_append_column(GTK_TREE_VIEW(view),
+        gtk_tree_view_column_new_with_attributes("상태", gtk_cell_renderer_text_new(), "text", JOB_COL_STATE, NULL));
+    gtk_tree_view_append_column(GTK_TREE_VIEW(view),
+        gtk_tree_view_column_new_with_attributes("진행률", gtk_cell_renderer_progress_new(), "value", JOB_COL_PERCENT, NULL));
+    gtk_tree_view_append_column(GTK_TREE_VIEW(view),
+        gtk_tree_view_column_new_with_attributes("결과", gtk_cell_renderer_text_new(), "text", JOB_COL_RESULT, NULL));
+    return view;
 }
 
 int main(int argc, char *argv[]) {
@@ -696,7 +500,7 @@ int main(int argc, char *argv[]) {
     // 메인 윈도우 생성
     GtkWidget *window = gtk_window_new(GTK_WINDOW_TOPLEVEL);
     gtk_window_set_title(GTK_WINDOW(window), "파일 압축/해제 (하프만 코딩)");
-    gtk_window_set_default_size(GTK_WINDOW(window), 600, 500);
+    gtk_window_set_default_size(GTK_WINDOW(window), 800, 650);
     gtk_container_set_border_width(GTK_CONTAINER(window), 20);
     g_signal_connect(window, "destroy", G_CALLBACK(gtk_main_quit), NULL);
 
@@ -727,6 +531,11 @@ int main(int argc, char *argv[]) {
     g_signal_connect(decompressButton, "clicked", G_CALLBACK(on_decompress_clicked), window);
     gtk_container_add(GTK_CONTAINER(buttonBox), decompressButton);
 
+    // 취소 버튼 생성
+    GtkWidget *cancelButton = gtk_button_new_with_label("작업 취소");
+    g_signal_connect(cancelButton, "clicked", G_CALLBACK(on_cancel_clicked), NULL);
+    gtk_container_add(GTK_CONTAINER(buttonBox), cancelButton);
+
     // 진행 바 생성
     GtkWidget *progressBar = gtk_progress_bar_new();
     gtk_box_pack_start(GTK_BOX(box), progressBar, FALSE, FALSE, 0);
@@ -739,6 +548,16 @@ int main(int argc, char *argv[]) {
     GtkWidget *speedLabel = gtk_label_new("속도 정보: ");
     gtk_box_pack_start(GTK_BOX(box), speedLabel, FALSE, FALSE, 0);
 
+    // 작업 목록 생성
+    GtkListStore *jobStore = gtk_list_store_new(JOB_COL_COUNT, G_TYPE_STRING, G_TYPE_STRING, G_TYPE_STRING,
+                                                G_TYPE_INT, G_TYPE_STRING);
+    GtkWidget *jobView = create_job_view(jobStore);
+    GtkWidget *jobWindow = gtk_scrolled_window_new(NULL, NULL);
+    gtk_scrolled_window_set_policy(GTK_SCROLLED_WINDOW(jobWindow),
+                                   GTK_POLICY_AUTOMATIC, GTK_POLICY_AUTOMATIC);
+    gtk_container_add(GTK_CONTAINER(jobWindow), jobView);
+    gtk_box_pack_start(GTK_BOX(box), jobWindow, TRUE, TRUE, 0);
+
     // 로그 뷰 생성
     GtkWidget *logView = gtk_text_view_new();
     gtk_text_view_set_editable(GTK_TEXT_VIEW(logView), FALSE);
@@ -755,12 +574,14 @@ int main(int argc, char *argv[]) {
     gtk_label_set_justify(GTK_LABEL(statusLabel), GTK_JUSTIFY_CENTER);
     gtk_box_pack_start(GTK_BOX(box), statusLabel, FALSE, FALSE, 0);
 
-    // 위젯들을 윈도우의 데이터에 저장
-    g_object_set_data(G_OBJECT(window), "progress_bar", progressBar);
-    g_object_set_data(G_OBJECT(window), "status_label", statusLabel);
-    g_object_set_data(G_OBJECT(window), "log_view", logView);
-    g_object_set_data(G_OBJECT(window), "file_info_label", fileInfoLabel);
-    g_object_set_data(G_OBJECT(window), "speed_label", speedLabel);
+    // 작업 스케줄러가 갱신할 위젯을 등록하고 작업 스레드 시작
+    scheduler.progressBar = progressBar;
+    scheduler.statusLabel = statusLabel;
+    scheduler.logView = logView;
+    scheduler.fileInfoLabel = fileInfoLabel;
+    scheduler.speedLabel = speedLabel;
+    scheduler.jobStore = jobStore;
+    start_scheduler();
 
     gtk_widget_show_all(window);
 